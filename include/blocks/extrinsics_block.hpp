@@ -2,6 +2,7 @@
 
 #include "blocks/block.hpp"
 #include "core/data_port.hpp"
+#include "core/se3.hpp"
 #include <opencv2/core.hpp>
 #include <memory>
 
@@ -19,10 +20,11 @@ public:
     void deserialize(const nlohmann::json& j) override;
 
 private:
-    cv::Mat R = cv::Mat::eye(3, 3, CV_64F);
-    cv::Mat t = cv::Mat::zeros(3, 1, CV_64F);
+    se3 pose;
+    bool pose_changed = true;   // The cv::Mat outputs are rebuilt on the next process()
     std::shared_ptr<data_port<cv::Mat>> output_R;
     std::shared_ptr<data_port<cv::Mat>> output_t;
+    std::shared_ptr<data_port<se3>> output_pose;
 
     int frame_id = 0;
 };
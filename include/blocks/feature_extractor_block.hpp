@@ -2,6 +2,10 @@
 
 #include "blocks/block.hpp"
 #include "core/data_port.hpp"
+#include "core/feature_budget_controller.hpp"
+#include "core/feature_set.hpp"
+#include "core/image_pyramid.hpp"
+#include "core/orb_simd.hpp"
 #include <opencv2/core.hpp>
 #include <opencv2/features2d.hpp>
 #include <memory>
@@ -22,16 +26,59 @@ public:
 
 private:
     std::string algorithm;
-    int algorithm_index = 0;  // 0 = ORB, 1 = SIFT
-    std::vector<std::string> available_algorithms = {"ORB", "SIFT"};
+    int algorithm_index = 0;  // 0 = ORB, 1 = SIFT, 2 = ORB-SIMD, 3 = SIFT-U8
+    std::vector<std::string> available_algorithms = {"ORB", "SIFT", "ORB-SIMD", "SIFT-U8"};
 
     cv::Ptr<cv::Feature2D> extractor;
+    cv::Ptr<orb_simd> simd_extractor;  // Set when extractor is ORB-SIMD
 
     std::shared_ptr<data_port<cv::Mat>> input_image;
+    std::shared_ptr<data_port<image_pyramid>> input_pyramid;  // Optional, shared with other consumers
+    std::shared_ptr<data_port<int>> input_inliers;            // Optional, from pose_estimator
     std::shared_ptr<data_port<std::vector<cv::KeyPoint>>> output_keypoints;
     std::shared_ptr<data_port<cv::Mat>> output_descriptors;
+    std::shared_ptr<data_port<feature_set>> output_features;  // Columnar keypoints + descriptors
+
+    // Single-level ORB detectors, one per pyramid level, used when a shared
+    // pyramid is connected so ORB does not build its own.
+    std::vector<cv::Ptr<cv::ORB>> level_extractors;
+
+    // Detector parameters (ORB defaults). SIFT only uses nfeatures.
+    int nfeatures = 500;
+    int nlevels = 8;
+    float scale_factor = 1.2f;
+    int fast_threshold = 20;
+
+    // Adaptive mode: nfeatures / fast_threshold follow the latency budget
+    // and the inlier count fed back from pose estimation.
+    bool adaptive = false;
+    feature_budget_controller controller;
+    double last_extract_ms = 0.0;
+    int last_inliers_frame_id = -1;
+
+    // Tiled mode: overlapping grid cells extracted in parallel, each with its
+    // own detector instance and keypoint budget. ORB tiles every level of one
+    // shared pyramid, so the overlap is in level pixels and never has to grow
+    // with the coarsest scale; levels too small for the grid use fewer cells.
+    bool tiled = false;
+    int grid_cols = 8;
+    int grid_rows = 4;
+    int tile_overlap = 32;         // Per level; ORB raises it to its 31 px edge threshold
+    int cell_budget = 0;           // 0 = nfeatures / cells
+    std::vector<cv::Ptr<cv::Feature2D>> tile_extractors;  // One per tile task, single level
+    image_pyramid tile_pyramid;    // Rebuilt in place each frame
+    int last_tile_overlap = 0;
+    float last_tile_redundancy = 0.0f;  // Tile pixels processed / pyramid pixels
+
+    // SIFT-U8 is SIFT with descriptors quantized to uint8 RootSIFT after extraction
+    bool is_sift() const { return algorithm == "SIFT" || algorithm == "SIFT-U8"; }
 
     void create_extractor();  // Switch between ORB, SIFT, etc.
+    void apply_parameters();  // Push parameter changes into the live detectors
+    void adapt(double elapsed_ms, int detected);
+    cv::Ptr<cv::Feature2D> create_tile_extractor() const;
+    void extract_tiled(const cv::Mat& image, std::vector<cv::KeyPoint>& keypoints, cv::Mat& descriptors);
+    void extract_from_pyramid(const image_pyramid& pyramid, std::vector<cv::KeyPoint>& keypoints, cv::Mat& descriptors);
     bool is_port_connected(int port_index, const std::vector<link_t>& links);
 
     int last_processed_frame_id = -1;
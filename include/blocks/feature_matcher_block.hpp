@@ -2,7 +2,14 @@
 
 #include "blocks/block.hpp"
 #include "core/data_port.hpp"
+#include "core/descriptor_quantization.hpp"
+#include "core/grid_index.hpp"
+#include "core/knn_matcher.hpp"
+#include "core/mih_index.hpp"
 #include <opencv2/opencv.hpp>
+#include <opencv2/flann.hpp>
+#include <array>
+#include <cstdint>
 #include <vector>
 #include <string>
 
@@ -23,11 +30,78 @@ public:
 private:
     std::shared_ptr<data_port<cv::Mat>> desc1_in;
     std::shared_ptr<data_port<cv::Mat>> desc2_in;
+    // Guided mode inputs: keypoints for both descriptor sets and a motion
+    // prediction, either a homography (pts1 -> pts2) or the last relative
+    // pose with intrinsics
+    std::shared_ptr<data_port<std::vector<cv::KeyPoint>>> kpts1_in;
+    std::shared_ptr<data_port<std::vector<cv::KeyPoint>>> kpts2_in;
+    std::shared_ptr<data_port<cv::Mat>> H_in;
+    std::shared_ptr<data_port<cv::Mat>> R_in;
+    std::shared_ptr<data_port<cv::Mat>> t_in;
+    std::shared_ptr<data_port<cv::Mat>> K_in;
     std::shared_ptr<data_port<std::vector<cv::DMatch>>> matches_out;
 
-    int matcher_type_index = 0;  // 0: BF_HAMMING, 1: BF_L2, 2: FLANN
+    int matcher_type_index = 0;  // 0: BF_HAMMING, 1: BF_L2, 2: FLANN, 3: MIH
     int last_processed_frame_id = -1;  // Track last processed frame id
 
     float lowe_ratio = 0.75f;
 
+    // Guided matching: each query is compared only with train keypoints
+    // within window_radius of its predicted position
+    bool guided = false;
+    float window_radius = 40.0f;       // Pixels
+    bool epipolar_gate = false;        // Also reject candidates far from the epipolar line
+    float epipolar_threshold = 3.0f;   // Pixels
+    int min_guided_matches = 30;       // Fewer than this: redo with full matching
+    grid_index train_grid;
+    std::vector<cv::DMatch> guided_rows;   // One slot per query row, queryIdx -1 if rejected
+    int guided_frames = 0;
+    int guided_fallbacks = 0;
+    double avg_candidates = 0.0;       // Smoothed candidates per query
+
+    // Native k=2 search for uint8 descriptors: Hamming for binary codes,
+    // integer L2 for SIFT-U8. The per-query results are reused across frames.
+    std::vector<knn2_match> knn_results;
+
+    // OpenCV brute-force matcher (float input), rebuilt only when the norm
+    // changes
+    cv::Ptr<cv::DescriptorMatcher> bf_matcher;
+    int bf_matcher_type = -1;   // cv::NORM_* of bf_matcher
+
+    // The two most recently trained FLANN indices, keyed by descriptor
+    // content. desc2 is always the indexed (train) side, so an index is
+    // reused whenever the same desc2 is matched against several queries.
+    struct flann_entry {
+        uint64_t key = 0;
+        descriptor_metric metric = descriptor_metric::HAMMING;
+        cv::Mat descriptors;                 // Keeps the indexed rows alive (CV_32F for L2)
+        cv::Ptr<cv::flann::Index> index;
+    };
+    std::array<flann_entry, 2> flann_cache;
+    int index_builds = 0;
+    int index_reuses = 0;
+
+    // One-to-many reuse (opt-in): on a frame stream today's curr is
+    // tomorrow's prev, so when only desc1 is indexed, search desc2 against
+    // it instead of building a new index. The ratio test then runs per desc2
+    // row; a uniqueness pass keeps the closest match per desc1 row, but the
+    // result can still differ from the desc1 -> desc2 search.
+    bool one_to_many_reuse = false;
+
+    // Multi-index hashing for large 256-bit binary sets; reused the same
+    // way as the FLANN indices, one slot
+    mih_index mih;
+    uint64_t mih_key = 0;
+    bool mih_valid = false;
+    int mih_max_radius = 2;
+
+    bool match_bf(const cv::Mat& desc1, const cv::Mat& desc2, std::vector<cv::DMatch>& good);
+    bool match_guided(const cv::Mat& desc1, const cv::Mat& desc2, std::vector<cv::DMatch>& good);
+    bool match_flann(const cv::Mat& desc1, const cv::Mat& desc2, std::vector<cv::DMatch>& good);
+    bool match_mih(const cv::Mat& desc1, const cv::Mat& desc2, std::vector<cv::DMatch>& good);
+    // Binary vs. L2 from the descriptors themselves (see metric_of), so
+    // every mode compares quantized SIFT under L2
+    descriptor_metric metric(const cv::Mat& descriptors) const;
+    const flann_entry* find_index(uint64_t key, descriptor_metric m) const;
+    const flann_entry& build_index(uint64_t key, const cv::Mat& descriptors, descriptor_metric m);
 };
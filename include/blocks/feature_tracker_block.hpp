@@ -0,0 +1,54 @@
+#pragma once
+
+#include "blocks/block.hpp"
+#include "core/data_port.hpp"
+#include <opencv2/core.hpp>
+#include <memory>
+#include <vector>
+
+// Tracks the previous frame's corners into the current image with pyramidal
+// Lucas-Kanade instead of detecting and matching on both frames. Corners are
+// re-detected only when too few tracks survive. Outputs have the same shape
+// as extractor + matcher: two keypoint lists and matches between them.
+class feature_tracker_block : public block {
+public:
+    feature_tracker_block(int id);
+
+    void process(const std::vector<link_t>& links) override;
+    void draw_ui() override;
+
+    std::vector<std::shared_ptr<base_port>> get_input_ports() override;
+    std::vector<std::shared_ptr<base_port>> get_output_ports() override;
+
+    // Serialization
+    nlohmann::json serialize() const override;
+    void deserialize(const nlohmann::json& j) override;
+
+private:
+    std::shared_ptr<data_port<cv::Mat>> input_image;
+    std::shared_ptr<data_port<std::vector<cv::KeyPoint>>> kpts1_out;  // Previous frame
+    std::shared_ptr<data_port<std::vector<cv::KeyPoint>>> kpts2_out;  // Current frame
+    std::shared_ptr<data_port<std::vector<cv::DMatch>>> matches_out;
+
+    int max_features = 1000;
+    int min_tracked = 300;         // Re-detect below this many live tracks
+    int win_size = 21;
+    int max_level = 3;
+    int min_distance = 10;         // Between corners, also around existing tracks
+    float quality_level = 0.01f;
+    bool fb_check = false;         // Forward-backward consistency (doubles LK cost)
+    float fb_threshold = 1.0f;
+
+    // Previous frame, kept as the LK pyramid so each image is pyramided once
+    std::vector<cv::Mat> prev_pyramid;
+    std::vector<cv::Point2f> prev_points;
+
+    int last_tracked = 0;
+    int redetections = 0;
+
+    void reset();
+    void build_pyramid(const cv::Mat& gray, std::vector<cv::Mat>& pyramid) const;
+    void top_up(const cv::Mat& gray, std::vector<cv::Point2f>& points) const;
+
+    int last_processed_frame_id = -1;
+};
@@ -2,6 +2,7 @@
 
 #include "blocks/block.hpp"
 #include "core/data_port.hpp"
+#include "core/match_selection.hpp"
 
 #include <opencv2/core.hpp>
 #include <opencv2/features2d.hpp>
@@ -28,10 +29,16 @@ private:
     std::shared_ptr<data_port<std::vector<cv::KeyPoint>>> kpts1_in;
     std::shared_ptr<data_port<std::vector<cv::KeyPoint>>> kpts2_in;
     std::shared_ptr<data_port<std::vector<cv::DMatch>>> matches_in;
+    std::shared_ptr<data_port<match_selection>> selection_in;  // Optional, preferred over the vectors
 
     std::shared_ptr<data_port<std::vector<cv::KeyPoint>>> filtered_kpts1_out;
     std::shared_ptr<data_port<std::vector<cv::KeyPoint>>> filtered_kpts2_out;
     std::shared_ptr<data_port<std::vector<cv::DMatch>>> filtered_matches_out;
+    std::shared_ptr<data_port<match_selection>> selection_out;
+
+    // The copied-out vectors are only built for outputs that are linked
+    bool is_port_connected(int port_index, const std::vector<link_t>& links);
+    bool use_selection() const;
 
     int last_processed_frame_id = -1;
 };
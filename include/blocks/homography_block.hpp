@@ -2,6 +2,9 @@
 
 #include "blocks/block.hpp"
 #include "core/data_port.hpp"
+#include "core/feature_set.hpp"
+#include "core/match_selection.hpp"
+#include "core/robust_estimation.hpp"
 #include <opencv2/core.hpp>
 #include <vector>
 
@@ -23,13 +26,24 @@ private:
     std::shared_ptr<data_port<std::vector<cv::KeyPoint>>> kpts1_in;
     std::shared_ptr<data_port<std::vector<cv::KeyPoint>>> kpts2_in;
     std::shared_ptr<data_port<std::vector<cv::DMatch>>> matches_in;
+    std::shared_ptr<data_port<feature_set>> features1_in;  // Optional, preferred over keypoints
+    std::shared_ptr<data_port<feature_set>> features2_in;
+    std::shared_ptr<data_port<match_selection>> selection_in;  // Optional, preferred over both
 
     std::shared_ptr<data_port<cv::Mat>> homography_out; // 3x3 homography matrix
     std::shared_ptr<data_port<cv::Mat>> mask_out;       // inlier mask (uchar)
     std::shared_ptr<data_port<std::vector<cv::DMatch>>> filtered_matches_out; // filtered matches
+    std::shared_ptr<data_port<match_selection>> inliers_out;  // inliers as a selection of the input
+
+    bool use_features() const;
+    bool use_selection() const;
+    bool is_port_connected(int port_index, const std::vector<link_t>& links);
 
     int last_processed_frame_id = -1;
     
     float ransac_reproj_thresh = 5.0;
     float confidence = 0.99f;
+    int method_index = 0;          // robust_method
+    int max_iterations = 2000;
+    double last_estimate_ms = 0.0;
 };
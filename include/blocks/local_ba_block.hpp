@@ -0,0 +1,86 @@
+#pragma once
+
+#include "blocks/block.hpp"
+#include "core/data_port.hpp"
+#include "core/sliding_window_ba.hpp"
+#include "core/trajectory.hpp"
+#include <opencv2/core.hpp>
+#include <deque>
+#include <memory>
+#include <vector>
+
+// Sliding-window bundle adjustment on top of frame-to-frame tracking. Each
+// new frame is placed by chaining the estimated relative pose, landmarks
+// are carried along through the matches (or created by triangulation, or
+// from stereo depth when connected), and the window is then re-optimized.
+// Outputs follow pose_accumulator_block: global pose of the newest frame
+// and the pose history, whose entries inside the window keep being refined.
+//
+// The inputs of one frame pair reach the block on different ticks
+// (keypoints, then matches, then the relative pose), so they are buffered
+// by frame id and a frame is only processed once its pose has arrived.
+class local_ba_block : public block {
+public:
+    local_ba_block(int id);
+
+    void process(const std::vector<link_t>& links) override;
+    void draw_ui() override;
+
+    std::vector<std::shared_ptr<base_port>> get_input_ports() override;
+    std::vector<std::shared_ptr<base_port>> get_output_ports() override;
+
+    // Serialization
+    nlohmann::json serialize() const override;
+    void deserialize(const nlohmann::json& j) override;
+
+private:
+    std::shared_ptr<data_port<std::vector<cv::KeyPoint>>> kpts1_in;   // Previous frame
+    std::shared_ptr<data_port<std::vector<cv::KeyPoint>>> kpts2_in;   // Current frame
+    std::shared_ptr<data_port<std::vector<cv::DMatch>>> matches_in;
+    std::shared_ptr<data_port<cv::Mat>> K_in;
+    std::shared_ptr<data_port<cv::Mat>> R_in;       // Relative pose, x2 = R x1 + t
+    std::shared_ptr<data_port<cv::Mat>> t_in;
+    std::shared_ptr<data_port<cv::Mat>> depth_in;   // Optional, one row per current keypoint
+
+    std::shared_ptr<data_port<cv::Mat>> R_out;
+    std::shared_ptr<data_port<cv::Mat>> t_out;
+    std::shared_ptr<data_port<trajectory>> poses_out;
+    std::shared_ptr<data_port<std::vector<cv::Point3f>>> points_out;
+
+    int window_size = 10;
+    int max_iterations = 10;
+    float time_budget_ms = 30.0f;
+    float huber_px = 2.0f;
+    float min_parallax_deg = 1.0f;  // New landmarks need at least this angle between rays
+
+    // Inputs seen per frame id, oldest first. Keypoints and matches hold the
+    // port buffers, which the graph then leaves alone (copy on write).
+    struct frame_inputs {
+        int frame_id = -1;
+        std::shared_ptr<const std::vector<cv::KeyPoint>> kpts1;
+        std::shared_ptr<const std::vector<cv::KeyPoint>> kpts2;
+        std::shared_ptr<const std::vector<cv::DMatch>> matches;
+        cv::Mat depth;
+    };
+    static constexpr size_t kMaxPendingFrames = 8;
+    std::deque<frame_inputs> pending;
+    int last_kpts1_frame_id = -1;
+    int last_kpts2_frame_id = -1;
+    int last_matches_frame_id = -1;
+    int last_depth_frame_id = -1;
+
+    sliding_window_ba ba;
+    std::vector<int> prev_landmarks;      // Landmark of each previous-frame keypoint, -1 if none
+    int prev_frame = -1;                  // Window frame id of the previous frame
+    trajectory poses;                     // Indexed by window frame id
+
+    sliding_window_ba::stats last_stats;
+    int last_tracked = 0;
+    int last_created = 0;
+
+    void reset();
+    void buffer_inputs();
+    frame_inputs& inputs_for(int frame_id);
+
+    int last_processed_frame_id = -1;
+};
@@ -2,17 +2,21 @@
 
 #include "blocks/block.hpp"
 #include "core/data_port.hpp"
+#include "core/deadline_monitor.hpp"
+#include "core/playback_clock.hpp"
 #include <opencv2/opencv.hpp>
+#include <deque>
 #include <string>
 #include <vector>
 #include <filesystem>
 
 enum class SequenceMode {
     AUTO_PLAY,
-    MANUAL
+    MANUAL,
+    TIMED       // Release frames on the sensor schedule (times.txt or fixed rate)
 };
 
-class monocular_camera_block : public block {
+class monocular_camera_block : public block, public timed_source {
 public:
     monocular_camera_block(int id, const std::string& folder);
 
@@ -25,6 +29,9 @@ public:
     nlohmann::json serialize() const override;
     void deserialize(const nlohmann::json& j) override;
 
+    // timed_source
+    bool poll_release(frame_release& out) override;
+
 private:
     std::string folder;
     std::vector<std::string> images;
@@ -39,8 +46,21 @@ private:
     cv::Mat prev_image;
     cv::Mat curr_image;
 
+    // Timed playback
+    std::vector<double> timestamps;   // Seconds, from times.txt next to the image folder
+    bool use_timestamps = true;
+    float playback_rate_hz = 10.0f;   // Used when no timestamps are available
+    float playback_speed = 1.0f;      // 0 = as fast as possible
+    bool drop_late_frames = true;
+    int dropped_frames = 0;
+    playback_clock clock;
+    std::deque<frame_release> releases;
 
     void load_image_list();
+    void load_timestamps();
+    double timestamp_of(int frame_index) const;
+    void process_timed();
+    void reset_playback();
     bool is_port_connected(int port_index, const std::vector<link_t>& links);
     void load_next_frame();
 };
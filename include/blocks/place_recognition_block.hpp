@@ -0,0 +1,58 @@
+#pragma once
+
+#include "blocks/block.hpp"
+#include "core/data_port.hpp"
+#include "core/keyframe_database.hpp"
+#include "core/loop_candidate.hpp"
+#include "core/vocabulary_tree.hpp"
+#include <opencv2/core.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Recognizes revisited places. Each frame's ORB descriptors are quantized
+// into a bag of words with a vocabulary tree (trained offline with
+// tools/train_vocabulary) and scored against earlier keyframes through an
+// inverted index. Outputs the top-k past keyframes as loop candidates;
+// the most recent frames are excluded since they always look alike.
+class place_recognition_block : public block {
+public:
+    place_recognition_block(int id);
+
+    void process(const std::vector<link_t>& links) override;
+    void draw_ui() override;
+
+    std::vector<std::shared_ptr<base_port>> get_input_ports() override;
+    std::vector<std::shared_ptr<base_port>> get_output_ports() override;
+
+    // Serialization
+    nlohmann::json serialize() const override;
+    void deserialize(const nlohmann::json& j) override;
+
+private:
+    std::shared_ptr<data_port<cv::Mat>> desc_in;
+    std::shared_ptr<data_port<std::vector<loop_candidate>>> candidates_out;
+
+    std::string vocabulary_path;
+    char path_buf[256] = {};
+    vocabulary_tree vocabulary;
+    keyframe_database database;
+    std::vector<int> keyframe_frame_ids;   // Per database entry, increasing
+
+    int top_k = 5;
+    float min_score = 0.05f;
+    int exclude_recent = 30;       // Frames too recent to count as a loop
+    int keyframe_interval = 5;     // Insert every n-th frame
+    int frames_since_keyframe = 0;
+
+    bow_vector bow;
+    std::vector<keyframe_database::result> results;
+    double transform_ms = 0.0;
+    double query_ms = 0.0;
+    double insert_ms = 0.0;
+    float best_score = 0.0f;
+
+    void load_vocabulary();
+
+    int last_processed_frame_id = -1;
+};
@@ -2,6 +2,8 @@
 
 #include "blocks/block.hpp"
 #include "core/data_port.hpp"
+#include "core/se3.hpp"
+#include "core/trajectory.hpp"
 #include <opencv2/core.hpp>
 #include <vector>
 
@@ -22,15 +24,18 @@ public:
 private:
     std::shared_ptr<data_port<cv::Mat>> R_in;
     std::shared_ptr<data_port<cv::Mat>> t_in;
+    std::shared_ptr<data_port<se3>> pose_in;   // Optional, preferred over R and t
 
-    std::shared_ptr<data_port<cv::Mat>> R_out;
+    std::shared_ptr<data_port<cv::Mat>> R_out;  // Only filled when linked
     std::shared_ptr<data_port<cv::Mat>> t_out;
-    std::shared_ptr<data_port<std::vector<cv::Mat>>> poses_out;
+    std::shared_ptr<data_port<trajectory>> poses_out;  // Shares pose_history
+    std::shared_ptr<data_port<se3>> pose_out;
 
-    cv::Mat R_global;
-    cv::Mat t_global;
+    se3 pose_global;
 
-    std::vector<cv::Mat> pose_history;
+    trajectory pose_history;
+
+    bool is_port_connected(int port_index, const std::vector<link_t>& links);
 
     int frame_id;  // Current frame id for processing
     int last_processed_frame_id = -1;
@@ -2,6 +2,10 @@
 
 #include "blocks/block.hpp"
 #include "core/data_port.hpp"
+#include "core/feature_set.hpp"
+#include "core/match_selection.hpp"
+#include "core/robust_estimation.hpp"
+#include "core/se3.hpp"
 #include <opencv2/core.hpp>
 #include <vector>
 
@@ -24,9 +28,48 @@ private:
     std::shared_ptr<data_port<std::vector<cv::KeyPoint>>> kpts2_in;
     std::shared_ptr<data_port<std::vector<cv::DMatch>>> matches_in;
     std::shared_ptr<data_port<cv::Mat>> K_in;
+    std::shared_ptr<data_port<feature_set>> features1_in;  // Optional, preferred over keypoints
+    std::shared_ptr<data_port<feature_set>> features2_in;
+    std::shared_ptr<data_port<match_selection>> selection_in;  // Optional, preferred over both
 
     std::shared_ptr<data_port<cv::Mat>> R_out;
     std::shared_ptr<data_port<cv::Mat>> t_out;
+    std::shared_ptr<data_port<int>> inliers_out;  // recoverPose support, for feedback
+    std::shared_ptr<data_port<se3>> pose_out;      // R and t as one fixed-size pose
+
+    // Essential matrix fit; the defaults are the old fixed RANSAC call
+    int method_index = 0;          // robust_method
+    float ransac_threshold = 1.0f; // Pixels
+    float confidence = 0.999f;
+    int max_iterations = 1000;
+    double last_estimate_ms = 0.0;
+    int last_inliers = 0;
+
+    // Motion prior: the previous relative pose is checked (and refined)
+    // against the new correspondences before falling back to the full fit.
+    // Off by default so graphs keep the plain per-frame estimate.
+    bool use_motion_prior = false;
+    float prior_min_support = 0.9f;   // Of the inlier ratio of the last full fit
+    int prior_refine_iterations = 5;
+    bool prior_valid = false;
+    int prior_frame_id = -1;
+    cv::Matx33d prior_R;
+    cv::Vec3d prior_t;
+    double reference_inlier_ratio = 0.0;
+    bool last_from_prior = false;
+
+    // Stats
+    int prior_attempts = 0;
+    int prior_hits = 0;
+    double avg_full_ms = 0.0;          // Running averages of each path
+    double avg_prior_ms = 0.0;
+    double time_saved_ms = 0.0;        // Against avg_full_ms, net of failed attempts
+
+    bool try_motion_prior(const std::vector<cv::Point2f>& pts1, const std::vector<cv::Point2f>& pts2,
+                          const cv::Matx33d& K, cv::Mat& R, cv::Mat& t, cv::Mat& mask, int& inliers);
+
+    bool use_features() const;
+    bool use_selection() const;
 
     int frame_id;  // Current frame id for processing
     int last_processed_frame_id = -1;
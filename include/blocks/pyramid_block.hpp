@@ -0,0 +1,33 @@
+#pragma once
+
+#include "blocks/block.hpp"
+#include "core/data_port.hpp"
+#include "core/image_pyramid.hpp"
+#include <opencv2/core.hpp>
+#include <memory>
+
+// Builds one grayscale pyramid per frame that every multi-scale consumer
+// (feature extractors, trackers, ...) can share instead of rebuilding it.
+class pyramid_block : public block {
+public:
+    pyramid_block(int id);
+
+    void process(const std::vector<link_t>& links) override;
+    void draw_ui() override;
+    std::vector<std::shared_ptr<base_port>> get_input_ports() override;
+    std::vector<std::shared_ptr<base_port>> get_output_ports() override;
+
+    // Serialization
+    nlohmann::json serialize() const override;
+    void deserialize(const nlohmann::json& j) override;
+
+private:
+    std::shared_ptr<data_port<cv::Mat>> input_image;
+    std::shared_ptr<data_port<image_pyramid>> output_pyramid;
+    std::shared_ptr<image_pyramid::buffer_t> spare_storage;   // Double buffer with the port's
+
+    int nlevels = 8;
+    float scale_factor = 1.2f;  // Matches cv::ORB's default
+
+    int last_processed_frame_id = -1;
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "blocks/block.hpp"
+#include "core/data_port.hpp"
+#include "core/sparse_stereo.hpp"
+#include <opencv2/calib3d.hpp>
+#include <opencv2/core.hpp>
+#include <deque>
+#include <vector>
+
+// Depth from a rectified stereo pair. The baseline is |t| of the connected
+// extrinsics, the focal length and principal point come from K.
+//
+// Sparse mode matches only the connected keypoints (cheap enough for every
+// frame); Depth is then one row per keypoint, 0 where no disparity was
+// found. Keypoints reach the block a tick after the images they were
+// extracted from, so recent pairs are kept until their keypoints arrive. Dense mode runs semi-global matching over the whole image and
+// Depth is a full CV_32F map. Points are in the left camera frame.
+class stereo_depth_block : public block {
+public:
+    stereo_depth_block(int id);
+
+    void process(const std::vector<link_t>& links) override;
+    void draw_ui() override;
+
+    std::vector<std::shared_ptr<base_port>> get_input_ports() override;
+    std::vector<std::shared_ptr<base_port>> get_output_ports() override;
+
+    // Serialization
+    nlohmann::json serialize() const override;
+    void deserialize(const nlohmann::json& j) override;
+
+private:
+    std::shared_ptr<data_port<cv::Mat>> left_in;
+    std::shared_ptr<data_port<cv::Mat>> right_in;
+    std::shared_ptr<data_port<cv::Mat>> K_in;
+    std::shared_ptr<data_port<cv::Mat>> R_in;    // Extrinsics; only checked for rectification
+    std::shared_ptr<data_port<cv::Mat>> t_in;    // Extrinsics; |t| is the baseline
+    std::shared_ptr<data_port<std::vector<cv::KeyPoint>>> kpts_in;  // Left image, sparse mode
+
+    std::shared_ptr<data_port<cv::Mat>> depth_out;
+    std::shared_ptr<data_port<std::vector<cv::Point3f>>> points_out;
+
+    int mode_index = 0;            // 0 = Sparse, 1 = Dense (SGM)
+    int min_disparity = 0;
+    int num_disparities = 128;     // Rounded up to a multiple of 16 for SGM
+    int block_size = 11;           // Odd
+    int uniqueness = 15;           // Percent
+    float max_depth = 80.0f;       // Metres; farther points are dropped
+    int point_stride = 4;          // Dense mode: one point per stride x stride pixels
+
+    cv::Ptr<cv::StereoSGBM> sgbm;
+    bool sgbm_dirty = true;        // Parameters changed since sgbm was created
+    cv::Mat left_gray, right_gray, disparity;   // Pair being processed
+
+    // Sparse mode: pairs waiting for their keypoints, oldest first
+    struct stereo_pair {
+        int frame_id = -1;
+        cv::Mat left_gray, right_gray;
+    };
+    static constexpr size_t kMaxPendingPairs = 4;
+    std::deque<stereo_pair> pending_pairs;
+    int last_pair_frame_id = -1;
+    std::vector<cv::Point2f> query_points;
+    std::vector<float> sparse_disparities;
+    bool warned_unrectified = false;
+
+    double last_ms = 0.0;
+    int last_valid = 0;
+
+    // Depth for the pair in left_gray/right_gray; dense when keypoints is null
+    void compute(int frame_id, const cv::Mat& K, const cv::Mat& t, const std::vector<cv::KeyPoint>* keypoints);
+    void compute_sparse(const std::vector<cv::KeyPoint>& keypoints, double fx, double fy, double cx, double cy,
+                        double baseline, cv::Mat& depth, std::vector<cv::Point3f>& points);
+    void compute_dense(double fx, double fy, double cx, double cy, double baseline,
+                       cv::Mat& depth, std::vector<cv::Point3f>& points);
+
+    int last_processed_frame_id = -1;
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "blocks/block.hpp"
+#include "blocks/monocular_camera_block.hpp"  // SequenceMode
+#include "core/data_port.hpp"
+#include "core/synthetic_scene.hpp"
+#include <opencv2/core.hpp>
+#include <memory>
+#include <vector>
+
+// Dataset-free source: renders synthetic_scene frames and publishes them with
+// their ground truth, so benchmarks run on any machine.
+class synthetic_scene_block : public block {
+public:
+    synthetic_scene_block(int id);
+
+    void process(const std::vector<link_t>& links) override;
+    void draw_ui() override;
+    std::vector<std::shared_ptr<base_port>> get_input_ports() override;
+    std::vector<std::shared_ptr<base_port>> get_output_ports() override;
+
+    // Serialization
+    nlohmann::json serialize() const override;
+    void deserialize(const nlohmann::json& j) override;
+
+private:
+    synthetic_scene_config config;
+    std::unique_ptr<synthetic_scene> scene;
+
+    SequenceMode mode = SequenceMode::MANUAL;
+    bool advance_requested = false;
+    int index = -1;
+    bool emit_points = true;
+
+    std::shared_ptr<data_port<cv::Mat>> output_prev;
+    std::shared_ptr<data_port<cv::Mat>> output_curr;
+    std::shared_ptr<data_port<cv::Mat>> output_R;      // Ground-truth relative rotation
+    std::shared_ptr<data_port<cv::Mat>> output_t;      // Ground-truth relative translation (metric)
+    std::shared_ptr<data_port<cv::Mat>> output_K;
+    std::shared_ptr<data_port<std::vector<cv::Point3f>>> output_points;
+
+    cv::Mat prev_image;
+    cv::Mat curr_image;
+
+    void rebuild_scene();
+    void load_next_frame();
+    void reset_outputs();
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "blocks/block.hpp"
+#include "core/data_port.hpp"
+#include "core/trajectory.hpp"
+#include "core/trajectory_metrics.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+// Scores the estimated trajectory against KITTI ground truth while the
+// sequence runs: ATE after alignment and the KITTI relative pose error.
+// Only poses that are new or were revised since the last frame are fed to
+// the metrics, which update in O(1) per pose. Each pose is scored against
+// the ground truth of its own source frame, so frames the pipeline dropped
+// leave gaps instead of shifting everything after them. Metrics are shown on the node
+// and printed every `report_every` frames for headless runs.
+class trajectory_eval_block : public block {
+public:
+    trajectory_eval_block(int id);
+
+    void process(const std::vector<link_t>& links) override;
+    void draw_ui() override;
+
+    std::vector<std::shared_ptr<base_port>> get_input_ports() override;
+    std::vector<std::shared_ptr<base_port>> get_output_ports() override;
+
+    // Serialization
+    nlohmann::json serialize() const override;
+    void deserialize(const nlohmann::json& j) override;
+
+private:
+    std::shared_ptr<data_port<trajectory>> poses_in;
+
+    std::string ground_truth_path;
+    char path_buf[256] = {};
+    trajectory_metrics metrics;
+
+    int alignment_index = 0;    // 0 = Sim3, 1 = SE3
+    int frame_offset = 0;       // Ground truth frame of source frame 0
+    int report_every = 100;     // Frames, 0 = never
+
+    trajectory::cursor poses_cursor;
+    bool evaluated = false;
+    int frames_since_report = 0;
+
+    // Poses that could not be lined up with the ground truth: no source
+    // frame id, frame ids out of order, or past the end of the ground truth
+    int misaligned = 0;
+    bool warned_misaligned = false;
+
+    trajectory_metrics::ate_result last_ate;
+    trajectory_metrics::rpe_result last_rpe;
+    double update_ms = 0.0;
+
+    void load_ground_truth();
+    void restart();
+
+    int last_processed_frame_id = -1;
+};
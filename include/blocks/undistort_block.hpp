@@ -0,0 +1,73 @@
+#pragma once
+
+#include "blocks/block.hpp"
+#include "core/data_port.hpp"
+#include "core/feature_set.hpp"
+#include <opencv2/core.hpp>
+#include <memory>
+#include <vector>
+
+// Removes lens distortion using the K and D of an Intrinsics block. The
+// undistorted output keeps K as its camera matrix, so everything already
+// wired to Intrinsics' K stays valid downstream.
+//
+// Dense: the whole image through cv::remap. The fixed-point maps are built
+// once per calibration and image size, so a frame costs one table lookup
+// and bilinear blend per pixel.
+// Sparse: only keypoint coordinates are undistorted, for pipelines that
+// detect on the raw image and just need correct geometry in pose
+// estimation. Costs microseconds instead of a full-image pass.
+class undistort_block : public block {
+public:
+    undistort_block(int id);
+
+    void process(const std::vector<link_t>& links) override;
+    void draw_ui() override;
+    std::vector<std::shared_ptr<base_port>> get_input_ports() override;
+    std::vector<std::shared_ptr<base_port>> get_output_ports() override;
+
+    // Serialization
+    nlohmann::json serialize() const override;
+    void deserialize(const nlohmann::json& j) override;
+
+private:
+    enum mode { DENSE = 0, SPARSE };
+
+    std::shared_ptr<data_port<cv::Mat>> input_image;
+    std::shared_ptr<data_port<cv::Mat>> input_K;
+    std::shared_ptr<data_port<cv::Mat>> input_D;
+    std::shared_ptr<data_port<std::vector<cv::KeyPoint>>> input_keypoints;
+    std::shared_ptr<data_port<feature_set>> input_features;
+    std::shared_ptr<data_port<cv::Mat>> output_image;
+    std::shared_ptr<data_port<std::vector<cv::KeyPoint>>> output_keypoints;
+    std::shared_ptr<data_port<feature_set>> output_features;
+
+    int mode_index = DENSE;
+    int interpolation_index = 0;  // 0 = linear, 1 = nearest
+
+    // Calibration the maps were built for; D empty means no distortion
+    cv::Mat K;
+    cv::Mat D;
+    bool has_distortion = false;
+
+    // Dense maps: CV_16SC2 integer coordinates + CV_16UC1 interpolation table
+    cv::Mat map1, map2;
+    cv::Size map_size;
+
+    // Sparse scratch, reused across frames
+    std::vector<cv::Point2f> points;
+    std::vector<cv::Point2f> undistorted;
+
+    double last_ms = 0.0;
+    int last_points = 0;
+
+    bool update_calibration();
+    void undistort_image(int frame_id);
+    void undistort_keypoints(int frame_id);
+    void undistort_features(int frame_id);
+    void undistort_points();
+
+    int last_image_frame_id = -1;
+    int last_keypoints_frame_id = -1;
+    int last_features_frame_id = -1;
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "blocks/block.hpp"
+#include "blocks/monocular_camera_block.hpp"  // SequenceMode
+#include "core/data_port.hpp"
+#include "core/bounded_queue.hpp"
+#include <opencv2/core.hpp>
+#include <opencv2/videoio.hpp>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Plays back a video file (MP4/MKV/...) or a printf-style image sequence
+// (e.g. "image_0/%06d.png") through the same prev/curr contract as
+// monocular_camera_block. Decoding runs on its own thread and feeds a bounded
+// queue, so the graph thread only ever pops ready frames.
+class video_source_block : public block {
+public:
+    video_source_block(int id, const std::string& path);
+    ~video_source_block() override;
+
+    void process(const std::vector<link_t>& links) override;
+    void draw_ui() override;
+    std::vector<std::shared_ptr<base_port>> get_input_ports() override;
+    std::vector<std::shared_ptr<base_port>> get_output_ports() override;
+
+    // Serialization
+    nlohmann::json serialize() const override;
+    void deserialize(const nlohmann::json& j) override;
+
+    // Drops everything queued and restarts decoding at the given source frame.
+    void seek(int frame_index);
+
+private:
+    struct decoded_frame {
+        int source_index = -1;
+        int generation = 0;
+        cv::Mat image;
+    };
+
+    std::string path;
+    char path_buf[256] = {};
+
+    SequenceMode mode = SequenceMode::MANUAL;
+    bool advance_requested = false;
+    bool has_started = false;
+    bool decoder_pending = true;  // Opened on the next process(), after deserialize
+
+    int decimation = 1;        // Keep every Nth source frame
+    int queue_capacity = 8;
+    int start_frame = 0;
+    int seek_target = 0;       // UI field
+
+    int frame_id = -1;         // Monotonic id of emitted frames (survives seeks)
+    int current_source_index = -1;
+    std::atomic<int> total_frames{0};
+    std::atomic<bool> end_of_stream{false};
+
+    std::shared_ptr<data_port<cv::Mat>> output_prev;
+    std::shared_ptr<data_port<cv::Mat>> output_curr;
+    cv::Mat prev_image;
+    cv::Mat curr_image;
+
+    // Decoder thread state
+    bounded_queue<decoded_frame> queue;
+    std::thread decoder;
+    std::atomic<bool> stop_requested{false};
+    std::atomic<int> generation{0};
+    std::mutex seek_mutex;
+    int pending_seek = -1;     // Guarded by seek_mutex
+    std::atomic<int> decimation_shared{1};
+
+    void start_decoder();
+    void stop_decoder();
+    void decode_loop();
+    bool emit_next_frame();
+    void reset_outputs();
+};
@@ -2,11 +2,14 @@
 
 #include "blocks/block.hpp"
 #include "core/data_port.hpp"
+#include "core/trajectory.hpp"
+#include "core/trajectory_writer.hpp"
 
 #include <opencv2/core.hpp>
 
 #include <pcl/visualization/pcl_visualizer.h>
 
+#include <string>
 #include <vector>
 #include <memory>
 
@@ -22,16 +25,27 @@ public:
     nlohmann::json serialize() const override;
     void deserialize(const nlohmann::json& j) override;
 
-    std::shared_ptr<data_port<std::vector<cv::Mat>>> poses_in;
+    std::shared_ptr<data_port<trajectory>> poses_in;
     std::shared_ptr<data_port<std::vector<cv::Point3f>>> points3d_in;
 
     pcl::visualization::PCLVisualizer::Ptr viewer;
     bool initialized = false;
 
-    void update_viewer(const std::vector<cv::Mat>& poses,
+    void update_viewer(const trajectory& poses,
                        const std::vector<cv::Point3f>& points);
 
 private:
+    // Poses are streamed to the output file from the writer's thread; each
+    // frame only hands over what changed since the last one
+    trajectory_writer writer;
+    trajectory::cursor poses_cursor;
+    std::string output_path = "poses_validation.txt";
+    char path_buf[256] = "poses_validation.txt";
+    int format_index = 0;      // trajectory_writer::format
+    int fsync_every = 0;       // Poses, 0 = only on close
+
+    bool open_writer();
+
     int last_frame_id;  // Track last processed frame to avoid duplicates
     int frame_id;
 };
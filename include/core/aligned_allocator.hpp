@@ -0,0 +1,31 @@
+// include/core/aligned_allocator.hpp
+#pragma once
+#include <cstddef>
+#include <new>
+
+// Minimal std allocator returning `Alignment`-byte aligned storage, so SIMD
+// kernels can use aligned loads and rows never straddle cache lines.
+template <typename T, std::size_t Alignment = 64>
+struct aligned_allocator {
+    using value_type = T;
+
+    template <typename U>
+    struct rebind { using other = aligned_allocator<U, Alignment>; };
+
+    aligned_allocator() noexcept = default;
+    template <typename U>
+    aligned_allocator(const aligned_allocator<U, Alignment>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T* p, std::size_t) noexcept {
+        ::operator delete(p, std::align_val_t(Alignment));
+    }
+
+    template <typename U>
+    bool operator==(const aligned_allocator<U, Alignment>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const aligned_allocator<U, Alignment>&) const noexcept { return false; }
+};
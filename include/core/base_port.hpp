@@ -3,5 +3,7 @@
 
 class base_port {
 public:
+    int frame_id = -1;  // Frame number or version of the data currently held
+
     virtual ~base_port() = default;
 };
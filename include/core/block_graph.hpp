@@ -1,6 +1,7 @@
 #pragma once
 #include "blocks/block.hpp"
 #include "core/link_t.hpp"
+#include "core/deadline_monitor.hpp"
 #include <vector>
 #include <memory>
 #include <map>
@@ -31,10 +32,18 @@ public:
 
     const std::vector<std::shared_ptr<block>>& get_blocks() const;
 
+    // End-to-end latency of frames released by timed sources
+    const deadline_monitor& get_deadline_monitor() const;
+    void reset_deadline_monitor();
+
 
 private:
     std::vector<std::shared_ptr<block>> blocks_;
     std::vector<link_t> links_;  // Store links between blocks
     std::map<int, std::pair<float, float>> block_positions_;  // Store block positions
     std::shared_ptr<block> create_block_by_type(const std::string& type, int id);
+
+    deadline_monitor deadline_monitor_;
+    void collect_releases();
+    void update_deadlines();
 };
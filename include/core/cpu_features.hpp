@@ -0,0 +1,38 @@
+// include/core/cpu_features.hpp
+#pragma once
+
+// Hand-vectorized kernels are compiled per instruction set with GCC/Clang
+// target attributes and picked at runtime, so the binary still runs on CPUs
+// without AVX2/AVX-512 and needs no global -march flags.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define INSIGHT_X86_SIMD 1
+#else
+#define INSIGHT_X86_SIMD 0
+#endif
+
+enum class simd_level {
+    SCALAR = 0,
+    SSE42,
+    AVX2,
+    AVX512
+};
+
+struct cpu_features {
+    bool popcnt = false;
+    bool sse42 = false;
+    bool avx2 = false;
+    bool avx512bw = false;          // avx512f + avx512bw
+    bool avx512_vpopcntdq = false;
+
+    simd_level best() const {
+        if (avx512bw) return simd_level::AVX512;
+        if (avx2) return simd_level::AVX2;
+        if (sse42) return simd_level::SSE42;
+        return simd_level::SCALAR;
+    }
+};
+
+// Queried once via CPUID; cheap to call afterwards.
+const cpu_features& get_cpu_features();
+
+const char* simd_level_name(simd_level level);
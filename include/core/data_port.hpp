@@ -9,7 +9,6 @@ class data_port : public base_port {
 public:
     std::string name;
     std::shared_ptr<T> data;
-    int frame_id = -1;  // New field to track frame number or version
 
     data_port(const std::string& port_name)
         : name(port_name), data(std::make_shared<T>()) {}
@@ -0,0 +1,50 @@
+// include/core/deadline_monitor.hpp
+#pragma once
+#include <chrono>
+#include <deque>
+
+struct frame_release {
+    int frame_id = -1;
+    std::chrono::steady_clock::time_point release;   // When the sensor would have produced it
+    std::chrono::steady_clock::time_point deadline;  // When the next frame arrives
+};
+
+// Implemented by source blocks that release frames on a schedule. The graph
+// drains these after every process() pass and hands them to deadline_monitor.
+class timed_source {
+public:
+    virtual ~timed_source() = default;
+    virtual bool poll_release(frame_release& out) = 0;
+};
+
+// Tracks end-to-end latency of released frames against their deadlines.
+// A frame counts as complete once every sink in the graph has seen its id.
+class deadline_monitor {
+public:
+    struct stats {
+        int completed = 0;
+        int missed = 0;
+        double last_latency_ms = 0.0;
+        double mean_latency_ms = 0.0;
+        double max_latency_ms = 0.0;
+        double last_slack_ms = 0.0;   // deadline - completion, negative when missed
+    };
+
+    void on_release(const frame_release& r);
+    void on_progress(int completed_frame_id, std::chrono::steady_clock::time_point now);
+    void reset();
+    // Forgets released frames without counting them, for when nothing can complete them
+    void discard_pending() { pending_.clear(); }
+
+    const stats& get_stats() const { return stats_; }
+    int pending() const { return static_cast<int>(pending_.size()); }
+
+private:
+    // Releases nobody completes (no sink linked) are dropped past this
+    static constexpr size_t kMaxPending = 256;
+
+    std::deque<frame_release> pending_;
+    stats stats_;
+    double latency_sum_ms_ = 0.0;
+    int last_released_id_ = -1;
+};
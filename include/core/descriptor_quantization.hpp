@@ -0,0 +1,18 @@
+// include/core/descriptor_quantization.hpp
+#pragma once
+#include <opencv2/core.hpp>
+
+// RootSIFT quantized to uint8: each CV_32F row is L1-normalized, square-
+// rooted (so Euclidean distance approximates the Hellinger kernel) and
+// scaled by 512 with saturation. 128 bytes per SIFT descriptor instead of
+// 512, matched with integer L2 (knn2_l2_u8).
+void rootsift_u8(const cv::Mat& descriptors, cv::Mat& out);
+
+// Distance a descriptor matrix is compared under. uint8 rows are binary
+// codes, except rootsift_u8 output: 128-byte rows, wider than any binary
+// descriptor OpenCV produces (ORB/BRIEF 32, AKAZE 61, BRISK/FREAK 64).
+enum class descriptor_metric { HAMMING, L2_U8, L2_F32 };
+
+constexpr int kRootSiftU8Bytes = 128;
+
+descriptor_metric metric_of(const cv::Mat& descriptors);
@@ -0,0 +1,36 @@
+// include/core/feature_budget_controller.hpp
+#pragma once
+
+// Picks the next frame's feature count (and FAST threshold) from measured
+// extraction time and downstream inlier support. The latency budget wins
+// over quality: when the two disagree, features are dropped.
+class feature_budget_controller {
+public:
+    struct config {
+        float budget_ms = 20.0f;     // Extraction time allowed per frame
+        int min_features = 150;
+        int max_features = 3000;
+        int target_inliers = 100;    // Grow the count below this, shrink well above
+        int min_threshold = 5;
+        int max_threshold = 40;
+    };
+
+    struct decision {
+        int nfeatures;
+        int fast_threshold;
+    };
+
+    // elapsed_ms: time of the extraction just done with `current` settings
+    // that returned `detected` keypoints. inliers < 0 when unknown.
+    decision update(double elapsed_ms, int detected, int inliers, const decision& current);
+    void reset();
+
+    config cfg;
+
+    double cost_per_feature_ms() const { return cost_ms_; }
+    bool over_budget() const { return over_budget_; }
+
+private:
+    double cost_ms_ = 0.0;   // Smoothed extraction cost per requested feature
+    bool over_budget_ = false;
+};
@@ -0,0 +1,41 @@
+// include/core/feature_set.hpp
+#pragma once
+#include "core/aligned_allocator.hpp"
+#include <opencv2/core.hpp>
+#include <vector>
+
+// Keypoints as parallel, 64-byte aligned columns plus the descriptor matrix.
+// Geometry consumers only touch x/y (8 bytes per point instead of a 28-byte
+// cv::KeyPoint), and loops over a column vectorize without gathers.
+// Feature i is (x[i], y[i], ...) and descriptor row i.
+struct feature_set {
+    template <typename T>
+    using column = std::vector<T, aligned_allocator<T, 64>>;
+
+    column<float> x;
+    column<float> y;
+    column<float> response;
+    column<float> size;
+    column<float> angle;
+    column<int> octave;
+    cv::Mat descriptors;
+
+    size_t count() const { return x.size(); }
+    bool empty() const { return x.empty(); }
+    cv::Point2f pt(size_t i) const { return {x[i], y[i]}; }
+
+    void clear();
+    void reserve(size_t n);
+    void push_back(const cv::KeyPoint& kp);
+
+    // Adapters for blocks that still speak cv::KeyPoint
+    static feature_set from_keypoints(const std::vector<cv::KeyPoint>& keypoints,
+                                      const cv::Mat& descriptors = cv::Mat());
+    void to_keypoints(std::vector<cv::KeyPoint>& keypoints) const;
+};
+
+// Matched point pairs read straight from the x/y columns, index-aligned with
+// `matches`. Returns false (outputs cleared) if any index is out of range.
+bool gather_matched_points(const feature_set& query, const feature_set& train,
+                           const std::vector<cv::DMatch>& matches,
+                           std::vector<cv::Point2f>& pts1, std::vector<cv::Point2f>& pts2);
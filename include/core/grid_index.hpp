@@ -0,0 +1,56 @@
+// include/core/grid_index.hpp
+#pragma once
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Uniform grid over 2D points for radius queries. Points are bucketed with a
+// counting sort into one flat array (CSR layout), so building is O(n) with
+// no per-cell allocations and the storage is reused across rebuilds.
+class grid_index {
+public:
+    void build(const std::vector<cv::KeyPoint>& keypoints, float cell_size);
+    void build(const std::vector<cv::Point2f>& points, float cell_size);
+
+    // Calls f(index) for every point within `radius` of (cx, cy)
+    template <typename F>
+    void for_each_in_radius(float cx, float cy, float radius, F&& f) const {
+        if (items_.empty()) return;
+        const int c0 = std::max(0, cell_x(cx - radius)), c1 = std::min(cols_ - 1, cell_x(cx + radius));
+        const int r0 = std::max(0, cell_y(cy - radius)), r1 = std::min(rows_ - 1, cell_y(cy + radius));
+        const float r2 = radius * radius;
+        for (int r = r0; r <= r1; ++r) {
+            for (int c = c0; c <= c1; ++c) {
+                const int cell = r * cols_ + c;
+                for (int k = start_[cell]; k < start_[cell + 1]; ++k) {
+                    const int i = items_[k];
+                    const float dx = xs_[i] - cx, dy = ys_[i] - cy;
+                    if (dx * dx + dy * dy <= r2) f(i);
+                }
+            }
+        }
+    }
+
+    size_t size() const { return items_.size(); }
+
+private:
+    void build_from_coords(float cell_size);
+    int cell_x(float x) const { return to_cell((x - min_x_) * inv_cell_); }
+    int cell_y(float y) const { return to_cell((y - min_y_) * inv_cell_); }
+
+    // Clamped while still a float: a wild query (a degenerate H or F
+    // prediction) must not overflow the int conversion. NaN maps to -1.
+    static int to_cell(float v) {
+        constexpr float kMaxCell = 1 << 24;
+        v = v > -1.0f ? std::min(v, kMaxCell) : -1.0f;
+        return static_cast<int>(std::floor(v));
+    }
+
+    std::vector<float> xs_, ys_;
+    std::vector<int> start_;   // cols*rows + 1 offsets into items_
+    std::vector<int> items_;   // Point indices grouped by cell
+    std::vector<int> fill_;    // Scatter cursors, one per cell
+    float min_x_ = 0.0f, min_y_ = 0.0f, inv_cell_ = 1.0f;
+    int cols_ = 0, rows_ = 0;
+};
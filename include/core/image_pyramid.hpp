@@ -0,0 +1,26 @@
+// include/core/image_pyramid.hpp
+#pragma once
+#include "core/aligned_allocator.hpp"
+#include <opencv2/core.hpp>
+#include <memory>
+#include <vector>
+
+// Grayscale scale pyramid whose levels live in one contiguous, 64-byte aligned
+// allocation with cache-line aligned row strides. Levels are cv::Mat headers
+// into that buffer, so copying a pyramid across a link is O(levels).
+struct image_pyramid {
+    using buffer_t = std::vector<uchar, aligned_allocator<uchar, 64>>;
+
+    std::shared_ptr<buffer_t> storage;
+    std::vector<cv::Mat> levels;   // CV_8UC1, levels[0] is full resolution
+    std::vector<float> scales;     // Level i is the base image shrunk by scales[i]
+    float scale_factor = 1.2f;
+
+    bool empty() const { return levels.empty(); }
+    size_t size() const { return levels.size(); }
+};
+
+// Builds (or rebuilds in place, when `out` holds the only reference to its
+// storage) an nlevels pyramid from a color or grayscale image. A scale factor
+// of 2 uses cv::pyrDown (Gaussian 5x5); other factors use area resampling.
+void build_image_pyramid(const cv::Mat& image, int nlevels, float scale_factor, image_pyramid& out);
@@ -0,0 +1,41 @@
+// include/core/keyframe_database.hpp
+#pragma once
+#include "core/vocabulary_tree.hpp"
+#include <vector>
+
+// Inverted index from vocabulary words to the keyframes containing them.
+// A query only touches keyframes that share at least one word with it, so
+// its cost follows the posting lists, not the number of keyframes.
+//
+// Scores are the L1 similarity of normalized bag-of-words vectors,
+// 1 - |a - b|_1 / 2, which for non-negative weights is sum(min(a_i, b_i))
+// over the shared words.
+class keyframe_database {
+public:
+    struct result {
+        int entry;     // Insertion index
+        float score;   // In [0, 1]
+    };
+
+    // Returns the new entry's index (entries are numbered 0, 1, 2, ...)
+    int add(const bow_vector& v);
+
+    // Best `max_results` entries with index < entry_limit, highest score first.
+    void query(const bow_vector& v, int max_results, int entry_limit, std::vector<result>& out) const;
+
+    void clear();
+    int size() const { return entries_; }
+
+private:
+    struct posting {
+        int entry;
+        float weight;
+    };
+
+    std::vector<std::vector<posting>> inverted_;   // Indexed by word id
+    int entries_ = 0;
+
+    // Query scratch: dense scores plus the list of entries touched
+    mutable std::vector<float> scores_;
+    mutable std::vector<int> touched_;
+};
@@ -0,0 +1,57 @@
+// include/core/knn_matcher.hpp
+#pragma once
+#include "core/cpu_features.hpp"
+#include <opencv2/core.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Best and second-best train rows for one query row. Indices are -1 and
+// distances INT_MAX until a candidate is seen.
+struct knn2_match {
+    int best_idx;
+    int best_dist;
+    int second_idx;
+    int second_dist;
+    bool accepted;   // Passed the ratio test
+};
+
+// Brute-force k=2 Hamming search of every `query` row against `train`
+// (CV_8U, same column count), with the ratio test applied per row as soon
+// as the row is finished. Query rows are split across threads; train rows
+// are walked in L1-sized blocks. `results` is resized to query.rows and
+// can be reused across calls without reallocating.
+//
+// 32-byte descriptors (ORB) use AVX-512 VPOPCNTDQ or AVX2 nibble-LUT
+// popcounts; other widths use 64-bit popcnt. All paths return the same
+// result, ties going to the lower train index.
+void knn2_hamming(const cv::Mat& query, const cv::Mat& train, float ratio,
+                  std::vector<knn2_match>& results,
+                  simd_level level = get_cpu_features().best());
+
+// Single-threaded kernel behind knn2_hamming for raw row-major buffers;
+// fills results[0 .. query_rows).
+void knn2_hamming_rows(const uint8_t* query, size_t query_step, int query_rows,
+                       const uint8_t* train, size_t train_step, int train_rows,
+                       int bytes, float ratio, knn2_match* results, simd_level level);
+
+// k=2 Hamming search of one query row against the train rows listed in
+// `rows` (guided matching, where the candidates come from a spatial index).
+// Indices in `result` are train row numbers, not positions in `rows`.
+void knn2_hamming_subset(const uint8_t* query, const uint8_t* train, size_t train_step,
+                         const int* rows, int count, int bytes, float ratio,
+                         knn2_match& result, simd_level level = get_cpu_features().best());
+
+// Same search under squared L2 for uint8 vectors (quantized SIFT), AVX2
+// when available. Distances in `results` are squared; the ratio test is
+// applied to the unsquared distances.
+void knn2_l2_u8(const cv::Mat& query, const cv::Mat& train, float ratio,
+                std::vector<knn2_match>& results,
+                simd_level level = get_cpu_features().best());
+
+void knn2_l2_u8_subset(const uint8_t* query, const uint8_t* train, size_t train_step,
+                       const int* rows, int count, int bytes, float ratio,
+                       knn2_match& result, simd_level level = get_cpu_features().best());
+
+// Accepted results as DMatch(query row, best train row, best distance).
+void collect_matches(const std::vector<knn2_match>& results, std::vector<cv::DMatch>& matches);
@@ -0,0 +1,10 @@
+// include/core/loop_candidate.hpp
+#pragma once
+
+// A past keyframe that looks like the current frame, from place recognition.
+// Geometric verification is left to the consumer.
+struct loop_candidate {
+    int frame_id;    // Frame the keyframe was taken from
+    int keyframe;    // Index in the keyframe database
+    float score;     // Bag-of-words similarity in [0, 1]
+};
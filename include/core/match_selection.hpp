@@ -0,0 +1,63 @@
+// include/core/match_selection.hpp
+#pragma once
+#include "core/feature_set.hpp"
+#include <opencv2/core.hpp>
+#include <memory>
+#include <vector>
+
+// A subset of a match set, kept as indices into the parent matches instead
+// of copies of the surviving matches and keypoints. The parents are shared
+// and never modified, so a selection can be passed along (and narrowed
+// again) for the cost of its index list.
+//
+// The keypoints come either as cv::KeyPoint vectors or as feature sets;
+// whichever pair is set. Parents are bounds-checked once, by select_all(),
+// and every subset of a valid selection is valid.
+struct match_selection {
+    std::shared_ptr<const std::vector<cv::DMatch>> matches;
+    std::shared_ptr<const std::vector<cv::KeyPoint>> keypoints1;
+    std::shared_ptr<const std::vector<cv::KeyPoint>> keypoints2;
+    std::shared_ptr<const feature_set> features1;
+    std::shared_ptr<const feature_set> features2;
+    std::vector<int> indices;   // Into *matches, ascending
+
+    bool valid() const { return matches != nullptr; }
+    size_t size() const { return indices.size(); }
+    bool empty() const { return indices.empty(); }
+
+    const cv::DMatch& match(size_t i) const { return (*matches)[indices[i]]; }
+    cv::Point2f point1(size_t i) const {
+        const int k = match(i).queryIdx;
+        return keypoints1 ? (*keypoints1)[k].pt : features1->pt(k);
+    }
+    cv::Point2f point2(size_t i) const {
+        const int k = match(i).trainIdx;
+        return keypoints2 ? (*keypoints2)[k].pt : features2->pt(k);
+    }
+
+    // Every match of the given parents. Returns false (out cleared) if a
+    // match indexes past either keypoint set.
+    static bool select_all(std::shared_ptr<const std::vector<cv::KeyPoint>> keypoints1,
+                           std::shared_ptr<const std::vector<cv::KeyPoint>> keypoints2,
+                           std::shared_ptr<const std::vector<cv::DMatch>> matches,
+                           match_selection& out);
+    static bool select_all(std::shared_ptr<const feature_set> features1,
+                           std::shared_ptr<const feature_set> features2,
+                           std::shared_ptr<const std::vector<cv::DMatch>> matches,
+                           match_selection& out);
+
+    // The elements of this selection whose mask entry is non-zero. The mask
+    // is size() x 1 CV_8U, in selection order (as returned by the robust
+    // estimators for points from gather_points()).
+    match_selection subset(const cv::Mat& mask) const;
+
+    // Selected point pairs, and optionally the selected matches (for PROSAC
+    // ordering), in selection order
+    void gather_points(std::vector<cv::Point2f>& pts1, std::vector<cv::Point2f>& pts2,
+                       std::vector<cv::DMatch>* selected_matches = nullptr) const;
+
+    // Copies out the selected elements for blocks that take plain vectors;
+    // any output may be null
+    void materialize(std::vector<cv::KeyPoint>* kpts1, std::vector<cv::KeyPoint>* kpts2,
+                     std::vector<cv::DMatch>* selected_matches) const;
+};
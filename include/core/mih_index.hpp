@@ -0,0 +1,54 @@
+// include/core/mih_index.hpp
+#pragma once
+#include "core/cpu_features.hpp"
+#include "core/knn_matcher.hpp"
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <vector>
+
+// Multi-index hashing (Norouzi et al.) over 256-bit binary descriptors.
+// Each code is split into 16 substrings of 16 bits, each with its own hash
+// table. If two codes differ in d bits, some substring differs in at most
+// d/16 bits, so a query only probes buckets near its own substrings and
+// widens the probe radius until the k=2 answer is settled.
+//
+// Rows can be added at any time. New rows are scanned linearly until there
+// are enough of them to be worth merging into the tables, so the index can
+// grow across frames without a full rebuild per insert.
+class mih_index {
+public:
+    static constexpr int kBytes = 32;
+    static constexpr int kSubstrings = 16;
+
+    void clear();
+
+    // Appends CV_8U rows with kBytes columns; they get ids size() .. size()+rows-1.
+    void add(const cv::Mat& descriptors);
+
+    // Merges pending rows into the hash tables (add() does this on its own
+    // once the pending set is large enough).
+    void rebuild();
+
+    int size() const { return static_cast<int>(codes_.size() / kBytes); }
+    int pending() const { return size() - indexed_; }
+
+    // k=2 search with the ratio test, same result layout as knn2_hamming.
+    // Probing stops once the answer is exact, or once the ratio test is
+    // known to pass. max_radius caps the per-substring probe radius:
+    // 16 is exhaustive; smaller values trade recall for speed, and a query
+    // cut short that way is only accepted if it passes against the distance
+    // bound reached.
+    void knn2(const cv::Mat& query, float ratio, std::vector<knn2_match>& results,
+              int max_radius = 2, simd_level level = get_cpu_features().best()) const;
+
+    // Full-distance evaluations per query in the last knn2() call
+    double last_candidates_per_query() const { return last_candidates_; }
+
+private:
+    std::vector<uint8_t> codes_;    // size() rows of kBytes
+    int indexed_ = 0;               // Rows [0, indexed_) are in the tables
+    std::vector<int> offsets_;      // kSubstrings tables of 65536 + 1 bucket offsets
+    std::vector<int> ids_;          // kSubstrings tables of indexed_ row ids
+    std::vector<uint64_t> occupied_; // Non-empty bucket bitmaps, 8 KB per table
+    mutable double last_candidates_ = 0.0;
+};
@@ -0,0 +1,79 @@
+// include/core/orb_simd.hpp
+#pragma once
+#include "core/cpu_features.hpp"
+#include "core/image_pyramid.hpp"
+#include "core/orb_simd_kernels.hpp"
+#include <opencv2/core.hpp>
+#include <opencv2/features2d.hpp>
+#include <algorithm>
+#include <vector>
+
+// ORB (FAST-9 + Harris ranking + intensity-centroid angle + rBRIEF) on the
+// hand-vectorized kernels in orb_simd_kernels, dispatched at runtime to the
+// widest instruction set the CPU supports.
+//
+// Output layout matches cv::ORB (32-byte CV_8U rows, NORM_HAMMING, keypoint
+// octave = pyramid level, size = 31 * scale), but the BRIEF pattern is a
+// generated one, so descriptors must not be mixed with cv::ORB's.
+class orb_simd : public cv::Feature2D {
+public:
+    static cv::Ptr<orb_simd> create(int nfeatures = 500, float scale_factor = 1.2f,
+                                    int nlevels = 8, int fast_threshold = 20);
+
+    void detectAndCompute(cv::InputArray image, cv::InputArray mask,
+                          std::vector<cv::KeyPoint>& keypoints,
+                          cv::OutputArray descriptors,
+                          bool useProvidedKeypoints = false) override;
+
+    // Same as above on a pyramid built elsewhere (its own scale factor and
+    // level count take precedence over this instance's).
+    void detect_and_compute(const image_pyramid& pyramid,
+                            std::vector<cv::KeyPoint>& keypoints,
+                            cv::Mat& descriptors);
+
+    int descriptorSize() const override { return 32; }
+    int descriptorType() const override { return CV_8U; }
+    int defaultNorm() const override { return cv::NORM_HAMMING; }
+    cv::String getDefaultName() const override { return "Feature2D.ORB_SIMD"; }
+
+    void set_max_features(int n) { nfeatures = std::max(1, n); }
+    int get_max_features() const { return nfeatures; }
+    void set_fast_threshold(int t) { fast_threshold = std::max(1, std::min(t, 254)); }
+    int get_fast_threshold() const { return fast_threshold; }
+    void set_scale_factor(float f) { scale_factor = std::max(1.01f, f); }
+    float get_scale_factor() const { return scale_factor; }
+    void set_nlevels(int n) { nlevels = std::max(1, n); }
+    int get_nlevels() const { return nlevels; }
+
+    simd_level level() const { return simd; }
+
+private:
+    orb_simd(int nfeatures, float scale_factor, int nlevels, int fast_threshold);
+
+    // Per-level scratch kept across frames to avoid reallocation
+    struct level_state {
+        std::vector<orb_kernels::corner> raw;
+        std::vector<orb_kernels::corner> suppressed;
+        std::vector<uint16_t> score_map;
+        cv::Mat blurred;
+    };
+
+    // Keypoints come back in level coordinates
+    void detect_level(const cv::Mat& level, const cv::Mat& mask, int octave, int budget,
+                      level_state& state, std::vector<cv::KeyPoint>& keypoints) const;
+    void describe_level(const cv::Mat& blurred, const std::vector<cv::KeyPoint>& keypoints,
+                        cv::Mat& descriptors) const;
+    void run(const image_pyramid& pyramid, const cv::Mat& mask,
+             std::vector<cv::KeyPoint>& keypoints, cv::Mat* descriptors);
+    void compute_provided(const image_pyramid& pyramid,
+                          std::vector<cv::KeyPoint>& keypoints, cv::Mat& descriptors);
+
+    int nfeatures;
+    float scale_factor;
+    int nlevels;
+    int fast_threshold;
+    simd_level simd;
+
+    image_pyramid pyramid;           // Rebuilt in place for plain-image input
+    std::vector<level_state> levels;
+};
@@ -0,0 +1,52 @@
+// include/core/orb_simd_kernels.hpp
+#pragma once
+#include "core/cpu_features.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Raw-pointer kernels behind orb_simd. Every entry point takes the SIMD level
+// to run at; all levels produce bit-identical results to the scalar path.
+namespace orb_kernels {
+
+struct corner {
+    int x;
+    int y;
+    int score;
+};
+
+// rBRIEF sampling pattern, stored as structure-of-arrays for gathers.
+// Pair i compares point (ax[i], ay[i]) against (bx[i], by[i]); all points lie
+// within a radius-15 disc so any rotation stays inside a 31x31 patch.
+struct brief_pattern {
+    alignas(64) float ax[256];
+    alignas(64) float ay[256];
+    alignas(64) float bx[256];
+    alignas(64) float by[256];
+};
+
+// Fixed, seeded pattern shared by every orb_simd instance.
+const brief_pattern& default_brief_pattern();
+
+// FAST-9/16 segment test over rows/cols [border, size - border). Appends
+// corners with a sum-of-absolute-differences score, before non-max suppression.
+void fast9_detect(const uint8_t* img, size_t step, int width, int height,
+                  int threshold, int border, std::vector<corner>& out, simd_level level);
+
+// 3x3 non-maximum suppression over a corner list (strictly greater than all
+// eight neighbours). `scratch` is resized to width*height and reused.
+void fast9_nonmax(const std::vector<corner>& in, int width, int height,
+                  std::vector<uint16_t>& scratch, std::vector<corner>& out);
+
+// Harris response over a 7x7 block centred at (x, y), as in cv::ORB.
+float harris_response(const uint8_t* img, size_t step, int x, int y, float k, simd_level level);
+
+// Intensity-centroid orientation over a radius-15 disc, in degrees [0, 360).
+float ic_angle(const uint8_t* img, size_t step, int x, int y);
+
+// 256-bit rotated BRIEF descriptor (32 bytes, bit j of byte i = pair 8i+j,
+// set when I(a) < I(b)) at the integer location (x, y) of a smoothed image.
+void rbrief_describe(const uint8_t* img, size_t step, int x, int y, float angle_deg,
+                     const brief_pattern& pattern, uint8_t* desc, simd_level level);
+
+}  // namespace orb_kernels
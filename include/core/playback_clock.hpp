@@ -0,0 +1,48 @@
+// include/core/playback_clock.hpp
+#pragma once
+#include <chrono>
+
+// Maps sensor timestamps (seconds, e.g. KITTI times.txt) onto wall-clock
+// release times, optionally scaled. speed <= 0 means as-fast-as-possible:
+// every frame is due immediately.
+class playback_clock {
+public:
+    using clock = std::chrono::steady_clock;
+
+    void set_speed(double s) { speed_ = s; reset(); }
+    double speed() const { return speed_; }
+    bool as_fast_as_possible() const { return speed_ <= 0.0; }
+
+    void reset() { running_ = false; }
+    bool running() const { return running_; }
+
+    // Anchors `stamp` to the current wall-clock time.
+    void start(double stamp) {
+        origin_wall_ = clock::now();
+        origin_stamp_ = stamp;
+        running_ = true;
+    }
+
+    clock::time_point release_time(double stamp) const {
+        if (as_fast_as_possible()) return clock::now();
+        return origin_wall_ + to_wall(stamp - origin_stamp_);
+    }
+
+    bool due(double stamp) const {
+        return as_fast_as_possible() || clock::now() >= release_time(stamp);
+    }
+
+    // Sensor-time interval converted to wall time at the current speed.
+    // In as-fast-as-possible mode the interval is kept at real-time scale so
+    // deadlines still reflect the sensor rate.
+    clock::duration to_wall(double seconds) const {
+        double scaled = as_fast_as_possible() ? seconds : seconds / speed_;
+        return std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(scaled));
+    }
+
+private:
+    clock::time_point origin_wall_;
+    double origin_stamp_ = 0.0;
+    double speed_ = 1.0;
+    bool running_ = false;
+};
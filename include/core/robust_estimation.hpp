@@ -0,0 +1,52 @@
+// include/core/robust_estimation.hpp
+#pragma once
+#include <opencv2/core.hpp>
+#include <vector>
+
+// Robust two-view model fitting shared by the geometry blocks.
+//
+// RANSAC is the classic OpenCV call. The USAC methods run OpenCV's USAC
+// pipeline (SPRT early rejection of bad hypotheses, local optimization,
+// hypothesis scoring across threads) with PROSAC sampling: when match
+// distances are given, minimal samples are drawn from the best matches
+// first, so a good model turns up after far fewer hypotheses.
+enum class robust_method {
+    RANSAC = 0,
+    PROSAC,     // PROSAC sampling, MSAC score, iterative local optimization
+    MAGSAC,     // PROSAC sampling, MAGSAC++ score, sigma-consensus optimization
+};
+
+struct robust_config {
+    robust_method method = robust_method::RANSAC;
+    double threshold = 1.0;       // Pixels
+    double confidence = 0.999;
+    int max_iterations = 2000;
+    bool parallel = true;         // USAC only
+};
+
+// pts1[i] <-> pts2[i]; `matches`, if non-null, gives the distance of each
+// correspondence (same order) for PROSAC ordering. The returned mask is
+// CV_8U, one row per correspondence, in the caller's order.
+cv::Mat estimate_essential(const std::vector<cv::Point2f>& pts1, const std::vector<cv::Point2f>& pts2,
+                           const cv::Mat& K, const std::vector<cv::DMatch>* matches,
+                           const robust_config& cfg, cv::Mat& mask);
+
+cv::Mat estimate_homography(const std::vector<cv::Point2f>& pts1, const std::vector<cv::Point2f>& pts2,
+                            const std::vector<cv::DMatch>* matches,
+                            const robust_config& cfg, cv::Mat& mask);
+
+// Checks a known relative pose (x2 = R x1 + t, |t| = 1) against the
+// correspondences: Sampson distance in pixels below `threshold`, with the
+// triangulated point in front of both cameras, marks an inlier. That is the
+// same test recoverPose applies, so the counts are comparable. Fills `mask`
+// like the estimators above and returns the count.
+int count_pose_inliers(const cv::Matx33d& R, const cv::Vec3d& t,
+                       const std::vector<cv::Point2f>& pts1, const std::vector<cv::Point2f>& pts2,
+                       const cv::Matx33d& K, double threshold, cv::Mat& mask);
+
+// Levenberg-Marquardt on the Sampson error of the masked correspondences,
+// over the 5 degrees of freedom of (R, unit t). Updates R and t in place;
+// returns false if no step reduced the error.
+bool refine_pose(cv::Matx33d& R, cv::Vec3d& t,
+                 const std::vector<cv::Point2f>& pts1, const std::vector<cv::Point2f>& pts2,
+                 const cv::Matx33d& K, const cv::Mat& mask, int iterations);
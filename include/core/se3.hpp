@@ -0,0 +1,142 @@
+// include/core/se3.hpp
+#pragma once
+#include <opencv2/core.hpp>
+#include <cmath>
+
+// Fixed-size 3D geometry for the pose ports: plain arrays on the stack, so
+// chaining and storing poses never allocates, and everything that needs no
+// square root is constexpr.
+//
+// se3 maps points as x' = R x + t. Composition follows the pose chaining
+// used throughout: (a * b) applies b first, so a camera-to-world pose
+// times a relative camera motion gives the new camera-to-world pose.
+
+struct vec3 {
+    double v[3] = {0, 0, 0};
+
+    constexpr double& operator[](int i) { return v[i]; }
+    constexpr double operator[](int i) const { return v[i]; }
+
+    constexpr vec3 operator+(const vec3& b) const { return {{v[0] + b[0], v[1] + b[1], v[2] + b[2]}}; }
+    constexpr vec3 operator-(const vec3& b) const { return {{v[0] - b[0], v[1] - b[1], v[2] - b[2]}}; }
+    constexpr vec3 operator-() const { return {{-v[0], -v[1], -v[2]}}; }
+    constexpr vec3 operator*(double s) const { return {{v[0] * s, v[1] * s, v[2] * s}}; }
+    constexpr double dot(const vec3& b) const { return v[0] * b[0] + v[1] * b[1] + v[2] * b[2]; }
+    constexpr vec3 cross(const vec3& b) const {
+        return {{v[1] * b[2] - v[2] * b[1], v[2] * b[0] - v[0] * b[2], v[0] * b[1] - v[1] * b[0]}};
+    }
+    double norm() const { return std::sqrt(dot(*this)); }
+};
+
+struct mat3 {
+    double m[9] = {0, 0, 0, 0, 0, 0, 0, 0, 0};   // Row-major
+
+    static constexpr mat3 identity() { return {{1, 0, 0, 0, 1, 0, 0, 0, 1}}; }
+
+    constexpr double& operator()(int r, int c) { return m[r * 3 + c]; }
+    constexpr double operator()(int r, int c) const { return m[r * 3 + c]; }
+
+    constexpr mat3 operator*(const mat3& b) const {
+        mat3 out;
+        for (int r = 0; r < 3; ++r) {
+            for (int c = 0; c < 3; ++c) {
+                out(r, c) = (*this)(r, 0) * b(0, c) + (*this)(r, 1) * b(1, c) + (*this)(r, 2) * b(2, c);
+            }
+        }
+        return out;
+    }
+    constexpr vec3 operator*(const vec3& x) const {
+        return {{m[0] * x[0] + m[1] * x[1] + m[2] * x[2],
+                 m[3] * x[0] + m[4] * x[1] + m[5] * x[2],
+                 m[6] * x[0] + m[7] * x[1] + m[8] * x[2]}};
+    }
+    constexpr mat3 transpose() const { return {{m[0], m[3], m[6], m[1], m[4], m[7], m[2], m[5], m[8]}}; }
+    constexpr double trace() const { return m[0] + m[4] + m[8]; }
+    constexpr double determinant() const {
+        return m[0] * (m[4] * m[8] - m[5] * m[7]) - m[1] * (m[3] * m[8] - m[5] * m[6]) +
+               m[2] * (m[3] * m[7] - m[4] * m[6]);
+    }
+};
+
+// Unit quaternion, w + xi + yj + zk
+struct quat {
+    double w = 1, x = 0, y = 0, z = 0;
+
+    constexpr quat operator*(const quat& b) const {
+        return {w * b.w - x * b.x - y * b.y - z * b.z,
+                w * b.x + x * b.w + y * b.z - z * b.y,
+                w * b.y - x * b.z + y * b.w + z * b.x,
+                w * b.z + x * b.y - y * b.x + z * b.w};
+    }
+    constexpr quat conjugate() const { return {w, -x, -y, -z}; }
+
+    constexpr mat3 to_rotation() const {
+        return {{1 - 2 * (y * y + z * z), 2 * (x * y - w * z), 2 * (x * z + w * y),
+                 2 * (x * y + w * z), 1 - 2 * (x * x + z * z), 2 * (y * z - w * x),
+                 2 * (x * z - w * y), 2 * (y * z + w * x), 1 - 2 * (x * x + y * y)}};
+    }
+
+    quat normalized() const {
+        const double n = std::sqrt(w * w + x * x + y * y + z * z);
+        return {w / n, x / n, y / n, z / n};
+    }
+
+    // Shepperd's method: divides by the largest of the four candidates
+    static quat from_rotation(const mat3& R) {
+        const double tr = R.trace();
+        quat q;
+        if (tr > R(0, 0) && tr > R(1, 1) && tr > R(2, 2)) {
+            const double s = 2.0 * std::sqrt(1.0 + tr);
+            q = {0.25 * s, (R(2, 1) - R(1, 2)) / s, (R(0, 2) - R(2, 0)) / s, (R(1, 0) - R(0, 1)) / s};
+        } else if (R(0, 0) > R(1, 1) && R(0, 0) > R(2, 2)) {
+            const double s = 2.0 * std::sqrt(1.0 + R(0, 0) - R(1, 1) - R(2, 2));
+            q = {(R(2, 1) - R(1, 2)) / s, 0.25 * s, (R(0, 1) + R(1, 0)) / s, (R(0, 2) + R(2, 0)) / s};
+        } else if (R(1, 1) > R(2, 2)) {
+            const double s = 2.0 * std::sqrt(1.0 + R(1, 1) - R(0, 0) - R(2, 2));
+            q = {(R(0, 2) - R(2, 0)) / s, (R(0, 1) + R(1, 0)) / s, 0.25 * s, (R(1, 2) + R(2, 1)) / s};
+        } else {
+            const double s = 2.0 * std::sqrt(1.0 + R(2, 2) - R(0, 0) - R(1, 1));
+            q = {(R(1, 0) - R(0, 1)) / s, (R(0, 2) + R(2, 0)) / s, (R(1, 2) + R(2, 1)) / s, 0.25 * s};
+        }
+        return q.w < 0 ? quat{-q.w, -q.x, -q.y, -q.z} : q;
+    }
+};
+
+struct se3 {
+    mat3 R = mat3::identity();
+    vec3 t;
+
+    static constexpr se3 identity() { return {}; }
+
+    constexpr se3 operator*(const se3& b) const { return {R * b.R, R * b.t + t}; }
+    constexpr vec3 operator*(const vec3& x) const { return R * x + t; }
+    constexpr se3 inverse() const {
+        const mat3 Rt = R.transpose();
+        return {Rt, -(Rt * t)};
+    }
+
+    // Element (r, c) of the 3x4 matrix [R|t]
+    constexpr double operator()(int r, int c) const { return c < 3 ? R(r, c) : t[r]; }
+
+    quat rotation_quaternion() const { return quat::from_rotation(R); }
+    static se3 from_quaternion(const quat& q, const vec3& t) { return {q.normalized().to_rotation(), t}; }
+
+    // Re-orthonormalizes R through its quaternion, against the rounding
+    // that builds up over long chains of compositions
+    se3 normalized() const { return {rotation_quaternion().normalized().to_rotation(), t}; }
+
+    // Conversions for the cv::Mat ports and OpenCV calls
+    static se3 from_mat(const cv::Mat& R, const cv::Mat& t) {
+        cv::Matx33d R_d;
+        cv::Vec3d t_d;
+        R.convertTo(R_d, CV_64F);
+        t.convertTo(t_d, CV_64F);
+        return from_matx(R_d, t_d);
+    }
+    static se3 from_matx(const cv::Matx33d& R, const cv::Vec3d& t) {
+        return {{{R(0, 0), R(0, 1), R(0, 2), R(1, 0), R(1, 1), R(1, 2), R(2, 0), R(2, 1), R(2, 2)}},
+                {{t[0], t[1], t[2]}}};
+    }
+    cv::Matx33d rotation_matx() const { return cv::Matx33d(R.m); }
+    cv::Vec3d translation_vec() const { return cv::Vec3d(t[0], t[1], t[2]); }
+};
@@ -0,0 +1,91 @@
+// include/core/sliding_window_ba.hpp
+#pragma once
+#include <opencv2/core.hpp>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+// Bundle adjustment over the most recent frames and the landmarks they
+// observe. Poses are world-to-camera (x_cam = R X + t).
+//
+// Each Levenberg-Marquardt step eliminates the landmarks with the Schur
+// complement: landmark blocks are 3x3, so the only linear system actually
+// factored is the small dense one over the free poses (6 per frame). The
+// per-landmark work (Jacobians, its 3x3 inverse, its contribution to the
+// reduced system) is split across threads in landmark chunks, each with
+// its own accumulator, so the reduction is deterministic.
+//
+// The oldest `fixed_frames` poses are held constant; two fixed frames also
+// pin the scale of a monocular window.
+class sliding_window_ba {
+public:
+    struct options {
+        int window_size = 10;           // Frames
+        int fixed_frames = 2;
+        int max_iterations = 10;
+        double time_budget_ms = 30.0;   // No new iteration starts past this
+        double huber_px = 2.0;          // Huber loss threshold
+        double outlier_px = 5.0;        // Observations above this are dropped after a solve
+    };
+
+    struct stats {
+        int iterations = 0;
+        int landmarks = 0;              // Optimized (seen at least twice)
+        int observations = 0;
+        int outliers_removed = 0;
+        double initial_rms = 0.0;       // Pixels
+        double final_rms = 0.0;
+        double ms = 0.0;
+        bool time_limited = false;
+    };
+
+    options opts;
+
+    // Appends a frame and drops the oldest ones beyond the window, together
+    // with landmarks no longer observed. Returns the new frame's id; ids
+    // count up from 0 until clear().
+    int add_frame(const cv::Matx33d& R, const cv::Vec3d& t);
+    int add_landmark(const cv::Vec3d& X);
+    void add_observation(int frame_id, int landmark_id, const cv::Point2f& px);
+
+    stats optimize(const cv::Matx33d& K);
+
+    void clear();
+
+    bool has_frame(int frame_id) const;
+    bool has_landmark(int landmark_id) const { return landmarks_.count(landmark_id) > 0; }
+    const cv::Matx33d& rotation(int frame_id) const { return frame(frame_id).R; }
+    const cv::Vec3d& translation(int frame_id) const { return frame(frame_id).t; }
+    const cv::Vec3d& landmark(int landmark_id) const { return landmarks_.at(landmark_id).X; }
+
+    int first_frame_id() const { return frames_.empty() ? -1 : frames_.front().id; }
+    int frame_count() const { return static_cast<int>(frames_.size()); }
+    int landmark_count() const { return static_cast<int>(landmarks_.size()); }
+
+    // Landmarks observed at least twice in the window
+    void triangulated_points(std::vector<cv::Point3f>& out) const;
+
+private:
+    struct observation {
+        int landmark;
+        cv::Point2f px;
+    };
+    struct frame_state {
+        int id;
+        cv::Matx33d R;
+        cv::Vec3d t;
+        std::vector<observation> observations;
+    };
+    struct landmark_state {
+        cv::Vec3d X;
+        int observations = 0;
+    };
+
+    frame_state& frame(int frame_id) { return frames_[frame_id - frames_.front().id]; }
+    const frame_state& frame(int frame_id) const { return frames_[frame_id - frames_.front().id]; }
+
+    std::deque<frame_state> frames_;
+    std::unordered_map<int, landmark_state> landmarks_;
+    int next_frame_id_ = 0;
+    int next_landmark_id_ = 0;
+};
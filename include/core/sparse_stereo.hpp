@@ -0,0 +1,21 @@
+// include/core/sparse_stereo.hpp
+#pragma once
+#include <opencv2/core.hpp>
+#include <vector>
+
+// Disparity at selected left-image pixels of a rectified stereo pair, by
+// SAD block matching along the same row of the right image. Only the
+// requested points are searched, so the cost follows the keypoint count
+// rather than the image size; points are matched in parallel.
+struct sparse_stereo_params {
+    int min_disparity = 0;
+    int num_disparities = 128;   // Search [min, min + num)
+    int block_radius = 5;        // Window is (2r + 1)^2
+    int uniqueness = 15;         // Percent the runner-up must lose by
+};
+
+// `left` and `right` are CV_8UC1. disparities[i] is the subpixel disparity
+// of points[i], or -1 where the window leaves the image or the match is
+// ambiguous.
+void sparse_stereo_match(const cv::Mat& left, const cv::Mat& right, const std::vector<cv::Point2f>& points,
+                         const sparse_stereo_params& params, std::vector<float>& disparities);
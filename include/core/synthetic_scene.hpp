@@ -0,0 +1,60 @@
+// include/core/synthetic_scene.hpp
+#pragma once
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <vector>
+
+struct synthetic_scene_config {
+    int width = 1241;           // KITTI-like defaults
+    int height = 376;
+    int frame_count = 500;
+    uint32_t seed = 42;
+    // Intrinsics as calibrated for intrinsics_width x intrinsics_height;
+    // synthetic_scene rescales them to width x height, so changing the
+    // resolution keeps the same field of view and a centred optical axis
+    double fx = 718.856;
+    double fy = 718.856;
+    double cx = 607.1928;
+    double cy = 185.2157;
+    int intrinsics_width = 1241;
+    int intrinsics_height = 376;
+    double step_m = 1.0;        // Forward motion per frame
+    double sway_m = 2.0;        // Lateral amplitude of the S-curve trajectory
+    int landmark_count = 4000;
+};
+
+// CPU ray-caster for a procedurally textured street canyon (ground plane plus
+// two facades) seen from a camera driving a known S-curve. Everything is a pure
+// function of the config, so a given seed always yields the same images, poses
+// and landmarks on any machine.
+//
+// Conventions follow KITTI: camera x right, y down, z forward; the world frame
+// is the camera frame of frame 0.
+class synthetic_scene {
+public:
+    explicit synthetic_scene(const synthetic_scene_config& config = synthetic_scene_config());
+
+    const synthetic_scene_config& config() const { return config_; }
+    cv::Mat K() const;  // 3x3 CV_64F
+
+    // Camera-to-world pose of frame i
+    cv::Matx33d rotation(int frame_index) const;
+    cv::Vec3d position(int frame_index) const;
+
+    // Motion from frame i-1 to frame i in cv::recoverPose convention
+    // (x_i = R * x_{i-1} + t). t is metric, unlike the unit-norm estimate.
+    void relative_motion(int frame_index, cv::Mat& R, cv::Mat& t) const;
+
+    // Renders frame i as CV_8UC3, rows in parallel.
+    void render(int frame_index, cv::Mat& out) const;
+
+    // World-frame landmarks on the scene surfaces that project into frame i
+    std::vector<cv::Point3f> visible_landmarks(int frame_index) const;
+
+private:
+    synthetic_scene_config config_;
+    std::vector<cv::Point3f> landmarks_;
+
+    float shade(const cv::Vec3d& origin, const cv::Vec3d& dir) const;
+    void generate_landmarks();
+};
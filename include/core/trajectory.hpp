@@ -0,0 +1,79 @@
+// include/core/trajectory.hpp
+#pragma once
+#include "core/se3.hpp"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Camera-to-world poses, one per processed frame, appended in order.
+//
+// A trajectory is a handle: copies share the same poses, so passing one
+// over a link costs a pointer copy, however long the sequence. Poses live
+// in fixed-size chunks that never move, so appending is O(1) without the
+// occasional full reallocation of a vector.
+//
+// Each pose carries the frame id of the source frame it belongs to, so
+// readers can line poses up with per-frame data (ground truth) even when
+// frames were dropped along the way.
+//
+// Readers keep a cursor and only look at what changed since they last
+// read: poses appended since, plus any older pose a producer revised in
+// place (a sliding-window optimizer refining its window). reset() starts a
+// new sequence; readers notice through the cursor and start over.
+class trajectory {
+public:
+    using pose = se3;
+
+    // A reader's position
+    struct cursor {
+        uint64_t sequence = 0;
+        size_t read = 0;     // Poses read
+        size_t edits = 0;    // Edit log entries seen
+    };
+
+    trajectory();
+
+    size_t size() const { return seq_->size; }
+    bool empty() const { return seq_->size == 0; }
+    const pose& operator[](size_t i) const { return entry(i).p; }
+    const pose& back() const { return (*this)[size() - 1]; }
+    // Source frame id of pose i, -1 if the producer did not give one
+    int frame_id(size_t i) const { return entry(i).frame_id; }
+
+    void push_back(const pose& p, int frame_id = -1);
+    // Overwrites an earlier pose, keeping its frame id, and records the edit
+    // for readers
+    void revise(size_t i, const pose& p);
+    // Detaches this handle onto a new, empty sequence; other handles keep
+    // the old one
+    void reset();
+
+    // Index of the first pose the cursor has not seen in its current form:
+    // its read count, or less if a pose before it was revised since. 0 for
+    // a cursor from another sequence. Poses [first_unread, size()) are then
+    // the ones to (re)read, after which advance() moves the cursor to the end.
+    size_t first_unread(const cursor& c) const;
+    void advance(cursor& c) const;
+
+private:
+    static constexpr size_t kChunkSize = 1024;
+
+    struct element {
+        pose p;
+        int frame_id = -1;
+    };
+    using chunk = std::array<element, kChunkSize>;
+
+    struct sequence {
+        uint64_t id;                    // Unique per process, from 1
+        std::vector<std::unique_ptr<chunk>> chunks;
+        size_t size = 0;
+        std::vector<size_t> edit_log;   // Revised indices, in order
+    };
+
+    std::shared_ptr<sequence> seq_;
+
+    const element& entry(size_t i) const { return (*seq_->chunks[i / kChunkSize])[i % kChunkSize]; }
+    element& entry(size_t i) { return (*seq_->chunks[i / kChunkSize])[i % kChunkSize]; }
+};
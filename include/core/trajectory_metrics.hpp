@@ -0,0 +1,78 @@
+// include/core/trajectory_metrics.hpp
+#pragma once
+#include "core/se3.hpp"
+#include <string>
+#include <vector>
+
+// Accuracy of an estimated trajectory against KITTI-format ground truth
+// (one camera-to-world [R|t] per line, 12 values row-major), kept up to
+// date as estimates arrive instead of recomputed over the whole history.
+//
+// ATE: RMS position error after the best rigid (or similarity) alignment
+// of the estimate onto the ground truth (Umeyama). The alignment only
+// depends on the first and second moments of the two point sets, which
+// are running sums, so each new or revised pose is O(1) and the RMSE comes
+// out of the same 3x3 SVD as the alignment.
+//
+// RPE: the KITTI odometry metric. Segments start every 10th frame and end
+// at the first frame that is `length` metres further along the ground
+// truth path, for lengths 100..800 m. The segments are laid out once when
+// the ground truth is loaded and bucketed by their end frame; each is
+// scored once, when the estimate for its end frame arrives.
+class trajectory_metrics {
+public:
+    struct ate_result {
+        int poses = 0;
+        double rmse = 0.0;     // Metres
+        double scale = 1.0;    // Estimate to ground truth (1 for rigid alignment)
+    };
+
+    struct rpe_result {
+        int segments = 0;
+        double translation_pct = 0.0;   // Mean translation error, % of segment length
+        double rotation_deg_100m = 0.0; // Mean rotation error, degrees per 100 m
+    };
+
+    // Replaces the ground truth and drops all estimates
+    bool load_ground_truth(const std::string& path);
+    size_t ground_truth_size() const { return gt_.size(); }
+
+    // Estimated pose of ground truth frame `frame`. A frame seen before is
+    // a revision: ATE follows it, RPE segments already scored do not.
+    // False if the ground truth has no such frame.
+    bool update(size_t frame, const se3& pose);
+    void clear_estimates();
+
+    // Similarity (monocular, unknown scale) or rigid alignment. RPE uses
+    // the ATE scale for the estimated segment lengths in similarity mode.
+    bool similarity = true;
+
+    ate_result ate() const;
+    rpe_result rpe() const;
+
+private:
+    struct segment {
+        int first;
+        int length_index;
+    };
+
+    void add_moments(const vec3& x, const vec3& y, double sign);
+    void score_segment(const segment& s, int last);
+
+    std::vector<se3> gt_;
+    std::vector<std::vector<segment>> segments_ending_;   // By end frame
+
+    std::vector<se3> est_;
+    std::vector<char> have_est_;
+
+    // ATE moments of the (estimate x, ground truth y) position pairs
+    int n_ = 0;
+    vec3 sum_x_, sum_y_;
+    double sum_xx_ = 0.0, sum_yy_ = 0.0;
+    mat3 sum_yx_;               // sum of y x^T
+
+    // RPE accumulators
+    int segments_ = 0;
+    double sum_t_err_ = 0.0;    // Per metre
+    double sum_r_err_ = 0.0;    // Radians per metre
+};
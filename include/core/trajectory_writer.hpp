@@ -0,0 +1,82 @@
+// include/core/trajectory_writer.hpp
+#pragma once
+#include "core/bounded_queue.hpp"
+#include "core/trajectory.hpp"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Streams a trajectory to disk from its own thread. The graph thread only
+// hands over the poses that changed since its last call (see
+// trajectory::first_unread), so a whole sequence costs linear time and the
+// file I/O stays off the graph thread.
+//
+// Output is accumulated into a large buffer and written when it fills or
+// when the writer runs out of queued poses. Poses revised by their producer
+// are rewritten by truncating the file back to the first of them.
+//
+// Formats:
+//   KITTI   one pose per line, the 12 values of [R|t] row-major, as in the
+//           KITTI odometry ground truth
+//   BINARY  12 doubles per pose in native byte order, row-major, no header
+class trajectory_writer {
+public:
+    enum class format { KITTI = 0, BINARY };
+
+    struct options {
+        format fmt = format::KITTI;
+        int fsync_every = 0;                // Poses between fsyncs, 0 = only on close
+        size_t buffer_bytes = 1 << 20;
+        size_t queue_batches = 64;          // write() blocks beyond this backlog
+    };
+
+    ~trajectory_writer();
+
+    // Truncates or creates the file and starts the writer thread
+    bool open(const std::string& path, const options& opts);
+    // Writes out everything queued, syncs and closes the file
+    void close();
+    bool is_open() const { return worker_.joinable(); }
+
+    // Poses [first, poses.size()) replace whatever the file holds from pose
+    // `first` on
+    void write(const trajectory& poses, size_t first);
+
+    // Updated by the writer thread
+    size_t poses_written() const { return poses_written_; }
+    size_t bytes_written() const { return bytes_written_; }
+    int fsyncs() const { return fsyncs_; }
+    bool failed() const { return failed_; }
+    size_t backlog() const { return queue_.size(); }
+
+private:
+    struct batch {
+        size_t first = 0;
+        std::vector<trajectory::pose> poses;
+    };
+
+    void run();
+    void append(const trajectory::pose& p);
+    bool truncate(size_t first);
+    bool flush();
+    void sync();
+    void fail(const char* what);
+
+    std::string path_;
+    options opts_;
+    int fd_ = -1;
+    std::thread worker_;
+    bounded_queue<batch> queue_;
+
+    // Writer thread only
+    std::string buffer_;
+    std::vector<long long> offsets_;    // Byte offset of each pose in the file
+    long long flushed_ = 0;             // Bytes handed to the file so far
+    int unsynced_ = 0;                  // Poses since the last fsync
+
+    std::atomic<size_t> poses_written_{0};
+    std::atomic<size_t> bytes_written_{0};
+    std::atomic<int> fsyncs_{0};
+    std::atomic<bool> failed_{false};
+};
@@ -0,0 +1,53 @@
+// include/core/vocabulary_tree.hpp
+#pragma once
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Sparse bag-of-words vector: (word id, weight) pairs sorted by word id,
+// weights L1-normalized.
+using bow_vector = std::vector<std::pair<int, float>>;
+
+// Hierarchical vocabulary over 256-bit binary descriptors (ORB), built by
+// recursive k-majority clustering: k-means under Hamming distance with the
+// bitwise majority as the cluster centre. A descriptor is quantized by
+// descending the tree, branching * depth distances per descriptor, so the
+// cost does not depend on how many words the vocabulary has. Leaves are
+// the words, weighted by inverse document frequency from the training set.
+class vocabulary_tree {
+public:
+    static constexpr int kBytes = 32;
+
+    // `images` holds one CV_8U descriptor matrix per training image (the
+    // grouping is needed for idf). Returns false if there is nothing to train on.
+    bool train(const std::vector<cv::Mat>& images, int branching, int depth,
+               int iterations = 10, unsigned seed = 0);
+
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+    bool empty() const { return word_count() == 0; }
+    int word_count() const { return static_cast<int>(idf_.size()); }
+    int branching() const { return branching_; }
+    int depth() const { return depth_; }
+
+    int word(const uint8_t* descriptor) const;
+
+    // tf-idf vector of one image's descriptors
+    void transform(const cv::Mat& descriptors, bow_vector& out) const;
+
+private:
+    struct node {
+        int first_child = 0;   // Children are nodes [first_child, first_child + child_count)
+        int child_count = 0;   // 0 for leaves
+        int word = -1;         // Word id for leaves
+    };
+
+    std::vector<node> nodes_;          // nodes_[0] is the root
+    std::vector<uint8_t> centroids_;   // One kBytes row per node
+    std::vector<float> idf_;           // Per word
+    int branching_ = 0;
+    int depth_ = 0;
+};
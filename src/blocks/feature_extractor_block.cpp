@@ -1,26 +1,305 @@
 #include "blocks/feature_extractor_block.hpp"
+#include "core/descriptor_quantization.hpp"
 
 #include <imnodes.h>
 #include <imgui.h>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <iostream>
 
 feature_extractor_block::feature_extractor_block(int id)
     : block(id, "Feature Extractor"), algorithm("ORB") {
     algorithm_index = 0;
     input_image = std::make_shared<data_port<cv::Mat>>("image");
+    input_pyramid = std::make_shared<data_port<image_pyramid>>("pyramid");
+    input_inliers = std::make_shared<data_port<int>>("inliers");
     output_keypoints = std::make_shared<data_port<std::vector<cv::KeyPoint>>>("keypoints");
     output_descriptors = std::make_shared<data_port<cv::Mat>>("descriptors");
+    output_features = std::make_shared<data_port<feature_set>>("features");
     create_extractor();
 }
 
 void feature_extractor_block::create_extractor() {
+    simd_extractor.release();
     if (algorithm == "ORB") {
-        extractor = cv::ORB::create();
-    } else if (algorithm == "SIFT") {
-        extractor = cv::SIFT::create();
+        extractor = cv::ORB::create(nfeatures, scale_factor, nlevels, 31, 0, 2,
+                                    cv::ORB::HARRIS_SCORE, 31, fast_threshold);
+    } else if (algorithm == "ORB-SIMD") {
+        simd_extractor = orb_simd::create(nfeatures, scale_factor, nlevels, fast_threshold);
+        extractor = simd_extractor;
+        std::cout << "[FeatureExtractor] ORB-SIMD using " << simd_level_name(simd_extractor->level()) << " kernels\n";
+    } else if (is_sift()) {
+        extractor = cv::SIFT::create(nfeatures);
     } else {
         std::cerr << "[FeatureExtractor] Unknown algorithm: " << algorithm << ", defaulting to ORB\n";
-        extractor = cv::ORB::create();
+        extractor = cv::ORB::create(nfeatures, scale_factor, nlevels, 31, 0, 2,
+                                    cv::ORB::HARRIS_SCORE, 31, fast_threshold);
+    }
+    level_extractors.clear();
+    tile_extractors.clear();
+}
+
+void feature_extractor_block::apply_parameters() {
+    // Setters only; the detectors keep their buffers
+    if (simd_extractor) {
+        simd_extractor->set_max_features(nfeatures);
+        simd_extractor->set_scale_factor(scale_factor);
+        simd_extractor->set_nlevels(nlevels);
+        simd_extractor->set_fast_threshold(fast_threshold);
+    } else if (auto orb = extractor.dynamicCast<cv::ORB>()) {
+        orb->setMaxFeatures(nfeatures);
+        orb->setScaleFactor(scale_factor);
+        orb->setNLevels(nlevels);
+        orb->setFastThreshold(fast_threshold);
+    } else if (auto sift = extractor.dynamicCast<cv::SIFT>()) {
+        sift->setNFeatures(nfeatures);
+    }
+    // Tile detectors pick up their budget and threshold through the same
+    // setters at the start of every tiled pass
+}
+
+void feature_extractor_block::adapt(double elapsed_ms, int detected) {
+    // Each pose result is fed back once; it lags the current frame by the
+    // depth of the pipeline, which is fine for a slow control loop.
+    int inliers = -1;
+    if (input_inliers->frame_id >= 0 && input_inliers->frame_id != last_inliers_frame_id) {
+        inliers = *input_inliers->data;
+        last_inliers_frame_id = input_inliers->frame_id;
+    }
+
+    auto next = controller.update(elapsed_ms, detected, inliers, {nfeatures, fast_threshold});
+    if (next.nfeatures != nfeatures || next.fast_threshold != fast_threshold) {
+        nfeatures = next.nfeatures;
+        fast_threshold = next.fast_threshold;
+        apply_parameters();
+    }
+}
+
+namespace {
+
+constexpr int kOrbEdgeThreshold = 31;  // cv::ORB and orb_simd drop keypoints this close to a border
+
+// Same geometric feature budget per level as cv::ORB
+std::vector<int> level_budgets(int total, int nlevels, float scale_factor) {
+    std::vector<int> per_level(nlevels);
+    const float inv_factor = 1.0f / scale_factor;
+    float share = total * (1.0f - inv_factor) / (1.0f - std::pow(inv_factor, static_cast<float>(nlevels)));
+    int assigned = 0;
+    for (int i = 0; i < nlevels - 1; ++i) {
+        per_level[i] = cvRound(share);
+        assigned += per_level[i];
+        share *= inv_factor;
+    }
+    per_level[nlevels - 1] = std::max(total - assigned, 0);
+    return per_level;
+}
+
+// One grid cell of one pyramid level, in that level's pixels
+struct tile_task {
+    int level = 0;
+    cv::Rect core;
+    cv::Rect padded;
+    int budget = 0;
+};
+
+} // namespace
+
+cv::Ptr<cv::Feature2D> feature_extractor_block::create_tile_extractor() const {
+    // Single level: ORB tiles are cut from the shared pyramid instead
+    if (is_sift()) return cv::SIFT::create(nfeatures);
+    if (algorithm == "ORB-SIMD") return orb_simd::create(nfeatures, scale_factor, 1, fast_threshold);
+    return cv::ORB::create(nfeatures, scale_factor, 1, kOrbEdgeThreshold, 0, 2,
+                           cv::ORB::HARRIS_SCORE, 31, fast_threshold);
+}
+
+void feature_extractor_block::extract_tiled(const cv::Mat& image,
+                                            std::vector<cv::KeyPoint>& keypoints,
+                                            cv::Mat& descriptors) {
+    cv::Mat gray;
+    if (image.channels() == 3) {
+        cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);  // Once, not once per tile
+    } else {
+        gray = image;
+    }
+
+    // SIFT builds its own octaves inside each tile. ORB tiles every level of
+    // one pyramid instead: padding by its edge threshold in level pixels keeps
+    // the seams intact at every scale, where a single full-resolution overlap
+    // would have to be 31 * scale^(nlevels-1) wide.
+    const bool orb = !is_sift();
+    const int overlap = orb ? std::max(tile_overlap, kOrbEdgeThreshold) : tile_overlap;
+    if (orb) build_image_pyramid(gray, nlevels, scale_factor, tile_pyramid);
+    const int levels = orb ? static_cast<int>(tile_pyramid.size()) : 1;
+    const int total = cell_budget > 0 ? cell_budget * grid_cols * grid_rows : nfeatures;
+    const std::vector<int> per_level = orb ? level_budgets(total, levels, tile_pyramid.scale_factor)
+                                           : std::vector<int>{total};
+
+    // Level 0 uses the requested grid; coarser levels drop cells narrower
+    // than 3x the overlap, where the padding would outweigh the cell.
+    std::vector<tile_task> tasks;
+    double tile_pixels = 0.0, level_pixels = 0.0;
+    for (int l = 0; l < levels; ++l) {
+        const cv::Mat& level = orb ? tile_pyramid.levels[l] : gray;
+        level_pixels += static_cast<double>(level.total());
+        if (per_level[l] <= 0) continue;
+
+        const int min_cell = l == 0 ? 1 : std::max(1, 3 * overlap);
+        const int cols = std::clamp(level.cols / min_cell, 1, grid_cols);
+        const int rows = std::clamp(level.rows / min_cell, 1, grid_rows);
+        const int budget = std::max(1, per_level[l] / (cols * rows));
+        for (int gy = 0; gy < rows; ++gy) {
+            for (int gx = 0; gx < cols; ++gx) {
+                tile_task t;
+                t.level = l;
+                t.core = cv::Rect(gx * level.cols / cols, gy * level.rows / rows,
+                                  (gx + 1) * level.cols / cols - gx * level.cols / cols,
+                                  (gy + 1) * level.rows / rows - gy * level.rows / rows);
+                t.padded = cv::Rect(t.core.x - overlap, t.core.y - overlap,
+                                    t.core.width + 2 * overlap, t.core.height + 2 * overlap)
+                           & cv::Rect(0, 0, level.cols, level.rows);
+                t.budget = budget;
+                tile_pixels += t.padded.area();
+                tasks.push_back(t);
+            }
+        }
+    }
+    last_tile_overlap = overlap;
+    last_tile_redundancy = level_pixels > 0.0 ? static_cast<float>(tile_pixels / level_pixels) : 0.0f;
+
+    const int ntasks = static_cast<int>(tasks.size());
+    while (static_cast<int>(tile_extractors.size()) < ntasks) tile_extractors.push_back(create_tile_extractor());
+
+    std::vector<std::vector<cv::KeyPoint>> task_kpts(ntasks);
+    std::vector<cv::Mat> task_desc(ntasks);
+
+    cv::parallel_for_(cv::Range(0, ntasks), [&](const cv::Range& range) {
+        for (int c = range.start; c < range.end; ++c) {
+            const tile_task& t = tasks[c];
+            const cv::Mat tile = (orb ? tile_pyramid.levels[t.level] : gray)(t.padded);
+            const float scale = orb ? tile_pyramid.scales[t.level] : 1.0f;
+
+            // Over-detect a little: part of each tile's detections fall in the overlap
+            const int detect_budget = t.budget + t.budget / 2;
+            const cv::Ptr<cv::Feature2D>& detector = tile_extractors[c];
+            if (auto simd = detector.dynamicCast<orb_simd>()) {
+                simd->set_max_features(detect_budget);
+                simd->set_fast_threshold(fast_threshold);
+            } else if (auto orb_tile = detector.dynamicCast<cv::ORB>()) {
+                orb_tile->setMaxFeatures(detect_budget);
+                orb_tile->setFastThreshold(fast_threshold);
+            } else if (auto sift = detector.dynamicCast<cv::SIFT>()) {
+                sift->setNFeatures(detect_budget);
+            }
+
+            // One pass per tile; describing the few detections dropped below
+            // is cheaper than a second pass for a separate compute()
+            std::vector<cv::KeyPoint> detected;
+            cv::Mat detected_desc;
+            detector->detectAndCompute(tile, cv::noArray(), detected, detected_desc);
+
+            // Keep only keypoints owned by this cell so overlaps do not
+            // duplicate, then the strongest `budget` of those
+            const cv::Rect owned(t.core.x - t.padded.x, t.core.y - t.padded.y, t.core.width, t.core.height);
+            std::vector<int> keep;
+            for (int i = 0; i < static_cast<int>(detected.size()); ++i) {
+                const cv::Point p(cvFloor(detected[i].pt.x), cvFloor(detected[i].pt.y));
+                if (owned.contains(p)) keep.push_back(i);
+            }
+            if (static_cast<int>(keep.size()) > t.budget) {
+                std::nth_element(keep.begin(), keep.begin() + t.budget, keep.end(),
+                                 [&detected](int a, int b) { return detected[a].response > detected[b].response; });
+                keep.resize(t.budget);
+                std::sort(keep.begin(), keep.end());
+            }
+
+            // Back to full-resolution coordinates, same convention as extract_from_pyramid
+            std::vector<cv::KeyPoint> kpts;
+            cv::Mat desc(static_cast<int>(keep.size()), detected_desc.cols, detected_desc.type());
+            kpts.reserve(keep.size());
+            for (int k = 0; k < static_cast<int>(keep.size()); ++k) {
+                cv::KeyPoint kp = detected[keep[k]];
+                kp.pt.x = (kp.pt.x + t.padded.x) * scale;
+                kp.pt.y = (kp.pt.y + t.padded.y) * scale;
+                if (orb) {
+                    kp.size *= scale;
+                    kp.octave = t.level;
+                }
+                kpts.push_back(kp);
+                detected_desc.row(keep[k]).copyTo(desc.row(k));
+            }
+            task_kpts[c] = std::move(kpts);
+            task_desc[c] = desc;
+        }
+    });
+
+    // Merge in level then cell order so the output is deterministic
+    keypoints.clear();
+    std::vector<cv::Mat> nonempty;
+    for (int c = 0; c < ntasks; ++c) {
+        if (task_kpts[c].empty() || task_desc[c].empty()) continue;
+        keypoints.insert(keypoints.end(), task_kpts[c].begin(), task_kpts[c].end());
+        nonempty.push_back(task_desc[c]);
+    }
+    if (nonempty.empty()) {
+        descriptors.release();
+    } else {
+        cv::vconcat(nonempty, descriptors);
+    }
+}
+
+void feature_extractor_block::extract_from_pyramid(const image_pyramid& pyramid,
+                                                   std::vector<cv::KeyPoint>& keypoints,
+                                                   cv::Mat& descriptors) {
+    if (simd_extractor) {
+        simd_extractor->detect_and_compute(pyramid, keypoints, descriptors);
+        return;
+    }
+    if (algorithm != "ORB") {
+        // SIFT builds its own DoG octaves; only the full-resolution level is useful
+        extractor->detectAndCompute(pyramid.levels[0], cv::noArray(), keypoints, descriptors);
+        return;
+    }
+
+    const int nlevels = static_cast<int>(pyramid.size());
+    const std::vector<int> per_level = level_budgets(nfeatures, nlevels, pyramid.scale_factor);
+
+    if (static_cast<int>(level_extractors.size()) != nlevels) {
+        level_extractors.clear();
+        for (int i = 0; i < nlevels; ++i) {
+            level_extractors.push_back(cv::ORB::create(std::max(1, per_level[i]), pyramid.scale_factor, 1, 31, 0, 2,
+                                                       cv::ORB::HARRIS_SCORE, 31, fast_threshold));
+        }
+    }
+
+    keypoints.clear();
+    std::vector<cv::Mat> level_descriptors;
+    for (int i = 0; i < nlevels; ++i) {
+        if (per_level[i] <= 0) continue;
+        level_extractors[i]->setMaxFeatures(per_level[i]);
+        level_extractors[i]->setFastThreshold(fast_threshold);
+
+        std::vector<cv::KeyPoint> level_kpts;
+        cv::Mat level_desc;
+        level_extractors[i]->detectAndCompute(pyramid.levels[i], cv::noArray(), level_kpts, level_desc);
+        if (level_kpts.empty()) continue;
+
+        const float scale = pyramid.scales[i];
+        for (auto& kp : level_kpts) {
+            kp.pt.x *= scale;
+            kp.pt.y *= scale;
+            kp.size *= scale;
+            kp.octave = i;
+        }
+        keypoints.insert(keypoints.end(), level_kpts.begin(), level_kpts.end());
+        level_descriptors.push_back(level_desc);
+    }
+
+    if (level_descriptors.empty()) {
+        descriptors.release();
+    } else {
+        cv::vconcat(level_descriptors, descriptors);
     }
 }
 
@@ -34,9 +313,13 @@ bool feature_extractor_block::is_port_connected(int port_index, const std::vecto
 }
 
 void feature_extractor_block::process(const std::vector<link_t>& links) {
-    if (!input_image->data || input_image->data->empty()) return;
+    bool has_image = input_image->data && !input_image->data->empty();
+    bool has_pyramid = input_pyramid->data && !input_pyramid->data->empty();
+    if (!has_image && !has_pyramid) return;
 
-    int input_frame_id = input_image->frame_id;
+    // Prefer the shared pyramid whenever it is at least as fresh as the image
+    bool use_pyramid = has_pyramid && (!has_image || input_pyramid->frame_id >= input_image->frame_id);
+    int input_frame_id = use_pyramid ? input_pyramid->frame_id : input_image->frame_id;
     if (input_frame_id == last_processed_frame_id) {
         // Already processed this frame, skip redundant work
         return;
@@ -46,10 +329,25 @@ void feature_extractor_block::process(const std::vector<link_t>& links) {
     std::vector<cv::KeyPoint> keypoints;
     cv::Mat descriptors;
 
-    extractor->detectAndCompute(*input_image->data, cv::noArray(), keypoints, descriptors);
+    auto start = std::chrono::steady_clock::now();
+    if (use_pyramid) {
+        extract_from_pyramid(*input_pyramid->data, keypoints, descriptors);
+    } else if (tiled) {
+        extract_tiled(*input_image->data, keypoints, descriptors);
+    } else {
+        extractor->detectAndCompute(*input_image->data, cv::noArray(), keypoints, descriptors);
+    }
+    if (algorithm == "SIFT-U8") rootsift_u8(descriptors, descriptors);
+    last_extract_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (adaptive) adapt(last_extract_ms, static_cast<int>(keypoints.size()));
 
     output_keypoints->set(keypoints, input_frame_id);
     output_descriptors->set(descriptors, input_frame_id);
+    if (is_port_connected(2, links)) {
+        // Only pay for the columnar copy when something consumes it
+        *output_features->data = feature_set::from_keypoints(keypoints, descriptors);
+        output_features->frame_id = input_frame_id;
+    }
 
     std::cout << "[FeatureExtractor] Node " << id
               << " computed " << keypoints.size()
@@ -64,14 +362,25 @@ void feature_extractor_block::draw_ui() {
     ImNodes::EndNodeTitleBar();
 
     int input_attr_id        = id * 100 + 0;
+    int pyramid_attr_id      = id * 100 + 1;
+    int inliers_attr_id      = id * 100 + 2;
     int descriptors_attr_id  = id * 10 + 0;
     int keypoints_attr_id    = id * 10 + 1;
+    int features_attr_id     = id * 10 + 2;
 
     ImNodes::BeginInputAttribute(input_attr_id);
     ImGui::Text("Img");
     ImGui::Dummy(ImVec2(1, 1));
     ImNodes::EndInputAttribute();
 
+    ImNodes::BeginInputAttribute(pyramid_attr_id);
+    ImGui::Text("Pyr");
+    ImNodes::EndInputAttribute();
+
+    ImNodes::BeginInputAttribute(inliers_attr_id);
+    ImGui::Text("Inl");
+    ImNodes::EndInputAttribute();
+
     ImNodes::BeginOutputAttribute(descriptors_attr_id);
     ImGui::Text("Desc");
     ImNodes::EndOutputAttribute();
@@ -80,6 +389,10 @@ void feature_extractor_block::draw_ui() {
     ImGui::Text("Kpts");
     ImNodes::EndOutputAttribute();
 
+    ImNodes::BeginOutputAttribute(features_attr_id);
+    ImGui::Text("Feats");
+    ImNodes::EndOutputAttribute();
+
     ImGui::Text("Algo:");
     ImGui::SetNextItemWidth(80);
     const char* current = available_algorithms[algorithm_index].c_str();
@@ -96,21 +409,74 @@ void feature_extractor_block::draw_ui() {
         ImGui::EndCombo();
     }
 
+    bool changed = false;
+    ImGui::SetNextItemWidth(80);
+    changed |= ImGui::SliderInt("Features", &nfeatures, 50, 5000);
+    if (!is_sift()) {
+        ImGui::SetNextItemWidth(80);
+        changed |= ImGui::SliderInt("Levels", &nlevels, 1, 12);
+        ImGui::SetNextItemWidth(80);
+        changed |= ImGui::SliderFloat("Scale", &scale_factor, 1.1f, 2.0f);
+        ImGui::SetNextItemWidth(80);
+        changed |= ImGui::SliderInt("FAST thr", &fast_threshold, 5, 60);
+    }
+    if (changed) apply_parameters();
+
+    if (ImGui::Checkbox("Adaptive", &adaptive)) controller.reset();
+    if (adaptive) {
+        ImGui::SetNextItemWidth(80);
+        ImGui::SliderFloat("Budget ms", &controller.cfg.budget_ms, 1.0f, 100.0f);
+        ImGui::SetNextItemWidth(80);
+        ImGui::SliderInt("Target inl", &controller.cfg.target_inliers, 10, 1000);
+        ImGui::Text("%.1f ms (%s)", last_extract_ms, controller.over_budget() ? "over" : "ok");
+    } else {
+        ImGui::Text("%.1f ms", last_extract_ms);
+    }
+
+    ImGui::Checkbox("Tiled", &tiled);
+    if (tiled) {
+        ImGui::SetNextItemWidth(80);
+        ImGui::SliderInt("Cols", &grid_cols, 1, 16);
+        ImGui::SetNextItemWidth(80);
+        ImGui::SliderInt("Rows", &grid_rows, 1, 16);
+        ImGui::SetNextItemWidth(80);
+        ImGui::SliderInt("Overlap", &tile_overlap, 0, 64);
+        if (last_tile_redundancy > 0.0f) {
+            ImGui::Text("Pad %d px, %.2fx pixels", last_tile_overlap, last_tile_redundancy);
+        }
+        ImGui::SetNextItemWidth(80);
+        if (ImGui::InputInt("Per cell", &cell_budget)) cell_budget = std::max(0, cell_budget);
+    }
+
     ImNodes::EndNode();
 }
 
 std::vector<std::shared_ptr<base_port>> feature_extractor_block::get_input_ports() {
-    return {input_image};
+    return {input_image, input_pyramid, input_inliers};
 }
 
 std::vector<std::shared_ptr<base_port>> feature_extractor_block::get_output_ports() {
-    return {output_descriptors, output_keypoints};
+    return {output_descriptors, output_keypoints, output_features};
 }
 
 nlohmann::json feature_extractor_block::serialize() const {
     nlohmann::json j;
     j["algorithm"] = algorithm;
     j["algorithm_index"] = algorithm_index;
+    j["tiled"] = tiled;
+    j["grid_cols"] = grid_cols;
+    j["grid_rows"] = grid_rows;
+    j["tile_overlap"] = tile_overlap;
+    j["cell_budget"] = cell_budget;
+    j["nfeatures"] = nfeatures;
+    j["nlevels"] = nlevels;
+    j["scale_factor"] = scale_factor;
+    j["fast_threshold"] = fast_threshold;
+    j["adaptive"] = adaptive;
+    j["budget_ms"] = controller.cfg.budget_ms;
+    j["target_inliers"] = controller.cfg.target_inliers;
+    j["min_features"] = controller.cfg.min_features;
+    j["max_features"] = controller.cfg.max_features;
     return j;
 }
 
@@ -125,6 +491,48 @@ void feature_extractor_block::deserialize(const nlohmann::json& j) {
             algorithm = available_algorithms[algorithm_index];
         }
     }
+    if (j.contains("tiled")) {
+        tiled = j["tiled"];
+    }
+    if (j.contains("grid_cols")) {
+        grid_cols = std::clamp(j["grid_cols"].get<int>(), 1, 16);
+    }
+    if (j.contains("grid_rows")) {
+        grid_rows = std::clamp(j["grid_rows"].get<int>(), 1, 16);
+    }
+    if (j.contains("tile_overlap")) {
+        tile_overlap = j["tile_overlap"];
+    }
+    if (j.contains("cell_budget")) {
+        cell_budget = j["cell_budget"];
+    }
+    if (j.contains("nfeatures")) {
+        nfeatures = std::max(1, j["nfeatures"].get<int>());
+    }
+    if (j.contains("nlevels")) {
+        nlevels = std::clamp(j["nlevels"].get<int>(), 1, 12);
+    }
+    if (j.contains("scale_factor")) {
+        scale_factor = std::max(1.01f, j["scale_factor"].get<float>());
+    }
+    if (j.contains("fast_threshold")) {
+        fast_threshold = std::clamp(j["fast_threshold"].get<int>(), 1, 254);
+    }
+    if (j.contains("adaptive")) {
+        adaptive = j["adaptive"];
+    }
+    if (j.contains("budget_ms")) {
+        controller.cfg.budget_ms = j["budget_ms"];
+    }
+    if (j.contains("target_inliers")) {
+        controller.cfg.target_inliers = j["target_inliers"];
+    }
+    if (j.contains("min_features")) {
+        controller.cfg.min_features = j["min_features"];
+    }
+    if (j.contains("max_features")) {
+        controller.cfg.max_features = j["max_features"];
+    }
     // Recreate the extractor with the loaded settings
     create_extractor();
 }
@@ -3,15 +3,353 @@
 #include <imnodes.h>
 #include <opencv2/features2d.hpp>
 #include <opencv2/flann.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
 #include <iostream>
+#include <utility>
 
 feature_matcher_block::feature_matcher_block(int id)
     : block(id, "Feature Matcher") {
     desc1_in = std::make_shared<data_port<cv::Mat>>("Desc 1");
     desc2_in = std::make_shared<data_port<cv::Mat>>("Desc 2");
+    kpts1_in = std::make_shared<data_port<std::vector<cv::KeyPoint>>>("Keypoints 1");
+    kpts2_in = std::make_shared<data_port<std::vector<cv::KeyPoint>>>("Keypoints 2");
+    H_in = std::make_shared<data_port<cv::Mat>>("Homography");
+    R_in = std::make_shared<data_port<cv::Mat>>("Rotation");
+    t_in = std::make_shared<data_port<cv::Mat>>("Translation");
+    K_in = std::make_shared<data_port<cv::Mat>>("Camera Matrix");
     matches_out = std::make_shared<data_port<std::vector<cv::DMatch>>>("Matches");
 }
 
+namespace {
+
+// Content key for a descriptor matrix (FNV-1a over 8-byte words)
+uint64_t descriptor_key(const cv::Mat& m) {
+    uint64_t h = 1469598103934665603ull;
+    auto mix = [&h](uint64_t v) {
+        h ^= v;
+        h *= 1099511628211ull;
+    };
+    mix(static_cast<uint64_t>(m.rows));
+    mix(static_cast<uint64_t>(m.cols));
+    mix(static_cast<uint64_t>(m.type()));
+
+    const size_t row_bytes = m.cols * m.elemSize();
+    for (int r = 0; r < m.rows; ++r) {
+        const uchar* p = m.ptr(r);
+        size_t i = 0;
+        for (; i + 8 <= row_bytes; i += 8) {
+            uint64_t w;
+            std::memcpy(&w, p + i, 8);
+            mix(w);
+        }
+        for (; i < row_bytes; ++i) mix(p[i]);
+    }
+    return h;
+}
+
+// CV_64F copy of a 3x3 matrix, or empty when the input is missing or not 3x3
+cv::Mat as_mat3(const cv::Mat* m) {
+    cv::Mat out;
+    if (m && m->rows == 3 && m->cols == 3 && m->channels() == 1) m->convertTo(out, CV_64F);
+    return out;
+}
+
+// After a swapped (desc2 -> desc1) search several desc2 rows can pick the
+// same desc1 row; keep the closest one per queryIdx, ordered by queryIdx
+void keep_unique_queries(std::vector<cv::DMatch>& good) {
+    std::sort(good.begin(), good.end(), [](const cv::DMatch& a, const cv::DMatch& b) {
+        return a.queryIdx != b.queryIdx ? a.queryIdx < b.queryIdx : a.distance < b.distance;
+    });
+    good.erase(std::unique(good.begin(), good.end(),
+                           [](const cv::DMatch& a, const cv::DMatch& b) { return a.queryIdx == b.queryIdx; }),
+               good.end());
+}
+
+}  // namespace
+
+const feature_matcher_block::flann_entry* feature_matcher_block::find_index(uint64_t key, descriptor_metric m) const {
+    for (const auto& e : flann_cache) {
+        if (e.index && e.key == key && e.metric == m) return &e;
+    }
+    return nullptr;
+}
+
+descriptor_metric feature_matcher_block::metric(const cv::Mat& descriptors) const {
+    // Selecting BF-L2 declares uint8 input to be quantized, whatever its width
+    if (matcher_type_index == 1 && descriptors.type() == CV_8U) return descriptor_metric::L2_U8;
+    return metric_of(descriptors);
+}
+
+const feature_matcher_block::flann_entry& feature_matcher_block::build_index(uint64_t key, const cv::Mat& descriptors,
+                                                                             descriptor_metric m) {
+    // Two slots are enough for a frame stream; the older one is evicted
+    flann_cache[1] = std::move(flann_cache[0]);
+    flann_entry& e = flann_cache[0];
+    e.key = key;
+    e.metric = m;
+    if (m == descriptor_metric::HAMMING) {
+        // Binary descriptors: LSH under Hamming distance
+        e.descriptors = descriptors;
+        e.index = cv::makePtr<cv::flann::Index>(descriptors, cv::flann::LshIndexParams(12, 20, 2),
+                                                cvflann::FLANN_DIST_HAMMING);
+    } else {
+        // KD-trees need float rows; quantized descriptors are widened once per index
+        if (descriptors.type() == CV_32F) {
+            e.descriptors = descriptors;
+        } else {
+            descriptors.convertTo(e.descriptors, CV_32F);
+        }
+        e.index = cv::makePtr<cv::flann::Index>(e.descriptors, cv::flann::KDTreeIndexParams(4),
+                                                cvflann::FLANN_DIST_L2);
+    }
+    ++index_builds;
+    return e;
+}
+
+bool feature_matcher_block::match_bf(const cv::Mat& desc1, const cv::Mat& desc2, std::vector<cv::DMatch>& good) {
+    // The FLANN, MIH and guided fallbacks land here too, so the norm follows
+    // the descriptors rather than the selected matcher
+    const descriptor_metric m = metric(desc1);
+    const bool l2 = m != descriptor_metric::HAMMING;
+    const bool native = desc1.type() == CV_8U && desc2.type() == CV_8U && desc1.cols == desc2.cols;
+    if (native && !l2) {
+        knn2_hamming(desc1, desc2, lowe_ratio, knn_results);
+        collect_matches(knn_results, good);
+        return true;
+    }
+    if (native && l2) {
+        // Quantized descriptors (SIFT-U8): integer L2, distances come back squared
+        knn2_l2_u8(desc1, desc2, lowe_ratio, knn_results);
+        collect_matches(knn_results, good);
+        for (auto& m : good) m.distance = std::sqrt(m.distance);
+        return true;
+    }
+
+    const int norm = l2 ? cv::NORM_L2 : cv::NORM_HAMMING;
+    if (!bf_matcher || bf_matcher_type != norm) {
+        bf_matcher = cv::BFMatcher::create(norm, false);
+        bf_matcher_type = norm;
+    }
+
+    std::vector<std::vector<cv::DMatch>> knn_matches;
+    bf_matcher->knnMatch(desc1, desc2, knn_matches, 2);
+
+    good.clear();
+    for (const auto& pair : knn_matches) {
+        if (pair.size() >= 2 && pair[0].distance < lowe_ratio * pair[1].distance) {
+            good.push_back(pair[0]);
+        }
+    }
+    return true;
+}
+
+bool feature_matcher_block::match_guided(const cv::Mat& desc1, const cv::Mat& desc2, std::vector<cv::DMatch>& good) {
+    const std::vector<cv::KeyPoint>* kpts1 = kpts1_in->get();
+    const std::vector<cv::KeyPoint>* kpts2 = kpts2_in->get();
+    if (!kpts1 || !kpts2) return false;
+    if (static_cast<int>(kpts1->size()) != desc1.rows || static_cast<int>(kpts2->size()) != desc2.rows) return false;
+    if (desc1.type() != desc2.type() || desc1.cols != desc2.cols) return false;
+    const descriptor_metric m = metric(desc1);
+    const bool binary = m == descriptor_metric::HAMMING;
+    const bool quantized = m == descriptor_metric::L2_U8;
+    if (desc1.type() != CV_8U && desc1.type() != CV_32F) return false;
+
+    // Prediction: the homography if given, otherwise the rotation part of the
+    // last pose (infinite homography K R K^-1); translation parallax has to
+    // fit inside the window. Under constant velocity the previous relative
+    // motion stands in for the current one.
+    cv::Mat H = as_mat3(H_in->get());
+    cv::Mat F;
+    if (H.empty()) {
+        cv::Mat K = as_mat3(K_in->get());
+        cv::Mat R = as_mat3(R_in->get());
+        if (K.empty() || R.empty()) return false;
+        cv::Mat K_inv = K.inv();
+        H = K * R * K_inv;
+
+        const cv::Mat* t = t_in->get();
+        if (epipolar_gate && t && t->total() == 3) {
+            cv::Mat tv;
+            t->reshape(1, 3).convertTo(tv, CV_64F);
+            if (cv::norm(tv) > 1e-9) {
+                const double tx = tv.at<double>(0), ty = tv.at<double>(1), tz = tv.at<double>(2);
+                cv::Mat t_cross = (cv::Mat_<double>(3, 3) << 0, -tz, ty, tz, 0, -tx, -ty, tx, 0);
+                F = K_inv.t() * t_cross * R * K_inv;
+            }
+        }
+    }
+
+    double h[9], f[9];
+    for (int i = 0; i < 9; ++i) {
+        h[i] = H.at<double>(i / 3, i % 3);
+        f[i] = F.empty() ? 0.0 : F.at<double>(i / 3, i % 3);
+    }
+    const bool use_f = !F.empty();
+
+    train_grid.build(*kpts2, window_radius);
+    guided_rows.resize(desc1.rows);
+    std::atomic<long long> total_candidates{0};
+
+    cv::parallel_for_(cv::Range(0, desc1.rows), [&](const cv::Range& range) {
+        std::vector<int> candidates;
+        long long local = 0;
+        for (int q = range.start; q < range.end; ++q) {
+            cv::DMatch& out = guided_rows[q];
+            out = cv::DMatch();
+
+            const cv::Point2f& p = (*kpts1)[q].pt;
+            const double w = h[6] * p.x + h[7] * p.y + h[8];
+            if (std::abs(w) < 1e-12) continue;
+            const float px = static_cast<float>((h[0] * p.x + h[1] * p.y + h[2]) / w);
+            const float py = static_cast<float>((h[3] * p.x + h[4] * p.y + h[5]) / w);
+            if (!std::isfinite(px) || !std::isfinite(py)) continue;
+
+            // Epipolar line of p in image 2: l = F [x y 1]^T
+            const double la = f[0] * p.x + f[1] * p.y + f[2];
+            const double lb = f[3] * p.x + f[4] * p.y + f[5];
+            const double lc = f[6] * p.x + f[7] * p.y + f[8];
+            const double max_line_dist = epipolar_threshold * std::sqrt(la * la + lb * lb);
+
+            candidates.clear();
+            train_grid.for_each_in_radius(px, py, window_radius, [&](int i) {
+                if (use_f) {
+                    const cv::Point2f& c = (*kpts2)[i].pt;
+                    if (std::abs(la * c.x + lb * c.y + lc) > max_line_dist) return;
+                }
+                candidates.push_back(i);
+            });
+            local += static_cast<long long>(candidates.size());
+
+            if (binary) {
+                knn2_match m;
+                knn2_hamming_subset(desc1.ptr<uint8_t>(q), desc2.ptr<uint8_t>(0), desc2.step,
+                                    candidates.data(), static_cast<int>(candidates.size()),
+                                    desc1.cols, lowe_ratio, m);
+                if (m.accepted) out = cv::DMatch(q, m.best_idx, static_cast<float>(m.best_dist));
+            } else if (quantized) {
+                knn2_match m;
+                knn2_l2_u8_subset(desc1.ptr<uint8_t>(q), desc2.ptr<uint8_t>(0), desc2.step,
+                                  candidates.data(), static_cast<int>(candidates.size()),
+                                  desc1.cols, lowe_ratio, m);
+                if (m.accepted) out = cv::DMatch(q, m.best_idx, std::sqrt(static_cast<float>(m.best_dist)));
+            } else {
+                const float* a = desc1.ptr<float>(q);
+                float best = FLT_MAX, second = FLT_MAX;
+                int best_idx = -1;
+                for (int i : candidates) {
+                    const float* b = desc2.ptr<float>(i);
+                    float d = 0.0f;
+                    for (int k = 0; k < desc1.cols; ++k) {
+                        const float e = a[k] - b[k];
+                        d += e * e;
+                    }
+                    if (d < best) {
+                        second = best;
+                        best = d;
+                        best_idx = i;
+                    } else if (d < second) {
+                        second = d;
+                    }
+                }
+                // Squared distances: ratio test on the squares
+                if (second < FLT_MAX && best < lowe_ratio * lowe_ratio * second) {
+                    out = cv::DMatch(q, best_idx, std::sqrt(best));
+                }
+            }
+        }
+        total_candidates += local;
+    });
+
+    good.clear();
+    for (const cv::DMatch& m : guided_rows) {
+        if (m.queryIdx >= 0) good.push_back(m);
+    }
+
+    const double per_query = desc1.rows > 0 ? static_cast<double>(total_candidates) / desc1.rows : 0.0;
+    avg_candidates = avg_candidates <= 0.0 ? per_query : 0.9 * avg_candidates + 0.1 * per_query;
+    return true;
+}
+
+bool feature_matcher_block::match_flann(const cv::Mat& desc1, const cv::Mat& desc2, std::vector<cv::DMatch>& good) {
+    if (desc1.type() != desc2.type() || desc1.cols != desc2.cols) {
+        std::cerr << "[Matcher] Descriptor layouts differ\n";
+        return false;
+    }
+    if (desc1.rows < 2 || desc2.rows < 2) return false;
+
+    // desc2 is the indexed side; only one-to-many mode may search the other
+    // way round. Matches keep queryIdx -> desc1, trainIdx -> desc2 either way.
+    const descriptor_metric m = metric(desc1);
+    const uint64_t key2 = descriptor_key(desc2);
+    bool swapped = false;
+    const flann_entry* entry = find_index(key2, m);
+    if (!entry && one_to_many_reuse && (entry = find_index(descriptor_key(desc1), m))) swapped = true;
+    if (entry) {
+        ++index_reuses;
+    } else {
+        entry = &build_index(key2, desc2, m);
+    }
+    cv::Mat query = swapped ? desc2 : desc1;
+    if (m == descriptor_metric::L2_U8) query.convertTo(query, CV_32F);
+
+    cv::Mat indices, dists;
+    entry->index->knnSearch(query, indices, dists, 2, cv::flann::SearchParams(32));
+    if (dists.type() != CV_32F) dists.convertTo(dists, CV_32F);  // Hamming comes back as int
+    const bool squared = m != descriptor_metric::HAMMING;        // FLANN's L2 is squared
+
+    good.clear();
+    for (int i = 0; i < indices.rows; ++i) {
+        const int* idx = indices.ptr<int>(i);
+        const float* d = dists.ptr<float>(i);
+        if (idx[0] < 0 || idx[1] < 0) continue;
+        const float d0 = squared ? std::sqrt(d[0]) : d[0];
+        const float d1 = squared ? std::sqrt(d[1]) : d[1];
+        if (d0 < lowe_ratio * d1) {
+            good.emplace_back(swapped ? idx[0] : i, swapped ? i : idx[0], d0);
+        }
+    }
+    if (swapped) keep_unique_queries(good);
+    return true;
+}
+
+bool feature_matcher_block::match_mih(const cv::Mat& desc1, const cv::Mat& desc2, std::vector<cv::DMatch>& good) {
+    if (metric(desc1) != descriptor_metric::HAMMING || desc2.type() != CV_8U ||
+        desc1.cols != mih_index::kBytes || desc2.cols != mih_index::kBytes) {
+        // MIH tables are laid out for 256-bit codes only
+        std::cerr << "[Matcher] MIH needs 32-byte binary descriptors, using brute force\n";
+        return match_bf(desc1, desc2, good);
+    }
+
+    // Same reuse rule as FLANN: desc2 is indexed unless one-to-many applies
+    const uint64_t key2 = descriptor_key(desc2);
+    bool swapped = false;
+    if (mih_valid && mih_key == key2) {
+        ++index_reuses;
+    } else if (mih_valid && one_to_many_reuse && mih_key == descriptor_key(desc1)) {
+        swapped = true;
+        ++index_reuses;
+    } else {
+        mih.clear();
+        mih.add(desc2);
+        mih.rebuild();
+        mih_key = key2;
+        mih_valid = true;
+        ++index_builds;
+    }
+
+    mih.knn2(swapped ? desc2 : desc1, lowe_ratio, knn_results, mih_max_radius);
+    collect_matches(knn_results, good);
+    if (swapped) {
+        for (auto& m : good) std::swap(m.queryIdx, m.trainIdx);
+        keep_unique_queries(good);
+    }
+    return true;
+}
+
 void feature_matcher_block::process(const std::vector<link_t>&) {
     const cv::Mat* desc1 = desc1_in->get();
     const cv::Mat* desc2 = desc2_in->get();
@@ -24,37 +362,41 @@ void feature_matcher_block::process(const std::vector<link_t>&) {
     }
     last_processed_frame_id = input_frame_id;
 
-    std::vector<std::vector<cv::DMatch>> knn_matches;
-    cv::Ptr<cv::DescriptorMatcher> matcher;
-
-    switch (matcher_type_index) {
-        case 0:
-            matcher = cv::BFMatcher::create(cv::NORM_HAMMING, false);
-            break;
-        case 1:
-            matcher = cv::BFMatcher::create(cv::NORM_L2, false);
-            break;
-        case 2:
-            matcher = cv::DescriptorMatcher::create(cv::DescriptorMatcher::FLANNBASED);
-            break;
-        default:
-            std::cerr << "[Matcher] Invalid matcher type\n";
-            return;
-    }
-
+    std::vector<cv::DMatch> good_matches;
+    bool ok = false;
     try {
-        matcher->knnMatch(*desc1, *desc2, knn_matches, 2);
+        if (guided) {
+            // Too few guided matches usually means a bad prediction (or a
+            // missing one): match the full sets instead
+            if (match_guided(*desc1, *desc2, good_matches) &&
+                static_cast<int>(good_matches.size()) >= min_guided_matches) {
+                ++guided_frames;
+                matches_out->set(good_matches, input_frame_id);
+                return;
+            }
+            ++guided_fallbacks;
+        }
+
+        switch (matcher_type_index) {
+            case 0:
+            case 1:
+                ok = match_bf(*desc1, *desc2, good_matches);
+                break;
+            case 2:
+                ok = match_flann(*desc1, *desc2, good_matches);
+                break;
+            case 3:
+                ok = match_mih(*desc1, *desc2, good_matches);
+                break;
+            default:
+                std::cerr << "[Matcher] Invalid matcher type\n";
+                return;
+        }
     } catch (const cv::Exception& e) {
         std::cerr << "[Matcher] OpenCV error: " << e.what() << "\n";
         return;
     }
-
-    std::vector<cv::DMatch> good_matches;
-    for (const auto& pair : knn_matches) {
-        if (pair.size() >= 2 && pair[0].distance < lowe_ratio * pair[1].distance) {
-            good_matches.push_back(pair[0]);
-        }
-    }
+    if (!ok) return;
 
     matches_out->set(good_matches, input_frame_id);
 }
@@ -77,6 +419,36 @@ void feature_matcher_block::draw_ui() {
     ImGui::Dummy(ImVec2(1, 1));
     ImNodes::EndInputAttribute();
 
+    ImNodes::BeginInputAttribute(id * 100 + 2);
+    ImGui::Text("K1");
+    ImGui::Dummy(ImVec2(1, 1));
+    ImNodes::EndInputAttribute();
+
+    ImNodes::BeginInputAttribute(id * 100 + 3);
+    ImGui::Text("K2");
+    ImGui::Dummy(ImVec2(1, 1));
+    ImNodes::EndInputAttribute();
+
+    ImNodes::BeginInputAttribute(id * 100 + 4);
+    ImGui::Text("H");
+    ImGui::Dummy(ImVec2(1, 1));
+    ImNodes::EndInputAttribute();
+
+    ImNodes::BeginInputAttribute(id * 100 + 5);
+    ImGui::Text("R");
+    ImGui::Dummy(ImVec2(1, 1));
+    ImNodes::EndInputAttribute();
+
+    ImNodes::BeginInputAttribute(id * 100 + 6);
+    ImGui::Text("t");
+    ImGui::Dummy(ImVec2(1, 1));
+    ImNodes::EndInputAttribute();
+
+    ImNodes::BeginInputAttribute(id * 100 + 7);
+    ImGui::Text("K");
+    ImGui::Dummy(ImVec2(1, 1));
+    ImNodes::EndInputAttribute();
+
     // Output port
     ImNodes::BeginOutputAttribute(id * 10 + 0);
     ImGui::Text("M");
@@ -85,7 +457,7 @@ void feature_matcher_block::draw_ui() {
     // Matcher type selector
     ImGui::Text("Type:");
     ImGui::SetNextItemWidth(100);
-    static const char* matcher_names[] = { "BF-HAM", "BF-L2", "FLANN" };
+    static const char* matcher_names[] = { "BF-HAM", "BF-L2", "FLANN", "MIH" };
     ImGui::Combo("##matcher", &matcher_type_index, matcher_names, IM_ARRAYSIZE(matcher_names));
 
     // Lowe's ratio slider
@@ -93,11 +465,41 @@ void feature_matcher_block::draw_ui() {
     ImGui::SetNextItemWidth(100);
     ImGui::SliderFloat("##lowe", &lowe_ratio, 0.1f, 1.0f);
 
+    ImGui::Checkbox("Guided", &guided);
+    if (guided) {
+        ImGui::Text("Window (px):");
+        ImGui::SetNextItemWidth(100);
+        ImGui::SliderFloat("##window", &window_radius, 5.0f, 200.0f, "%.0f");
+        ImGui::Text("Min matches:");
+        ImGui::SetNextItemWidth(100);
+        ImGui::SliderInt("##min_guided", &min_guided_matches, 0, 500);
+        ImGui::Checkbox("Epipolar gate", &epipolar_gate);
+        if (epipolar_gate) {
+            ImGui::SetNextItemWidth(100);
+            ImGui::SliderFloat("##epi", &epipolar_threshold, 0.5f, 20.0f, "%.1f px");
+        }
+        ImGui::Text("Guided: %d  Fallback: %d", guided_frames, guided_fallbacks);
+        ImGui::Text("Candidates/query: %.1f", avg_candidates);
+    }
+
+    if (matcher_type_index == 3) {
+        ImGui::Text("Probe radius:");
+        ImGui::SetNextItemWidth(100);
+        ImGui::SliderInt("##mih_radius", &mih_max_radius, 0, 4);
+        ImGui::Text("Candidates/query: %.0f", mih.last_candidates_per_query());
+    }
+
+    if (matcher_type_index == 2 || matcher_type_index == 3) {
+        ImGui::Checkbox("1:N reuse", &one_to_many_reuse);
+        ImGui::Text("Index builds: %d", index_builds);
+        ImGui::Text("Index reuses: %d", index_reuses);
+    }
+
     ImNodes::EndNode();
 }
 
 std::vector<std::shared_ptr<base_port>> feature_matcher_block::get_input_ports() {
-    return {desc1_in, desc2_in};
+    return {desc1_in, desc2_in, kpts1_in, kpts2_in, H_in, R_in, t_in, K_in};
 }
 
 std::vector<std::shared_ptr<base_port>> feature_matcher_block::get_output_ports() {
@@ -108,6 +510,13 @@ nlohmann::json feature_matcher_block::serialize() const {
     nlohmann::json j;
     j["matcher_type_index"] = matcher_type_index;
     j["lowe_ratio"] = lowe_ratio;
+    j["mih_max_radius"] = mih_max_radius;
+    j["guided"] = guided;
+    j["window_radius"] = window_radius;
+    j["epipolar_gate"] = epipolar_gate;
+    j["epipolar_threshold"] = epipolar_threshold;
+    j["min_guided_matches"] = min_guided_matches;
+    j["one_to_many_reuse"] = one_to_many_reuse;
     return j;
 }
 
@@ -118,4 +527,25 @@ void feature_matcher_block::deserialize(const nlohmann::json& j) {
     if (j.contains("lowe_ratio")) {
         lowe_ratio = j["lowe_ratio"];
     }
+    if (j.contains("mih_max_radius")) {
+        mih_max_radius = j["mih_max_radius"];
+    }
+    if (j.contains("guided")) {
+        guided = j["guided"];
+    }
+    if (j.contains("window_radius")) {
+        window_radius = j["window_radius"];
+    }
+    if (j.contains("epipolar_gate")) {
+        epipolar_gate = j["epipolar_gate"];
+    }
+    if (j.contains("epipolar_threshold")) {
+        epipolar_threshold = j["epipolar_threshold"];
+    }
+    if (j.contains("min_guided_matches")) {
+        min_guided_matches = j["min_guided_matches"];
+    }
+    if (j.contains("one_to_many_reuse")) {
+        one_to_many_reuse = j["one_to_many_reuse"];
+    }
 }
@@ -0,0 +1,211 @@
+#include "blocks/feature_tracker_block.hpp"
+
+#include <imnodes.h>
+#include <imgui.h>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/video/tracking.hpp>
+#include <algorithm>
+#include <iostream>
+
+feature_tracker_block::feature_tracker_block(int id)
+    : block(id, "Feature Tracker") {
+    input_image = std::make_shared<data_port<cv::Mat>>("image");
+    kpts1_out = std::make_shared<data_port<std::vector<cv::KeyPoint>>>("keypoints1");
+    kpts2_out = std::make_shared<data_port<std::vector<cv::KeyPoint>>>("keypoints2");
+    matches_out = std::make_shared<data_port<std::vector<cv::DMatch>>>("matches");
+}
+
+void feature_tracker_block::reset() {
+    prev_pyramid.clear();
+    prev_points.clear();
+    last_tracked = 0;
+}
+
+void feature_tracker_block::build_pyramid(const cv::Mat& gray, std::vector<cv::Mat>& pyramid) const {
+    // With derivatives, so both tracking directions reuse the same levels
+    cv::buildOpticalFlowPyramid(gray, pyramid, cv::Size(win_size, win_size), max_level, true);
+}
+
+void feature_tracker_block::top_up(const cv::Mat& gray, std::vector<cv::Point2f>& points) const {
+    const int wanted = max_features - static_cast<int>(points.size());
+    if (wanted <= 0) return;
+
+    // Keep new corners away from the ones still being tracked
+    cv::Mat mask(gray.size(), CV_8UC1, cv::Scalar(255));
+    for (const auto& p : points) {
+        cv::circle(mask, p, min_distance, cv::Scalar(0), -1);
+    }
+
+    std::vector<cv::Point2f> corners;
+    cv::goodFeaturesToTrack(gray, corners, wanted, quality_level, min_distance, mask);
+    points.insert(points.end(), corners.begin(), corners.end());
+}
+
+void feature_tracker_block::process(const std::vector<link_t>&) {
+    if (!input_image->data || input_image->data->empty()) return;
+
+    int input_frame_id = input_image->frame_id;
+    if (input_frame_id == last_processed_frame_id) {
+        // Already processed this frame, skip redundant work
+        return;
+    }
+    if (input_frame_id < last_processed_frame_id) {
+        // Source was rewound; the previous frame is no longer its predecessor
+        reset();
+    }
+    last_processed_frame_id = input_frame_id;
+
+    cv::Mat gray;
+    if (input_image->data->channels() == 3) {
+        cv::cvtColor(*input_image->data, gray, cv::COLOR_BGR2GRAY);
+    } else {
+        gray = *input_image->data;
+    }
+
+    std::vector<cv::Mat> curr_pyramid;
+    build_pyramid(gray, curr_pyramid);
+
+    const bool has_previous = !prev_pyramid.empty();
+    std::vector<cv::Point2f> curr_points;
+    std::vector<cv::KeyPoint> kpts1, kpts2;
+    std::vector<cv::DMatch> matches;
+
+    if (has_previous && !prev_points.empty()) {
+        const cv::Size win(win_size, win_size);
+        const cv::TermCriteria criteria(cv::TermCriteria::COUNT | cv::TermCriteria::EPS, 30, 0.01);
+
+        std::vector<cv::Point2f> tracked;
+        std::vector<uchar> status;
+        std::vector<float> err;
+        cv::calcOpticalFlowPyrLK(prev_pyramid, curr_pyramid, prev_points, tracked,
+                                 status, err, win, max_level, criteria);
+
+        if (fb_check) {
+            std::vector<cv::Point2f> back;
+            std::vector<uchar> back_status;
+            std::vector<float> back_err;
+            cv::calcOpticalFlowPyrLK(curr_pyramid, prev_pyramid, tracked, back,
+                                     back_status, back_err, win, max_level, criteria);
+            for (size_t i = 0; i < status.size(); ++i) {
+                const cv::Point2f d = back[i] - prev_points[i];
+                status[i] = status[i] && back_status[i] && d.dot(d) <= fb_threshold * fb_threshold;
+            }
+        }
+
+        const cv::Rect2f bounds(0.0f, 0.0f, static_cast<float>(gray.cols), static_cast<float>(gray.rows));
+        kpts1.reserve(prev_points.size());
+        kpts2.reserve(prev_points.size());
+        matches.reserve(prev_points.size());
+        curr_points.reserve(prev_points.size());
+
+        for (size_t i = 0; i < status.size(); ++i) {
+            if (!status[i] || !bounds.contains(tracked[i])) continue;
+            const int idx = static_cast<int>(matches.size());
+            kpts1.emplace_back(prev_points[i], static_cast<float>(win_size));
+            kpts2.emplace_back(tracked[i], static_cast<float>(win_size));
+            matches.emplace_back(idx, idx, err[i]);
+            curr_points.push_back(tracked[i]);
+        }
+    }
+    last_tracked = static_cast<int>(matches.size());
+
+    if (static_cast<int>(curr_points.size()) < min_tracked) {
+        top_up(gray, curr_points);
+        ++redetections;
+    }
+
+    prev_pyramid.swap(curr_pyramid);
+    prev_points.swap(curr_points);
+
+    if (!has_previous) return;  // Nothing to pair the first frame with
+
+    kpts1_out->set(kpts1, input_frame_id);
+    kpts2_out->set(kpts2, input_frame_id);
+    matches_out->set(matches, input_frame_id);
+
+    std::cout << "[FeatureTracker] Node " << id
+              << " tracked " << last_tracked
+              << " points with frame_id " << input_frame_id << ".\n";
+}
+
+void feature_tracker_block::draw_ui() {
+    ImNodes::BeginNode(id);
+
+    ImNodes::BeginNodeTitleBar();
+    ImGui::TextUnformatted("Feature Tracker");
+    ImNodes::EndNodeTitleBar();
+
+    ImNodes::BeginInputAttribute(id * 100 + 0);
+    ImGui::Text("Img");
+    ImGui::Dummy(ImVec2(1, 1));
+    ImNodes::EndInputAttribute();
+
+    ImNodes::BeginOutputAttribute(id * 10 + 0);
+    ImGui::Text("Kpts1");
+    ImNodes::EndOutputAttribute();
+
+    ImNodes::BeginOutputAttribute(id * 10 + 1);
+    ImGui::Text("Kpts2");
+    ImNodes::EndOutputAttribute();
+
+    ImNodes::BeginOutputAttribute(id * 10 + 2);
+    ImGui::Text("Matches");
+    ImNodes::EndOutputAttribute();
+
+    ImGui::SetNextItemWidth(100);
+    ImGui::SliderInt("Max feats", &max_features, 100, 4000);
+    ImGui::SetNextItemWidth(100);
+    ImGui::SliderInt("Min tracked", &min_tracked, 10, max_features);
+
+    // Pyramid geometry changes invalidate the cached previous frame
+    ImGui::SetNextItemWidth(100);
+    if (ImGui::SliderInt("Window", &win_size, 7, 41)) reset();
+    ImGui::SetNextItemWidth(100);
+    if (ImGui::SliderInt("Levels", &max_level, 0, 6)) reset();
+
+    ImGui::SetNextItemWidth(100);
+    ImGui::SliderInt("Min dist", &min_distance, 1, 50);
+    ImGui::Checkbox("FB check", &fb_check);
+    if (fb_check) {
+        ImGui::SetNextItemWidth(100);
+        ImGui::SliderFloat("FB thresh", &fb_threshold, 0.1f, 5.0f);
+    }
+
+    ImGui::Text("Tracked: %d", last_tracked);
+    ImGui::Text("Re-detections: %d", redetections);
+
+    ImNodes::EndNode();
+}
+
+std::vector<std::shared_ptr<base_port>> feature_tracker_block::get_input_ports() {
+    return {input_image};
+}
+
+std::vector<std::shared_ptr<base_port>> feature_tracker_block::get_output_ports() {
+    return {kpts1_out, kpts2_out, matches_out};
+}
+
+nlohmann::json feature_tracker_block::serialize() const {
+    nlohmann::json j;
+    j["max_features"] = max_features;
+    j["min_tracked"] = min_tracked;
+    j["win_size"] = win_size;
+    j["max_level"] = max_level;
+    j["min_distance"] = min_distance;
+    j["quality_level"] = quality_level;
+    j["fb_check"] = fb_check;
+    j["fb_threshold"] = fb_threshold;
+    return j;
+}
+
+void feature_tracker_block::deserialize(const nlohmann::json& j) {
+    if (j.contains("max_features")) max_features = std::max(1, j["max_features"].get<int>());
+    if (j.contains("min_tracked")) min_tracked = std::max(0, j["min_tracked"].get<int>());
+    if (j.contains("win_size")) win_size = std::clamp(j["win_size"].get<int>(), 7, 41);
+    if (j.contains("max_level")) max_level = std::clamp(j["max_level"].get<int>(), 0, 6);
+    if (j.contains("min_distance")) min_distance = std::max(1, j["min_distance"].get<int>());
+    if (j.contains("quality_level")) quality_level = j["quality_level"];
+    if (j.contains("fb_check")) fb_check = j["fb_check"];
+    if (j.contains("fb_threshold")) fb_threshold = j["fb_threshold"];
+    reset();
+}
@@ -10,21 +10,35 @@ filter_block::filter_block(int id)
     kpts1_in = std::make_shared<data_port<std::vector<cv::KeyPoint>>>("Keypoints 1");
     kpts2_in = std::make_shared<data_port<std::vector<cv::KeyPoint>>>("Keypoints 2");
     matches_in = std::make_shared<data_port<std::vector<cv::DMatch>>>("Matches");
+    selection_in = std::make_shared<data_port<match_selection>>("Selection");
 
     filtered_kpts1_out = std::make_shared<data_port<std::vector<cv::KeyPoint>>>("Filtered Keypoints 1");
     filtered_kpts2_out = std::make_shared<data_port<std::vector<cv::KeyPoint>>>("Filtered Keypoints 2");
     filtered_matches_out = std::make_shared<data_port<std::vector<cv::DMatch>>>("Filtered Matches");
+    selection_out = std::make_shared<data_port<match_selection>>("Selection");
 }
 
-void filter_block::process(const std::vector<link_t>&) {
-    if (!mask_in || !kpts1_in || !kpts2_in || !matches_in) return;
+bool filter_block::is_port_connected(int port_index, const std::vector<link_t>& links) {
+    for (const auto& link : links) {
+        if (link.start_attr / 10 == this->id && link.start_attr % 10 == port_index) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool filter_block::use_selection() const {
+    // A selection wins whenever it is present and at least as fresh
+    return selection_in->data->valid() && selection_in->frame_id >= matches_in->frame_id;
+}
+
+void filter_block::process(const std::vector<link_t>& links) {
+    if (!mask_in || !kpts1_in || !kpts2_in || !matches_in || !selection_in) return;
 
     const cv::Mat* mask = mask_in->get();
-    const auto* kpts1 = kpts1_in->get();
-    const auto* kpts2 = kpts2_in->get();
-    const auto* matches = matches_in->get();
+    const bool chained = use_selection();
 
-    if (!mask || mask->empty() || !kpts1 || !kpts2 || !matches) {
+    if (!mask || mask->empty() || (!chained && matches_in->data->empty())) {
         // Don't print error for empty data, just return silently
         return;
     }
@@ -33,7 +47,7 @@ void filter_block::process(const std::vector<link_t>&) {
     // Keypoints 1 and 2 can be from different frames (that's normal for matching)
     // But matches and mask should be from the same computation
     int mask_frame_id = mask_in->frame_id;
-    int matches_frame_id = matches_in->frame_id;
+    int matches_frame_id = chained ? selection_in->frame_id : matches_in->frame_id;
 
     if (mask_frame_id != matches_frame_id) {
         std::cout << "[Filter Block] Frame synchronization issue - mask and matches from different frames" 
@@ -47,43 +61,45 @@ void filter_block::process(const std::vector<link_t>&) {
     }
     last_processed_frame_id = mask_frame_id;
 
-    std::vector<cv::KeyPoint> filtered_kpts1;
-    std::vector<cv::KeyPoint> filtered_kpts2;
-    std::vector<cv::DMatch> filtered_matches;
+    // The input as a selection: either the upstream one, which is already
+    // validated, or all of the input matches, checked here once. The input
+    // buffers become the selection's parents; block_graph gives the ports
+    // new ones rather than overwrite them.
+    match_selection all;
+    if (!chained && !match_selection::select_all(kpts1_in->data, kpts2_in->data, matches_in->data, all)) {
+        std::cerr << "[Filter Block] Invalid match indices at frame " << mask_frame_id
+                  << " (keypoints: " << kpts1_in->data->size() << ", " << kpts2_in->data->size() << ")" << std::endl;
+        return;
+    }
+    const match_selection& input = chained ? *selection_in->data : all;
 
     // If matches come from Homography block (filtered matches), they should match the mask size
-    if (mask->rows == static_cast<int>(matches->size()) && mask->cols == 1) {
-        std::cout << "[Filter Block] Processing " << matches->size() << " filtered matches with binary mask at frame " << mask_frame_id << std::endl;
-        
-        for (size_t i = 0; i < matches->size(); ++i) {
-            const cv::DMatch& match = (*matches)[i];
-            if (match.queryIdx >= static_cast<int>(kpts1->size()) || 
-                match.trainIdx >= static_cast<int>(kpts2->size())) {
-                std::cerr << "[Filter Block] Invalid match indices at position " << i 
-                          << ": queryIdx=" << match.queryIdx << " (max=" << kpts1->size() 
-                          << "), trainIdx=" << match.trainIdx << " (max=" << kpts2->size() << ")" << std::endl;
-                return;
-            }
-
-            if (mask->at<uchar>(static_cast<int>(i), 0) != 0) {
-                filtered_matches.push_back(match);
-                filtered_kpts1.push_back((*kpts1)[match.queryIdx]);
-                filtered_kpts2.push_back((*kpts2)[match.trainIdx]);
-            }
-        }
-    } else {
+    if (mask->rows != static_cast<int>(input.size()) || mask->cols != 1 || mask->type() != CV_8U) {
         std::cerr << "[Filter Block] Mask size mismatch at frame " << mask_frame_id 
-                  << ". Expected: " << matches->size() 
+                  << ". Expected: " << input.size() 
                   << "x1, Got: " << mask->rows << "x" << mask->cols 
                   << " (This suggests mask and matches come from different sources)" << std::endl;
         return;
     }
-    
-    filtered_kpts1_out->set(filtered_kpts1, mask_frame_id);
-    filtered_kpts2_out->set(filtered_kpts2, mask_frame_id);
-    filtered_matches_out->set(filtered_matches, mask_frame_id);
 
-    std::cout << "[Filter Block] Filtered " << filtered_matches.size() << " matches at frame " << mask_frame_id << "\n";
+    *selection_out->data = input.subset(*mask);
+    selection_out->frame_id = mask_frame_id;
+    const match_selection& filtered = *selection_out->data;
+
+    const bool want_kpts1 = is_port_connected(0, links);
+    const bool want_kpts2 = is_port_connected(1, links);
+    const bool want_matches = is_port_connected(2, links);
+    if (want_kpts1 || want_kpts2 || want_matches) {
+        filtered.materialize(want_kpts1 ? filtered_kpts1_out->get() : nullptr,
+                             want_kpts2 ? filtered_kpts2_out->get() : nullptr,
+                             want_matches ? filtered_matches_out->get() : nullptr);
+        filtered_kpts1_out->frame_id = mask_frame_id;
+        filtered_kpts2_out->frame_id = mask_frame_id;
+        filtered_matches_out->frame_id = mask_frame_id;
+    }
+
+    std::cout << "[Filter Block] Filtered " << filtered.size() << " of " << input.size()
+              << " matches at frame " << mask_frame_id << "\n";
 }
 
 void filter_block::draw_ui() {
@@ -108,6 +124,10 @@ void filter_block::draw_ui() {
     ImGui::Text("Matches");
     ImNodes::EndInputAttribute();
 
+    ImNodes::BeginInputAttribute(id * 100 + 4);
+    ImGui::Text("Selection");
+    ImNodes::EndInputAttribute();
+
     ImNodes::BeginOutputAttribute(id * 10 + 0);
     ImGui::Text("Filtered Kpts 1");
     ImNodes::EndOutputAttribute();
@@ -120,15 +140,19 @@ void filter_block::draw_ui() {
     ImGui::Text("Filtered Matches");
     ImNodes::EndOutputAttribute();
 
+    ImNodes::BeginOutputAttribute(id * 10 + 3);
+    ImGui::Text("Selection");
+    ImNodes::EndOutputAttribute();
+
     ImNodes::EndNode();
 }
 
 std::vector<std::shared_ptr<base_port>> filter_block::get_input_ports() {
-    return {mask_in, kpts1_in, kpts2_in, matches_in};
+    return {mask_in, kpts1_in, kpts2_in, matches_in, selection_in};
 }
 
 std::vector<std::shared_ptr<base_port>> filter_block::get_output_ports() {
-    return {filtered_kpts1_out, filtered_kpts2_out, filtered_matches_out};
+    return {filtered_kpts1_out, filtered_kpts2_out, filtered_matches_out, selection_out};
 }
 
 nlohmann::json filter_block::serialize() const {
@@ -3,6 +3,8 @@
 #include <imnodes.h>
 #include <imgui.h>
 #include <opencv2/calib3d.hpp>
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 
 homography_block::homography_block(int id)
@@ -10,66 +12,121 @@ homography_block::homography_block(int id)
     kpts1_in = std::make_shared<data_port<std::vector<cv::KeyPoint>>>("Keypoints 1");
     kpts2_in = std::make_shared<data_port<std::vector<cv::KeyPoint>>>("Keypoints 2");
     matches_in = std::make_shared<data_port<std::vector<cv::DMatch>>>("Matches");
+    features1_in = std::make_shared<data_port<feature_set>>("Features 1");
+    features2_in = std::make_shared<data_port<feature_set>>("Features 2");
+    selection_in = std::make_shared<data_port<match_selection>>("Selection");
 
     homography_out = std::make_shared<data_port<cv::Mat>>("Homography");
     mask_out = std::make_shared<data_port<cv::Mat>>("Mask");
     filtered_matches_out = std::make_shared<data_port<std::vector<cv::DMatch>>>("Filtered Matches");
+    inliers_out = std::make_shared<data_port<match_selection>>("Inliers");
 }
 
-void homography_block::process(const std::vector<link_t>&) {
+bool homography_block::use_features() const {
+    // Feature sets win whenever both are present and each is at least as
+    // fresh as the keypoints on its side
+    return !features1_in->data->empty() && !features2_in->data->empty() &&
+           features1_in->frame_id >= kpts1_in->frame_id && features2_in->frame_id >= kpts2_in->frame_id;
+}
+
+bool homography_block::use_selection() const {
+    return selection_in->data->valid() && selection_in->frame_id >= matches_in->frame_id;
+}
+
+bool homography_block::is_port_connected(int port_index, const std::vector<link_t>& links) {
+    for (const auto& link : links) {
+        if (link.start_attr / 10 == this->id && link.start_attr % 10 == port_index) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void homography_block::process(const std::vector<link_t>& links) {
     const auto* kpts1 = kpts1_in->get();
     const auto* kpts2 = kpts2_in->get();
     const auto* matches = matches_in->get();
+    const bool chained = use_selection();
+    const bool columnar = !chained && use_features();
 
-    if (!kpts1 || !kpts2 || !matches) {
+    if (!chained && (!matches || (!columnar && (!kpts1 || !kpts2)))) {
         std::cerr << "[Homography] Input ports not connected or empty.\n";
         return;
     }
 
-    int input_frame_id = kpts1_in->frame_id;
+    // Both sets must be from the same frame pair; wait for the other side
+    if (columnar && features2_in->frame_id != features1_in->frame_id) return;
+
+    int input_frame_id = chained ? selection_in->frame_id
+                       : columnar ? features1_in->frame_id : kpts1_in->frame_id;
     if (input_frame_id == last_processed_frame_id) {
         return; // Already processed this frame
     }
     last_processed_frame_id = input_frame_id;
 
-    if (kpts1->empty() || kpts2->empty() || matches->empty()) {
-        std::cerr << "[Homography] One or more inputs are empty.\n";
+    // The input as a selection; a new one covers all of the input matches
+    // and is bounds-checked here, once
+    match_selection all;
+    if (!chained) {
+        if (matches->empty() || (!columnar && (kpts1->empty() || kpts2->empty()))) {
+            std::cerr << "[Homography] One or more inputs are empty.\n";
+            return;
+        }
+        const bool ok = columnar
+            ? match_selection::select_all(features1_in->data, features2_in->data, matches_in->data, all)
+            : match_selection::select_all(kpts1_in->data, kpts2_in->data, matches_in->data, all);
+        if (!ok) {
+            std::cerr << "[Homography] Matches do not index the connected "
+                      << (columnar ? "feature sets" : "keypoints") << ".\n";
+            return;
+        }
+    }
+    const match_selection& input = chained ? *selection_in->data : all;
+    if (input.size() < 4) {
+        std::cerr << "[Homography] Not enough matches (" << input.size() << ").\n";
         return;
     }
 
-    // Extract matching point coordinates
+    robust_config cfg;
+    cfg.method = static_cast<robust_method>(method_index);
+    cfg.threshold = ransac_reproj_thresh;
+    cfg.confidence = confidence;
+    cfg.max_iterations = max_iterations;
+
+    // Extract matching point coordinates. Match distances order the USAC
+    // samples, so a chained selection copies out its matches for that only.
     std::vector<cv::Point2f> pts1, pts2;
-    for (const auto& m : *matches) {
-        pts1.push_back((*kpts1)[m.queryIdx].pt);
-        pts2.push_back((*kpts2)[m.trainIdx].pt);
-    }
+    std::vector<cv::DMatch> selected_matches;
+    const bool ordered = cfg.method != robust_method::RANSAC;
+    input.gather_points(pts1, pts2, chained && ordered ? &selected_matches : nullptr);
+    const std::vector<cv::DMatch>* order = chained ? &selected_matches : input.matches.get();
 
-    // Compute homography with RANSAC to get mask
+    // Robust fit; the mask comes back in selection order
+    auto start = std::chrono::steady_clock::now();
     cv::Mat mask;
-    cv::Mat H = cv::findHomography(pts1, pts2, cv::RANSAC, ransac_reproj_thresh, mask, 2000, confidence);
+    cv::Mat H = estimate_homography(pts1, pts2, ordered ? order : nullptr, cfg, mask);
+    last_estimate_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
 
     if (H.empty()) {
         std::cerr << "[Homography] Homography estimation failed.\n";
         return;
     }
 
-    // Filter matches based on the mask
-    std::vector<cv::DMatch> filtered_matches;
-    for (int i = 0; i < mask.rows; ++i) {
-        if (mask.at<uchar>(i, 0) != 0) {
-            filtered_matches.push_back((*matches)[i]);
-        }
-    }
+    *inliers_out->data = input.subset(mask);
+    inliers_out->frame_id = input_frame_id;
+    const match_selection& inliers = *inliers_out->data;
 
     homography_out->set(H, input_frame_id);
     mask_out->set(mask, input_frame_id);
-    filtered_matches_out->set(filtered_matches, input_frame_id);
+    if (is_port_connected(2, links)) {
+        inliers.materialize(nullptr, nullptr, filtered_matches_out->get());
+        filtered_matches_out->frame_id = input_frame_id;
+    }
 
     std::cout << "[Homography] Computed homography for frame " << input_frame_id
-              << " with " << cv::countNonZero(mask) << " inliers."
+              << " with " << inliers.size() << " inliers."
               << " Mask size: " << mask.rows << "x" << mask.cols 
-              << " (matches: " << matches->size() << ")"
-              << " Filtered matches: " << filtered_matches.size() << std::endl;
+              << " (matches: " << input.size() << ")" << std::endl;
 }
 
 void homography_block::draw_ui() {
@@ -91,6 +148,18 @@ void homography_block::draw_ui() {
     ImGui::Text("Matches");
     ImNodes::EndInputAttribute();
 
+    ImNodes::BeginInputAttribute(id * 100 + 3);
+    ImGui::Text("Features 1");
+    ImNodes::EndInputAttribute();
+
+    ImNodes::BeginInputAttribute(id * 100 + 4);
+    ImGui::Text("Features 2");
+    ImNodes::EndInputAttribute();
+
+    ImNodes::BeginInputAttribute(id * 100 + 5);
+    ImGui::Text("Selection");
+    ImNodes::EndInputAttribute();
+
     ImNodes::BeginOutputAttribute(id * 10 + 0);
     ImGui::Text("Homography");
     ImNodes::EndOutputAttribute();
@@ -103,6 +172,15 @@ void homography_block::draw_ui() {
     ImGui::Text("Filtered Matches");
     ImNodes::EndOutputAttribute();
 
+    ImNodes::BeginOutputAttribute(id * 10 + 3);
+    ImGui::Text("Inliers");
+    ImNodes::EndOutputAttribute();
+
+    ImGui::Text("Method:");
+    ImGui::SetNextItemWidth(120);
+    static const char* method_names[] = { "RANSAC", "USAC PROSAC", "USAC MAGSAC++" };
+    ImGui::Combo("##method", &method_index, method_names, IM_ARRAYSIZE(method_names));
+
     ImGui::Text("RANSAC Reproj Threshold:");
     ImGui::SetNextItemWidth(80);
     ImGui::SliderFloat("##ransac_thresh", &ransac_reproj_thresh, 1.0f, 10.0f);
@@ -111,21 +189,29 @@ void homography_block::draw_ui() {
     ImGui::SetNextItemWidth(80);
     ImGui::SliderFloat("##confidence", &confidence, 0.8f, 1.0f);
 
+    ImGui::Text("Max iterations:");
+    ImGui::SetNextItemWidth(80);
+    ImGui::SliderInt("##max_iterations", &max_iterations, 50, 10000);
+
+    ImGui::Text("Estimate: %.2f ms", last_estimate_ms);
+
     ImNodes::EndNode();
 }
 
 std::vector<std::shared_ptr<base_port>> homography_block::get_input_ports() {
-    return {kpts1_in, kpts2_in, matches_in};
+    return {kpts1_in, kpts2_in, matches_in, features1_in, features2_in, selection_in};
 }
 
 std::vector<std::shared_ptr<base_port>> homography_block::get_output_ports() {
-    return {homography_out, mask_out, filtered_matches_out};
+    return {homography_out, mask_out, filtered_matches_out, inliers_out};
 }
 
 nlohmann::json homography_block::serialize() const {
     nlohmann::json j;
     j["ransac_reproj_thresh"] = ransac_reproj_thresh;
     j["confidence"] = confidence;
+    j["method_index"] = method_index;
+    j["max_iterations"] = max_iterations;
     return j;
 }
 
@@ -136,4 +222,10 @@ void homography_block::deserialize(const nlohmann::json& j) {
     if (j.contains("confidence")) {
         confidence = j["confidence"];
     }
+    if (j.contains("method_index")) {
+        method_index = std::clamp(j["method_index"].get<int>(), 0, 2);
+    }
+    if (j.contains("max_iterations")) {
+        max_iterations = std::max(1, j["max_iterations"].get<int>());
+    }
 }
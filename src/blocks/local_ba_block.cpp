@@ -0,0 +1,324 @@
+#include "blocks/local_ba_block.hpp"
+
+#include <imnodes.h>
+#include <imgui.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+// Camera-to-world pose of a world-to-camera one
+se3 pose_matrix(const cv::Matx33d& R, const cv::Vec3d& t) {
+    return se3::from_matx(R, t).inverse();
+}
+
+cv::Vec3d camera_centre(const cv::Matx33d& R, const cv::Vec3d& t) {
+    return R.t() * t * -1.0;
+}
+
+// Midpoint of the closest approach of the two viewing rays. Fails for
+// near-parallel rays and for points behind either camera.
+bool triangulate(const cv::Matx33d& K_inv, const cv::Matx33d& R1, const cv::Vec3d& t1, const cv::Point2f& p1,
+                 const cv::Matx33d& R2, const cv::Vec3d& t2, const cv::Point2f& p2, double max_cos, cv::Vec3d& X) {
+    cv::Vec3d d1 = R1.t() * (K_inv * cv::Vec3d(p1.x, p1.y, 1.0));
+    cv::Vec3d d2 = R2.t() * (K_inv * cv::Vec3d(p2.x, p2.y, 1.0));
+    d1 = d1 * (1.0 / std::sqrt(d1.dot(d1)));
+    d2 = d2 * (1.0 / std::sqrt(d2.dot(d2)));
+    const double b = d1.dot(d2);
+    if (b > max_cos) return false;
+
+    const cv::Vec3d c1 = camera_centre(R1, t1), c2 = camera_centre(R2, t2);
+    const cv::Vec3d w = c1 - c2;
+    const double d = d1.dot(w), e = d2.dot(w);
+    const double denom = 1.0 - b * b;
+    const double s = (b * e - d) / denom;
+    const double u = (e - b * d) / denom;
+    X = ((c1 + d1 * s) + (c2 + d2 * u)) * 0.5;
+    return (R1 * X + t1)[2] > 0.0 && (R2 * X + t2)[2] > 0.0;
+}
+
+}  // namespace
+
+local_ba_block::local_ba_block(int id)
+    : block(id, "Local BA") {
+    kpts1_in = std::make_shared<data_port<std::vector<cv::KeyPoint>>>("Keypoints 1");
+    kpts2_in = std::make_shared<data_port<std::vector<cv::KeyPoint>>>("Keypoints 2");
+    matches_in = std::make_shared<data_port<std::vector<cv::DMatch>>>("Matches");
+    K_in = std::make_shared<data_port<cv::Mat>>("Intrinsics");
+    R_in = std::make_shared<data_port<cv::Mat>>("R");
+    t_in = std::make_shared<data_port<cv::Mat>>("t");
+    depth_in = std::make_shared<data_port<cv::Mat>>("Depth");
+
+    R_out = std::make_shared<data_port<cv::Mat>>("R_global");
+    t_out = std::make_shared<data_port<cv::Mat>>("t_global");
+    poses_out = std::make_shared<data_port<trajectory>>("Poses");
+    points_out = std::make_shared<data_port<std::vector<cv::Point3f>>>("3D Points");
+}
+
+void local_ba_block::reset() {
+    ba.clear();
+    prev_landmarks.clear();
+    prev_frame = -1;
+    // Readers see a new sequence and start over
+    poses.reset();
+}
+
+local_ba_block::frame_inputs& local_ba_block::inputs_for(int frame_id) {
+    for (auto& f : pending) {
+        if (f.frame_id == frame_id) return f;
+    }
+    pending.emplace_back();
+    pending.back().frame_id = frame_id;
+    if (pending.size() > kMaxPendingFrames) pending.pop_front();
+    return pending.back();
+}
+
+void local_ba_block::buffer_inputs() {
+    // Frame ids going backwards on any input means the source restarted
+    auto restarted = [](int frame_id, int last) { return frame_id >= 0 && frame_id < last; };
+    if (restarted(kpts1_in->frame_id, last_kpts1_frame_id) || restarted(kpts2_in->frame_id, last_kpts2_frame_id) ||
+        restarted(matches_in->frame_id, last_matches_frame_id) || restarted(depth_in->frame_id, last_depth_frame_id)) {
+        pending.clear();
+        last_kpts1_frame_id = last_kpts2_frame_id = last_matches_frame_id = last_depth_frame_id = -1;
+    }
+
+    if (kpts1_in->frame_id >= 0 && kpts1_in->frame_id != last_kpts1_frame_id) {
+        last_kpts1_frame_id = kpts1_in->frame_id;
+        inputs_for(last_kpts1_frame_id).kpts1 = kpts1_in->data;
+    }
+    if (kpts2_in->frame_id >= 0 && kpts2_in->frame_id != last_kpts2_frame_id) {
+        last_kpts2_frame_id = kpts2_in->frame_id;
+        inputs_for(last_kpts2_frame_id).kpts2 = kpts2_in->data;
+    }
+    if (matches_in->frame_id >= 0 && matches_in->frame_id != last_matches_frame_id) {
+        last_matches_frame_id = matches_in->frame_id;
+        inputs_for(last_matches_frame_id).matches = matches_in->data;
+    }
+    if (depth_in->frame_id >= 0 && depth_in->frame_id != last_depth_frame_id) {
+        last_depth_frame_id = depth_in->frame_id;
+        // Mat links overwrite the port's header, so keep a header of our own
+        inputs_for(last_depth_frame_id).depth = *depth_in->data;
+    }
+}
+
+void local_ba_block::process(const std::vector<link_t>&) {
+    buffer_inputs();
+
+    const cv::Mat* K = K_in->get();
+    const cv::Mat* R = R_in->get();
+    const cv::Mat* t = t_in->get();
+    if (!K || !R || !t || K->empty() || R->empty() || t->empty()) return;
+
+    int input_frame_id = R_in->frame_id;
+    if (input_frame_id == last_processed_frame_id || t_in->frame_id != input_frame_id) return;
+
+    // Everything below must describe the same frame pair as R and t
+    auto it = std::find_if(pending.begin(), pending.end(),
+                           [input_frame_id](const frame_inputs& f) { return f.frame_id == input_frame_id; });
+    if (it == pending.end() || !it->kpts1 || !it->kpts2 || !it->matches) return;  // Not all here yet
+    const frame_inputs inputs = *it;
+    pending.erase(pending.begin(), it + 1);
+    const auto* kpts1 = inputs.kpts1.get();
+    const auto* kpts2 = inputs.kpts2.get();
+    const auto* matches = inputs.matches.get();
+
+    // Frame ids going backwards means the source restarted
+    if (input_frame_id < last_processed_frame_id) reset();
+    last_processed_frame_id = input_frame_id;
+
+    cv::Matx33d K_d, R_rel;
+    cv::Vec3d t_rel;
+    K->convertTo(K_d, CV_64F);
+    R->convertTo(R_rel, CV_64F);
+    t->convertTo(t_rel, CV_64F);
+
+    ba.opts.window_size = window_size;
+    ba.opts.max_iterations = max_iterations;
+    ba.opts.time_budget_ms = time_budget_ms;
+    ba.opts.huber_px = huber_px;
+
+    // The previous frame's keypoints must be the ones the landmarks were
+    // recorded against, otherwise the chain is broken and starts over
+    if (prev_frame >= 0 && (kpts1->size() != prev_landmarks.size() || !ba.has_frame(prev_frame))) {
+        std::cerr << "[LocalBA] Lost the keypoint chain, restarting the window\n";
+        reset();
+    }
+    if (prev_frame < 0) {
+        prev_frame = ba.add_frame(cv::Matx33d::eye(), cv::Vec3d(0, 0, 0));
+        // The camera sends each pair as (frame - 1, frame)
+        poses.push_back(pose_matrix(cv::Matx33d::eye(), cv::Vec3d(0, 0, 0)), input_frame_id - 1);
+        prev_landmarks.assign(kpts1->size(), -1);
+    }
+
+    // Predict the new pose; the relative translation has unit length, so it
+    // takes the length of the previous step
+    const cv::Matx33d R_prev = ba.rotation(prev_frame);
+    const cv::Vec3d t_prev = ba.translation(prev_frame);
+    double step = 1.0;
+    if (ba.has_frame(prev_frame - 1)) {
+        const cv::Vec3d delta = camera_centre(R_prev, t_prev) -
+                                camera_centre(ba.rotation(prev_frame - 1), ba.translation(prev_frame - 1));
+        if (delta.dot(delta) > 0.0) step = std::sqrt(delta.dot(delta));
+    }
+    const double t_norm = std::sqrt(t_rel.dot(t_rel));
+    if (t_norm > 0.0) t_rel = t_rel * (step / t_norm);
+    const int cur = ba.add_frame(R_rel * R_prev, R_rel * t_prev + t_rel);
+
+    const cv::Matx33d R_cur = ba.rotation(cur);
+    const cv::Vec3d t_cur = ba.translation(cur);
+    const cv::Matx33d K_inv = K_d.inv();
+    const double max_cos = std::cos(min_parallax_deg * CV_PI / 180.0);
+
+    const cv::Mat* depth = &inputs.depth;
+    const bool have_depth = depth->type() == CV_32F && depth->rows == static_cast<int>(kpts2->size());
+
+    std::vector<int> cur_landmarks(kpts2->size(), -1);
+    last_tracked = last_created = 0;
+    for (const auto& m : *matches) {
+        if (m.queryIdx < 0 || m.queryIdx >= static_cast<int>(kpts1->size()) ||
+            m.trainIdx < 0 || m.trainIdx >= static_cast<int>(kpts2->size())) continue;
+        const cv::Point2f& p1 = (*kpts1)[m.queryIdx].pt;
+        const cv::Point2f& p2 = (*kpts2)[m.trainIdx].pt;
+
+        int lm = prev_landmarks[m.queryIdx];
+        if (lm >= 0 && ba.has_landmark(lm)) {
+            ba.add_observation(cur, lm, p2);
+            cur_landmarks[m.trainIdx] = lm;
+            ++last_tracked;
+            continue;
+        }
+
+        cv::Vec3d X;
+        const float z = have_depth ? depth->at<float>(m.trainIdx, 0) : 0.0f;
+        if (z > 0.0f) {
+            const cv::Vec3d pc = K_inv * cv::Vec3d(p2.x, p2.y, 1.0) * z;
+            X = R_cur.t() * (pc - t_cur);
+        } else if (!triangulate(K_inv, R_prev, t_prev, p1, R_cur, t_cur, p2, max_cos, X)) {
+            continue;
+        }
+        lm = ba.add_landmark(X);
+        ba.add_observation(prev_frame, lm, p1);
+        ba.add_observation(cur, lm, p2);
+        cur_landmarks[m.trainIdx] = lm;
+        ++last_created;
+    }
+
+    last_stats = ba.optimize(K_d);
+
+    // Fixed frames have not moved since they were last written
+    for (int f = ba.first_frame_id() + ba.opts.fixed_frames; f < cur; ++f) {
+        poses.revise(f, pose_matrix(ba.rotation(f), ba.translation(f)));
+    }
+    poses.push_back(pose_matrix(ba.rotation(cur), ba.translation(cur)), input_frame_id);
+    const se3& newest = poses.back();
+    R_out->set(cv::Mat(newest.rotation_matx()), input_frame_id);
+    t_out->set(cv::Mat(newest.translation_vec()), input_frame_id);
+    poses_out->set(poses, input_frame_id);
+
+    std::vector<cv::Point3f> points;
+    ba.triangulated_points(points);
+    points_out->set(points, input_frame_id);
+
+    prev_landmarks.swap(cur_landmarks);
+    prev_frame = cur;
+
+    std::cout << "[LocalBA] Frame " << input_frame_id << ": " << last_stats.landmarks << " landmarks, rms "
+              << last_stats.initial_rms << " -> " << last_stats.final_rms << " px in " << last_stats.ms << " ms\n";
+}
+
+void local_ba_block::draw_ui() {
+    ImNodes::BeginNode(id);
+    ImNodes::BeginNodeTitleBar();
+    ImGui::TextUnformatted("Local BA");
+    ImNodes::EndNodeTitleBar();
+
+    ImNodes::BeginInputAttribute(id * 100 + 0);
+    ImGui::Text("Keypoints 1");
+    ImNodes::EndInputAttribute();
+
+    ImNodes::BeginInputAttribute(id * 100 + 1);
+    ImGui::Text("Keypoints 2");
+    ImNodes::EndInputAttribute();
+
+    ImNodes::BeginInputAttribute(id * 100 + 2);
+    ImGui::Text("Matches");
+    ImNodes::EndInputAttribute();
+
+    ImNodes::BeginInputAttribute(id * 100 + 3);
+    ImGui::Text("Intrinsics");
+    ImNodes::EndInputAttribute();
+
+    ImNodes::BeginInputAttribute(id * 100 + 4);
+    ImGui::Text("R");
+    ImNodes::EndInputAttribute();
+
+    ImNodes::BeginInputAttribute(id * 100 + 5);
+    ImGui::Text("t");
+    ImNodes::EndInputAttribute();
+
+    ImNodes::BeginInputAttribute(id * 100 + 6);
+    ImGui::Text("Depth");
+    ImNodes::EndInputAttribute();
+
+    ImNodes::BeginOutputAttribute(id * 10 + 0);
+    ImGui::Text("R_global");
+    ImNodes::EndOutputAttribute();
+
+    ImNodes::BeginOutputAttribute(id * 10 + 1);
+    ImGui::Text("t_global");
+    ImNodes::EndOutputAttribute();
+
+    ImNodes::BeginOutputAttribute(id * 10 + 2);
+    ImGui::Text("Poses");
+    ImNodes::EndOutputAttribute();
+
+    ImNodes::BeginOutputAttribute(id * 10 + 3);
+    ImGui::Text("3D Points");
+    ImNodes::EndOutputAttribute();
+
+    ImGui::SetNextItemWidth(120);
+    ImGui::SliderInt("Window", &window_size, 3, 30);
+    ImGui::SetNextItemWidth(120);
+    ImGui::SliderInt("Iterations", &max_iterations, 1, 30);
+    ImGui::SetNextItemWidth(120);
+    ImGui::SliderFloat("Budget (ms)", &time_budget_ms, 5.0f, 100.0f);
+    ImGui::SetNextItemWidth(120);
+    ImGui::SliderFloat("Huber (px)", &huber_px, 0.5f, 10.0f);
+    ImGui::SetNextItemWidth(120);
+    ImGui::SliderFloat("Min parallax", &min_parallax_deg, 0.1f, 5.0f, "%.1f deg");
+
+    ImGui::Text("Frames: %d  Landmarks: %d", ba.frame_count(), last_stats.landmarks);
+    ImGui::Text("Tracked %d, new %d, outliers %d", last_tracked, last_created, last_stats.outliers_removed);
+    ImGui::Text("RMS %.2f -> %.2f px", last_stats.initial_rms, last_stats.final_rms);
+    ImGui::Text("%d iters, %.1f ms%s", last_stats.iterations, last_stats.ms,
+                last_stats.time_limited ? " (budget hit)" : "");
+
+    ImNodes::EndNode();
+}
+
+std::vector<std::shared_ptr<base_port>> local_ba_block::get_input_ports() {
+    return {kpts1_in, kpts2_in, matches_in, K_in, R_in, t_in, depth_in};
+}
+
+std::vector<std::shared_ptr<base_port>> local_ba_block::get_output_ports() {
+    return {R_out, t_out, poses_out, points_out};
+}
+
+nlohmann::json local_ba_block::serialize() const {
+    nlohmann::json j;
+    j["window_size"] = window_size;
+    j["max_iterations"] = max_iterations;
+    j["time_budget_ms"] = time_budget_ms;
+    j["huber_px"] = huber_px;
+    j["min_parallax_deg"] = min_parallax_deg;
+    return j;
+}
+
+void local_ba_block::deserialize(const nlohmann::json& j) {
+    if (j.contains("window_size")) window_size = std::max(3, j["window_size"].get<int>());
+    if (j.contains("max_iterations")) max_iterations = std::max(1, j["max_iterations"].get<int>());
+    if (j.contains("time_budget_ms")) time_budget_ms = j["time_budget_ms"];
+    if (j.contains("huber_px")) huber_px = j["huber_px"];
+    if (j.contains("min_parallax_deg")) min_parallax_deg = j["min_parallax_deg"];
+}
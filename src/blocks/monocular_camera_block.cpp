@@ -4,6 +4,7 @@
 #include <opencv2/imgcodecs.hpp>
 #include <filesystem>
 #include <algorithm>
+#include <fstream>
 #include <iostream>
 #include <cstring>  // For strncpy
 
@@ -31,6 +32,48 @@ void monocular_camera_block::load_image_list() {
 
     std::sort(images.begin(), images.end());
     index = -1;  // So first frame loads index 0 on first advance
+    load_timestamps();
+}
+
+void monocular_camera_block::load_timestamps() {
+    timestamps.clear();
+
+    // KITTI layout: sequences/00/image_0/ sits next to sequences/00/times.txt
+    fs::path image_dir(folder);
+    if (!image_dir.has_filename()) image_dir = image_dir.parent_path();
+    fs::path times_path = image_dir.parent_path() / "times.txt";
+
+    std::ifstream ifs(times_path);
+    if (!ifs.is_open()) {
+        std::cout << "[Mono Camera] No times.txt at " << times_path << ", timed mode uses "
+                  << playback_rate_hz << " Hz\n";
+        return;
+    }
+
+    double t;
+    while (ifs >> t) timestamps.push_back(t);
+    if (timestamps.size() < images.size()) {
+        // One time base per sequence: mixing times.txt with index / rate
+        // past its end would put a jump into the schedule
+        std::cerr << "[Mono Camera] " << times_path << " has " << timestamps.size() << " timestamps for "
+                  << images.size() << " images, timed mode uses " << playback_rate_hz << " Hz\n";
+        timestamps.clear();
+        return;
+    }
+    std::cout << "[Mono Camera] Loaded " << timestamps.size() << " timestamps from " << times_path << "\n";
+}
+
+double monocular_camera_block::timestamp_of(int frame_index) const {
+    if (use_timestamps && frame_index >= 0 && frame_index < static_cast<int>(timestamps.size())) {
+        return timestamps[frame_index];
+    }
+    return frame_index / std::max(0.1, static_cast<double>(playback_rate_hz));
+}
+
+void monocular_camera_block::reset_playback() {
+    clock.reset();
+    releases.clear();
+    dropped_frames = 0;
 }
 
 bool monocular_camera_block::is_port_connected(int port_index, const std::vector<link_t>& links) {
@@ -65,12 +108,50 @@ void monocular_camera_block::load_next_frame() {
     }
 }
 
+void monocular_camera_block::process_timed() {
+    int next = index + 1;
+    if (next >= static_cast<int>(images.size())) return;
+
+    if (!clock.running()) clock.start(timestamp_of(next));
+    if (!clock.due(timestamp_of(next))) return;
+
+    auto now = playback_clock::clock::now();
+    if (drop_late_frames && !clock.as_fast_as_possible()) {
+        // A real sensor does not wait: skip frames whose successor is already due
+        while (next + 1 < static_cast<int>(images.size()) && now >= clock.release_time(timestamp_of(next + 1))) {
+            ++next;
+            ++dropped_frames;
+        }
+    }
+
+    frame_release release;
+    release.release = clock.as_fast_as_possible() ? now : clock.release_time(timestamp_of(next));
+    double period = (next + 1 < static_cast<int>(images.size()))
+        ? timestamp_of(next + 1) - timestamp_of(next)
+        : 1.0 / std::max(0.1, static_cast<double>(playback_rate_hz));
+    release.deadline = release.release + clock.to_wall(period);
+
+    index = next - 1;
+    load_next_frame();
+    release.frame_id = index;
+    releases.push_back(release);
+}
+
+bool monocular_camera_block::poll_release(frame_release& out) {
+    if (releases.empty()) return false;
+    out = releases.front();
+    releases.pop_front();
+    return true;
+}
+
 void monocular_camera_block::process(const std::vector<link_t>& links) {
     if (mode == SequenceMode::AUTO_PLAY) {
         load_next_frame();
     } else if (mode == SequenceMode::MANUAL && advance_requested) {
         load_next_frame();
         advance_requested = false;
+    } else if (mode == SequenceMode::TIMED) {
+        process_timed();
     }
 }
 
@@ -105,14 +186,35 @@ void monocular_camera_block::draw_ui() {
         curr_image.release();
         output_prev->set(cv::Mat(), -1);  // Reset frame_id
         output_curr->set(cv::Mat(), -1);
+        reset_playback();
         std::cout << "[Mono Camera] Reset frame_id to -1\n";
     }
 
     // Mode
-    const char* modes[] = {"Auto", "Manual"};
+    const char* modes[] = {"Auto", "Manual", "Timed"};
     ImGui::Text("Mode:");
     ImGui::SetNextItemWidth(80);
-    ImGui::Combo("##mode", (int*)&mode, modes, IM_ARRAYSIZE(modes));
+    if (ImGui::Combo("##mode", (int*)&mode, modes, IM_ARRAYSIZE(modes))) {
+        reset_playback();
+    }
+
+    if (mode == SequenceMode::TIMED) {
+        if (ImGui::Checkbox("times.txt", &use_timestamps)) reset_playback();
+        if (!use_timestamps || timestamps.empty()) {
+            ImGui::SetNextItemWidth(80);
+            if (ImGui::InputFloat("Hz", &playback_rate_hz)) {
+                playback_rate_hz = std::max(0.1f, playback_rate_hz);
+                reset_playback();
+            }
+        }
+        ImGui::SetNextItemWidth(80);
+        if (ImGui::InputFloat("Speed (0=max)", &playback_speed)) {
+            playback_speed = std::max(0.0f, playback_speed);
+            clock.set_speed(playback_speed);
+        }
+        ImGui::Checkbox("Drop late", &drop_late_frames);
+        ImGui::Text("Dropped: %d", dropped_frames);
+    }
 
     // Current frame
     if (index >= 0 && index < images.size()) {
@@ -131,6 +233,7 @@ void monocular_camera_block::draw_ui() {
         curr_image.release();
         output_prev->set(cv::Mat(), -1);
         output_curr->set(cv::Mat(), -1);
+        reset_playback();
         std::cout << "[Mono Camera] Reset frame_id to -1\n";
     }
 
@@ -149,6 +252,11 @@ nlohmann::json monocular_camera_block::serialize() const {
     nlohmann::json j;
     j["folder"] = folder;
     j["index"] = index;
+    j["mode"] = static_cast<int>(mode);
+    j["use_timestamps"] = use_timestamps;
+    j["playback_rate_hz"] = playback_rate_hz;
+    j["playback_speed"] = playback_speed;
+    j["drop_late_frames"] = drop_late_frames;
     return j;
 }
 
@@ -159,5 +267,22 @@ void monocular_camera_block::deserialize(const nlohmann::json& j) {
     if (j.contains("index")) {
         index = j["index"];
     }
+    if (j.contains("mode")) {
+        mode = static_cast<SequenceMode>(j["mode"].get<int>());
+    }
+    if (j.contains("use_timestamps")) {
+        use_timestamps = j["use_timestamps"];
+    }
+    if (j.contains("playback_rate_hz")) {
+        playback_rate_hz = j["playback_rate_hz"];
+    }
+    if (j.contains("playback_speed")) {
+        playback_speed = j["playback_speed"];
+        clock.set_speed(playback_speed);
+    }
+    if (j.contains("drop_late_frames")) {
+        drop_late_frames = j["drop_late_frames"];
+    }
+    reset_playback();
     load_image_list();
 }
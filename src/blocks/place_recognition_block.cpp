@@ -0,0 +1,159 @@
+#include "blocks/place_recognition_block.hpp"
+
+#include <imnodes.h>
+#include <imgui.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+place_recognition_block::place_recognition_block(int id)
+    : block(id, "Place Recognition") {
+    desc_in = std::make_shared<data_port<cv::Mat>>("descriptors");
+    candidates_out = std::make_shared<data_port<std::vector<loop_candidate>>>("loop candidates");
+}
+
+void place_recognition_block::load_vocabulary() {
+    // Word ids are only meaningful for one vocabulary
+    database.clear();
+    keyframe_frame_ids.clear();
+    frames_since_keyframe = 0;
+
+    if (vocabulary_path.empty()) return;
+    if (vocabulary.load(vocabulary_path)) {
+        std::cout << "[Place Recognition] Loaded " << vocabulary.word_count() << " words from "
+                  << vocabulary_path << "\n";
+    }
+}
+
+void place_recognition_block::process(const std::vector<link_t>&) {
+    const cv::Mat* desc = desc_in->get();
+    if (!desc || desc->empty() || vocabulary.empty()) return;
+
+    int input_frame_id = desc_in->frame_id;
+    if (input_frame_id == last_processed_frame_id) return;
+    last_processed_frame_id = input_frame_id;
+
+    if (desc->type() != CV_8U || desc->cols != vocabulary_tree::kBytes) {
+        std::cerr << "[Place Recognition] Expected 32-byte binary descriptors\n";
+        return;
+    }
+
+    // Frame ids going backwards means the source restarted
+    if (!keyframe_frame_ids.empty() && input_frame_id <= keyframe_frame_ids.back()) {
+        database.clear();
+        keyframe_frame_ids.clear();
+        frames_since_keyframe = 0;
+    }
+
+    using clock = std::chrono::steady_clock;
+    auto ms = [](clock::time_point a, clock::time_point b) {
+        return std::chrono::duration<double, std::milli>(b - a).count();
+    };
+
+    auto t0 = clock::now();
+    vocabulary.transform(*desc, bow);
+    auto t1 = clock::now();
+
+    // Keyframes are inserted in frame order, so the recent ones form a suffix
+    const int newest_allowed = input_frame_id - exclude_recent;
+    const int entry_limit = static_cast<int>(
+        std::upper_bound(keyframe_frame_ids.begin(), keyframe_frame_ids.end(), newest_allowed) -
+        keyframe_frame_ids.begin());
+    database.query(bow, top_k, entry_limit, results);
+    auto t2 = clock::now();
+
+    std::vector<loop_candidate> candidates;
+    for (const auto& r : results) {
+        if (r.score < min_score) break;
+        candidates.push_back({keyframe_frame_ids[r.entry], r.entry, r.score});
+    }
+    best_score = results.empty() ? 0.0f : results.front().score;
+
+    if (frames_since_keyframe++ % std::max(1, keyframe_interval) == 0) {
+        database.add(bow);
+        keyframe_frame_ids.push_back(input_frame_id);
+    }
+    auto t3 = clock::now();
+
+    transform_ms = ms(t0, t1);
+    query_ms = ms(t1, t2);
+    insert_ms = ms(t2, t3);
+
+    candidates_out->set(candidates, input_frame_id);
+}
+
+void place_recognition_block::draw_ui() {
+    ImNodes::BeginNode(id);
+
+    ImNodes::BeginNodeTitleBar();
+    ImGui::TextUnformatted("Place Recognition");
+    ImNodes::EndNodeTitleBar();
+
+    ImNodes::BeginInputAttribute(id * 100 + 0);
+    ImGui::Text("Desc");
+    ImGui::Dummy(ImVec2(1, 1));
+    ImNodes::EndInputAttribute();
+
+    ImNodes::BeginOutputAttribute(id * 10 + 0);
+    ImGui::Text("Loops");
+    ImNodes::EndOutputAttribute();
+
+    ImGui::SetNextItemWidth(150);
+    ImGui::InputText("##vocabulary_path", path_buf, IM_ARRAYSIZE(path_buf));
+    if (ImGui::Button("Load vocabulary")) {
+        vocabulary_path = std::string(path_buf);
+        load_vocabulary();
+    }
+
+    ImGui::SetNextItemWidth(100);
+    ImGui::SliderInt("Top k", &top_k, 1, 20);
+    ImGui::SetNextItemWidth(100);
+    ImGui::SliderFloat("Min score", &min_score, 0.0f, 1.0f);
+    ImGui::SetNextItemWidth(100);
+    ImGui::SliderInt("Exclude recent", &exclude_recent, 0, 500);
+    ImGui::SetNextItemWidth(100);
+    ImGui::SliderInt("KF interval", &keyframe_interval, 1, 30);
+
+    if (vocabulary.empty()) {
+        ImGui::TextColored(ImVec4(1, 0.5f, 0, 1), "No vocabulary loaded");
+    } else {
+        ImGui::Text("Words: %d", vocabulary.word_count());
+    }
+    ImGui::Text("Keyframes: %d", database.size());
+    ImGui::Text("Best score: %.3f", best_score);
+    ImGui::Text("BoW %.2f ms, query %.3f ms, insert %.3f ms", transform_ms, query_ms, insert_ms);
+
+    ImNodes::EndNode();
+}
+
+std::vector<std::shared_ptr<base_port>> place_recognition_block::get_input_ports() {
+    return {desc_in};
+}
+
+std::vector<std::shared_ptr<base_port>> place_recognition_block::get_output_ports() {
+    return {candidates_out};
+}
+
+nlohmann::json place_recognition_block::serialize() const {
+    nlohmann::json j;
+    j["vocabulary_path"] = vocabulary_path;
+    j["top_k"] = top_k;
+    j["min_score"] = min_score;
+    j["exclude_recent"] = exclude_recent;
+    j["keyframe_interval"] = keyframe_interval;
+    return j;
+}
+
+void place_recognition_block::deserialize(const nlohmann::json& j) {
+    if (j.contains("top_k")) top_k = std::max(1, j["top_k"].get<int>());
+    if (j.contains("min_score")) min_score = j["min_score"];
+    if (j.contains("exclude_recent")) exclude_recent = std::max(0, j["exclude_recent"].get<int>());
+    if (j.contains("keyframe_interval")) keyframe_interval = std::max(1, j["keyframe_interval"].get<int>());
+    if (j.contains("vocabulary_path")) {
+        vocabulary_path = j["vocabulary_path"];
+        strncpy(path_buf, vocabulary_path.c_str(), sizeof(path_buf));
+        path_buf[sizeof(path_buf) - 1] = '\0';
+        load_vocabulary();
+    }
+}
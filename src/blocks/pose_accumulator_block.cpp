@@ -7,50 +7,66 @@ pose_accumulator_block::pose_accumulator_block(int id)
     : block(id, "Pose Accumulator"), frame_id(-1) {  // Initialize frame_id here
     R_in = std::make_shared<data_port<cv::Mat>>("R");
     t_in = std::make_shared<data_port<cv::Mat>>("t");
+    pose_in = std::make_shared<data_port<se3>>("Pose");
 
     R_out = std::make_shared<data_port<cv::Mat>>("R_global");
     t_out = std::make_shared<data_port<cv::Mat>>("t_global");
-    poses_out = std::make_shared<data_port<std::vector<cv::Mat>>>("Poses");
-
-    R_global = cv::Mat::eye(3, 3, CV_64F);
-    t_global = cv::Mat::zeros(3, 1, CV_64F);
+    poses_out = std::make_shared<data_port<trajectory>>("Poses");
+    pose_out = std::make_shared<data_port<se3>>("Pose");
 
     // Initialize outputs with current frame_id (-1)
-    R_out->set(R_global, frame_id);
-    t_out->set(t_global, frame_id);
+    R_out->set(cv::Mat::eye(3, 3, CV_64F), frame_id);
+    t_out->set(cv::Mat::zeros(3, 1, CV_64F), frame_id);
     poses_out->set(pose_history, frame_id);
+    pose_out->set(pose_global, frame_id);
 
     std::cout << "[PoseAccumulator] Initialized with frame_id = " << frame_id << "\n";
 }
 
-void pose_accumulator_block::process(const std::vector<link_t>&) {
-    const cv::Mat* R_rel = R_in->get();
-    const cv::Mat* t_rel = t_in->get();
+bool pose_accumulator_block::is_port_connected(int port_index, const std::vector<link_t>& links) {
+    for (const auto& link : links) {
+        if (link.start_attr / 10 == this->id && link.start_attr % 10 == port_index) {
+            return true;
+        }
+    }
+    return false;
+}
 
-    if (!R_rel || !t_rel || R_rel->empty() || t_rel->empty())
-        return;
+void pose_accumulator_block::process(const std::vector<link_t>& links) {
+    // The fixed-size pose wins whenever it is at least as fresh
+    const bool fixed = pose_in->frame_id >= 0 && pose_in->frame_id >= R_in->frame_id;
+
+    se3 rel;
+    int input_frame_id;
+    if (fixed) {
+        rel = *pose_in->data;
+        input_frame_id = pose_in->frame_id;
+    } else {
+        const cv::Mat* R_rel = R_in->get();
+        const cv::Mat* t_rel = t_in->get();
+        if (!R_rel || !t_rel || R_rel->empty() || t_rel->empty())
+            return;
+        input_frame_id = R_in->frame_id;
+        if (input_frame_id != last_processed_frame_id) rel = se3::from_mat(*R_rel, *t_rel);
+    }
 
-    int input_frame_id = R_in->frame_id;
     if (input_frame_id == last_processed_frame_id) {
         // Already processed this frame, skip redundant work
         return;
     }
     last_processed_frame_id = input_frame_id;
 
-    // Accumulate global pose
-    t_global = R_global * (*t_rel) + t_global;
-    R_global = R_global * (*R_rel);
-
-    R_out->set(R_global, input_frame_id);
-    t_out->set(t_global, input_frame_id);
+    // Accumulate global pose: t_g = R_g t + t_g, R_g = R_g R. Rounding is
+    // kept from building up in R over long sequences.
+    pose_global = (pose_global * rel).normalized();
+    pose_out->set(pose_global, input_frame_id);
 
-    // Combine into [R|t] matrix for pose history
-    cv::Mat Rt = cv::Mat::eye(3, 4, CV_64F);
-    R_global.copyTo(Rt(cv::Rect(0, 0, 3, 3)));
-    t_global.copyTo(Rt(cv::Rect(3, 0, 1, 3)));
-    pose_history.push_back(Rt);
+    // The port holds a handle to the same poses, so only the new one is written
+    pose_history.push_back(pose_global, input_frame_id);
+    poses_out->frame_id = input_frame_id;
 
-    poses_out->set(pose_history, input_frame_id);
+    if (is_port_connected(0, links)) R_out->set(cv::Mat(pose_global.rotation_matx()), input_frame_id);
+    if (is_port_connected(1, links)) t_out->set(cv::Mat(pose_global.translation_vec()), input_frame_id);
 
     std::cout << "[Pose Accumulator] Updated global pose. Total poses: " << pose_history.size()
               << ", frame_id: " << input_frame_id << "\n";
@@ -64,20 +80,22 @@ void pose_accumulator_block::draw_ui() {
 
     ImNodes::BeginInputAttribute(id * 100 + 0); ImGui::Text("R"); ImNodes::EndInputAttribute();
     ImNodes::BeginInputAttribute(id * 100 + 1); ImGui::Text("t"); ImNodes::EndInputAttribute();
+    ImNodes::BeginInputAttribute(id * 100 + 2); ImGui::Text("Pose"); ImNodes::EndInputAttribute();
 
     ImNodes::BeginOutputAttribute(id * 10 + 0); ImGui::Text("R_global"); ImNodes::EndOutputAttribute();
     ImNodes::BeginOutputAttribute(id * 10 + 1); ImGui::Text("t_global"); ImNodes::EndOutputAttribute();
     ImNodes::BeginOutputAttribute(id * 10 + 2); ImGui::Text("Poses"); ImNodes::EndOutputAttribute();
+    ImNodes::BeginOutputAttribute(id * 10 + 3); ImGui::Text("Pose"); ImNodes::EndOutputAttribute();
 
     ImNodes::EndNode();
 }
 
 std::vector<std::shared_ptr<base_port>> pose_accumulator_block::get_input_ports() {
-    return {R_in, t_in};
+    return {R_in, t_in, pose_in};
 }
 
 std::vector<std::shared_ptr<base_port>> pose_accumulator_block::get_output_ports() {
-    return {R_out, t_out, poses_out};
+    return {R_out, t_out, poses_out, pose_out};
 }
 
 nlohmann::json pose_accumulator_block::serialize() const {
@@ -5,6 +5,9 @@
 
 #include <opencv2/calib3d.hpp>
 #include <opencv2/core.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <iostream>
 
 pose_estimator_block::pose_estimator_block(int id)
@@ -13,9 +16,25 @@ pose_estimator_block::pose_estimator_block(int id)
     kpts2_in = std::make_shared<data_port<std::vector<cv::KeyPoint>>>("Keypoints 2");
     matches_in = std::make_shared<data_port<std::vector<cv::DMatch>>>("Matches");
     K_in = std::make_shared<data_port<cv::Mat>>("Intrinsics");
+    features1_in = std::make_shared<data_port<feature_set>>("Features 1");
+    features2_in = std::make_shared<data_port<feature_set>>("Features 2");
+    selection_in = std::make_shared<data_port<match_selection>>("Selection");
 
     R_out = std::make_shared<data_port<cv::Mat>>("Rotation");
     t_out = std::make_shared<data_port<cv::Mat>>("Translation");
+    inliers_out = std::make_shared<data_port<int>>("Inliers");
+    pose_out = std::make_shared<data_port<se3>>("Pose");
+}
+
+bool pose_estimator_block::use_features() const {
+    // Feature sets win whenever both are present and each is at least as
+    // fresh as the keypoints on its side
+    return !features1_in->data->empty() && !features2_in->data->empty() &&
+           features1_in->frame_id >= kpts1_in->frame_id && features2_in->frame_id >= kpts2_in->frame_id;
+}
+
+bool pose_estimator_block::use_selection() const {
+    return selection_in->data->valid() && selection_in->frame_id >= matches_in->frame_id;
 }
 
 void pose_estimator_block::process(const std::vector<link_t>&) {
@@ -24,7 +43,13 @@ void pose_estimator_block::process(const std::vector<link_t>&) {
         return;
     }
 
-    int input_frame_id = kpts1_in->frame_id;
+    const bool chained = use_selection();
+    const bool columnar = !chained && use_features();
+    // Both sets must be from the same frame pair; wait for the other side
+    if (columnar && features2_in->frame_id != features1_in->frame_id) return;
+
+    int input_frame_id = chained ? selection_in->frame_id
+                       : columnar ? features1_in->frame_id : kpts1_in->frame_id;
     if (input_frame_id == last_processed_frame_id) {
         // Already processed this frame, skip redundant work
         return;
@@ -36,40 +61,142 @@ void pose_estimator_block::process(const std::vector<link_t>&) {
     const auto* matches = matches_in->get();
     const auto* K = K_in->get();
 
-    if (!kpts1 || !kpts2 || !matches || !K) {
+    if (!matches || !K || (!chained && !columnar && (!kpts1 || !kpts2))) {
         std::cerr << "[PoseEstimator] One or more inputs are null.\n";
         return;
     }
 
-    if (kpts1->empty() || kpts2->empty() || matches->empty()) {
-        std::cerr << "[PoseEstimator] One or more inputs are empty.\n";
-        return;
-    }
-
     std::vector<cv::Point2f> pts1, pts2;
-    for (const auto& m : *matches) {
-        pts1.push_back((*kpts1)[m.queryIdx].pt);
-        pts2.push_back((*kpts2)[m.trainIdx].pt);
+    std::vector<cv::DMatch> selected_matches;
+    if (chained) {
+        // Only the selected matches are read; their distances are copied out
+        // when a USAC method orders its samples by them
+        const match_selection& selection = *selection_in->data;
+        if (selection.empty()) {
+            std::cerr << "[PoseEstimator] One or more inputs are empty.\n";
+            return;
+        }
+        selection.gather_points(pts1, pts2,
+                                method_index != static_cast<int>(robust_method::RANSAC) ? &selected_matches : nullptr);
+        matches = &selected_matches;
+    } else if (columnar) {
+        if (matches->empty()) {
+            std::cerr << "[PoseEstimator] One or more inputs are empty.\n";
+            return;
+        }
+        if (!gather_matched_points(*features1_in->data, *features2_in->data, *matches, pts1, pts2)) {
+            std::cerr << "[PoseEstimator] Matches do not index the connected feature sets.\n";
+            return;
+        }
+    } else {
+        if (kpts1->empty() || kpts2->empty() || matches->empty()) {
+            std::cerr << "[PoseEstimator] One or more inputs are empty.\n";
+            return;
+        }
+        for (const auto& m : *matches) {
+            pts1.push_back((*kpts1)[m.queryIdx].pt);
+            pts2.push_back((*kpts2)[m.trainIdx].pt);
+        }
     }
     
     if (K->rows != 3 || K->cols != 3 || K->channels() != 1) {
         std::cerr << "[PoseEstimator] Invalid intrinsic matrix:\n" << *K << std::endl;
         return;
     }
-    cv::Mat mask;
-    cv::Mat E = cv::findEssentialMat(pts1, pts2, *K, cv::RANSAC, 0.999, 1.0, mask);
-    if (E.empty()) {
-        std::cerr << "[PoseEstimator] Essential matrix could not be computed.\n";
-        return;
+
+    // Frame ids going backwards means the source restarted
+    if (input_frame_id <= prior_frame_id) prior_valid = false;
+    const bool attempt_prior = use_motion_prior && prior_valid;
+
+    cv::Matx33d K_d;
+    K->convertTo(K_d, CV_64F);
+
+    using clock = std::chrono::steady_clock;
+    auto start = clock::now();
+    cv::Mat R, t, mask;
+    int inliers = 0;
+    last_from_prior = attempt_prior && try_motion_prior(pts1, pts2, K_d, R, t, mask, inliers);
+    const double prior_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    if (attempt_prior) {
+        avg_prior_ms = prior_attempts == 1 ? prior_ms : 0.9 * avg_prior_ms + 0.1 * prior_ms;
+    }
+
+    if (last_from_prior) {
+        ++prior_hits;
+        time_saved_ms += avg_full_ms - prior_ms;
+        last_estimate_ms = prior_ms;
+    } else {
+        if (attempt_prior) time_saved_ms -= prior_ms;
+
+        robust_config cfg;
+        cfg.method = static_cast<robust_method>(method_index);
+        cfg.threshold = ransac_threshold;
+        cfg.confidence = confidence;
+        cfg.max_iterations = max_iterations;
+
+        start = clock::now();
+        // Match distances order the PROSAC samples; pts1/pts2 follow *matches
+        cv::Mat E = estimate_essential(pts1, pts2, *K, matches, cfg, mask);
+        if (E.empty()) {
+            std::cerr << "[PoseEstimator] Essential matrix could not be computed.\n";
+            prior_valid = false;
+            return;
+        }
+        inliers = cv::recoverPose(E, pts1, pts2, *K, R, t, mask);
+        last_estimate_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+        avg_full_ms = avg_full_ms == 0.0 ? last_estimate_ms : 0.9 * avg_full_ms + 0.1 * last_estimate_ms;
+        reference_inlier_ratio = static_cast<double>(inliers) / pts1.size();
     }
+    last_inliers = inliers;
 
-    cv::Mat R, t;
-    int inliers = cv::recoverPose(E, pts1, pts2, *K, R, t, mask);
+    // The next frame starts from this one's motion
+    R.convertTo(prior_R, CV_64F);
+    t.convertTo(prior_t, CV_64F);
+    prior_valid = inliers >= 5;
+    prior_frame_id = input_frame_id;
 
     std::cout << "[PoseEstimator] Processing frame " << input_frame_id << ", inliers: " << inliers << "\n";
 
     R_out->set(R, input_frame_id);
     t_out->set(t, input_frame_id);
+    inliers_out->set(inliers, input_frame_id);
+    pose_out->set(se3::from_matx(prior_R, prior_t), input_frame_id);
+}
+
+bool pose_estimator_block::try_motion_prior(const std::vector<cv::Point2f>& pts1,
+                                            const std::vector<cv::Point2f>& pts2, const cv::Matx33d& K,
+                                            cv::Mat& R, cv::Mat& t, cv::Mat& mask, int& inliers) {
+    ++prior_attempts;
+    const int required = std::max(8, static_cast<int>(
+        std::ceil(prior_min_support * reference_inlier_ratio * pts1.size())));
+
+    cv::Matx33d pose_R = prior_R;
+    cv::Vec3d pose_t = prior_t;
+    int support = count_pose_inliers(pose_R, pose_t, pts1, pts2, K, ransac_threshold, mask);
+
+    // Refinement and re-scoring alternate, since a better pose admits
+    // inliers the first mask missed
+    for (int round = 0; round < 3 && support >= 8; ++round) {
+        cv::Matx33d refined_R = pose_R;
+        cv::Vec3d refined_t = pose_t;
+        if (!refine_pose(refined_R, refined_t, pts1, pts2, K, mask, prior_refine_iterations)) break;
+        cv::Mat new_mask;
+        const int new_support = count_pose_inliers(refined_R, refined_t, pts1, pts2, K, ransac_threshold, new_mask);
+        if (new_support < support) break;
+        const bool grew = new_support > support;
+        pose_R = refined_R;
+        pose_t = refined_t;
+        support = new_support;
+        mask = new_mask;
+        if (!grew) break;
+    }
+
+    if (support < required) return false;
+
+    R = cv::Mat(pose_R);
+    t = cv::Mat(pose_t);
+    inliers = support;
+    return true;
 }
 
 void pose_estimator_block::draw_ui() {
@@ -94,6 +221,18 @@ void pose_estimator_block::draw_ui() {
     ImGui::Text("Intrinsics");
     ImNodes::EndInputAttribute();
 
+    ImNodes::BeginInputAttribute(id * 100 + 4);
+    ImGui::Text("Features 1");
+    ImNodes::EndInputAttribute();
+
+    ImNodes::BeginInputAttribute(id * 100 + 5);
+    ImGui::Text("Features 2");
+    ImNodes::EndInputAttribute();
+
+    ImNodes::BeginInputAttribute(id * 100 + 6);
+    ImGui::Text("Selection");
+    ImNodes::EndInputAttribute();
+
     ImNodes::BeginOutputAttribute(id * 10 + 0);
     ImGui::Text("R");
     ImNodes::EndOutputAttribute();
@@ -102,24 +241,82 @@ void pose_estimator_block::draw_ui() {
     ImGui::Text("t");
     ImNodes::EndOutputAttribute();
 
+    ImNodes::BeginOutputAttribute(id * 10 + 2);
+    ImGui::Text("Inliers");
+    ImNodes::EndOutputAttribute();
+
+    ImNodes::BeginOutputAttribute(id * 10 + 3);
+    ImGui::Text("Pose");
+    ImNodes::EndOutputAttribute();
+
+    ImGui::Text("Method:");
+    ImGui::SetNextItemWidth(120);
+    static const char* method_names[] = { "RANSAC", "USAC PROSAC", "USAC MAGSAC++" };
+    ImGui::Combo("##method", &method_index, method_names, IM_ARRAYSIZE(method_names));
+    ImGui::SetNextItemWidth(120);
+    ImGui::SliderFloat("Thresh (px)", &ransac_threshold, 0.1f, 5.0f);
+    ImGui::SetNextItemWidth(120);
+    ImGui::SliderFloat("Confidence", &confidence, 0.9f, 0.9999f, "%.4f");
+    ImGui::SetNextItemWidth(120);
+    ImGui::SliderInt("Max iters", &max_iterations, 50, 10000);
+    ImGui::Text("Inliers: %d  (%.2f ms)", last_inliers, last_estimate_ms);
+
+    ImGui::Checkbox("Motion prior", &use_motion_prior);
+    if (use_motion_prior) {
+        ImGui::SetNextItemWidth(120);
+        ImGui::SliderFloat("Min support", &prior_min_support, 0.5f, 1.0f);
+        ImGui::SetNextItemWidth(120);
+        ImGui::SliderInt("Refine iters", &prior_refine_iterations, 0, 20);
+        const double hit_rate = prior_attempts > 0 ? 100.0 * prior_hits / prior_attempts : 0.0;
+        ImGui::Text("Prior hits: %d/%d (%.0f%%)%s", prior_hits, prior_attempts, hit_rate,
+                    last_from_prior ? "  [prior]" : "");
+        ImGui::Text("Prior %.2f ms vs full %.2f ms", avg_prior_ms, avg_full_ms);
+        ImGui::Text("Saved: %.1f ms", time_saved_ms);
+    }
+
     ImNodes::EndNode();
 }
 
 std::vector<std::shared_ptr<base_port>> pose_estimator_block::get_input_ports() {
-    return {kpts1_in, kpts2_in, matches_in, K_in};
+    return {kpts1_in, kpts2_in, matches_in, K_in, features1_in, features2_in, selection_in};
 }
 
 std::vector<std::shared_ptr<base_port>> pose_estimator_block::get_output_ports() {
-    return {R_out, t_out};
+    return {R_out, t_out, inliers_out, pose_out};
 }
 
 nlohmann::json pose_estimator_block::serialize() const {
     nlohmann::json j;
-    // Pose estimator doesn't have configurable parameters currently
+    j["method_index"] = method_index;
+    j["ransac_threshold"] = ransac_threshold;
+    j["confidence"] = confidence;
+    j["max_iterations"] = max_iterations;
+    j["use_motion_prior"] = use_motion_prior;
+    j["prior_min_support"] = prior_min_support;
+    j["prior_refine_iterations"] = prior_refine_iterations;
     return j;
 }
 
 void pose_estimator_block::deserialize(const nlohmann::json& j) {
-    // Pose estimator doesn't have configurable parameters currently
-    (void)j; // Suppress unused parameter warning
+    if (j.contains("method_index")) {
+        method_index = std::clamp(j["method_index"].get<int>(), 0, 2);
+    }
+    if (j.contains("ransac_threshold")) {
+        ransac_threshold = j["ransac_threshold"];
+    }
+    if (j.contains("confidence")) {
+        confidence = j["confidence"];
+    }
+    if (j.contains("max_iterations")) {
+        max_iterations = std::max(1, j["max_iterations"].get<int>());
+    }
+    if (j.contains("use_motion_prior")) {
+        use_motion_prior = j["use_motion_prior"];
+    }
+    if (j.contains("prior_min_support")) {
+        prior_min_support = j["prior_min_support"];
+    }
+    if (j.contains("prior_refine_iterations")) {
+        prior_refine_iterations = std::max(0, j["prior_refine_iterations"].get<int>());
+    }
 }
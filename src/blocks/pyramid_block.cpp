@@ -0,0 +1,90 @@
+#include "blocks/pyramid_block.hpp"
+
+#include <imnodes.h>
+#include <imgui.h>
+#include <algorithm>
+#include <iostream>
+
+pyramid_block::pyramid_block(int id)
+    : block(id, "Pyramid") {
+    input_image = std::make_shared<data_port<cv::Mat>>("image");
+    output_pyramid = std::make_shared<data_port<image_pyramid>>("pyramid");
+}
+
+void pyramid_block::process(const std::vector<link_t>&) {
+    if (!input_image->data || input_image->data->empty()) return;
+
+    int input_frame_id = input_image->frame_id;
+    if (input_frame_id == last_processed_frame_id) {
+        // Already processed this frame, skip redundant work
+        return;
+    }
+    last_processed_frame_id = input_frame_id;
+
+    // Consumers keep the last frame's buffer until the next link copy, so
+    // build into the buffer from two frames ago instead. It is rebuilt in
+    // place unless some consumer still holds it (a tracker keeping its
+    // previous pyramid), in which case a new one is allocated.
+    std::swap(output_pyramid->data->storage, spare_storage);
+    build_image_pyramid(*input_image->data, nlevels, scale_factor, *output_pyramid->data);
+    output_pyramid->frame_id = input_frame_id;
+}
+
+void pyramid_block::draw_ui() {
+    ImNodes::BeginNode(id);
+
+    ImNodes::BeginNodeTitleBar();
+    ImGui::TextUnformatted("Pyramid");
+    ImNodes::EndNodeTitleBar();
+
+    ImNodes::BeginInputAttribute(id * 100 + 0);
+    ImGui::Text("Img");
+    ImGui::Dummy(ImVec2(1, 1));
+    ImNodes::EndInputAttribute();
+
+    ImNodes::BeginOutputAttribute(id * 10 + 0);
+    ImGui::Text("Pyr");
+    ImNodes::EndOutputAttribute();
+
+    ImGui::Text("Levels:");
+    ImGui::SetNextItemWidth(80);
+    if (ImGui::SliderInt("##levels", &nlevels, 1, 12)) {
+        last_processed_frame_id = -1;
+    }
+
+    ImGui::Text("Scale:");
+    ImGui::SetNextItemWidth(80);
+    if (ImGui::SliderFloat("##scale", &scale_factor, 1.1f, 2.0f)) {
+        last_processed_frame_id = -1;
+    }
+
+    if (!output_pyramid->data->empty()) {
+        ImGui::Text("%d levels built", static_cast<int>(output_pyramid->data->size()));
+    }
+
+    ImNodes::EndNode();
+}
+
+std::vector<std::shared_ptr<base_port>> pyramid_block::get_input_ports() {
+    return {input_image};
+}
+
+std::vector<std::shared_ptr<base_port>> pyramid_block::get_output_ports() {
+    return {output_pyramid};
+}
+
+nlohmann::json pyramid_block::serialize() const {
+    nlohmann::json j;
+    j["nlevels"] = nlevels;
+    j["scale_factor"] = scale_factor;
+    return j;
+}
+
+void pyramid_block::deserialize(const nlohmann::json& j) {
+    if (j.contains("nlevels")) {
+        nlevels = std::clamp(j["nlevels"].get<int>(), 1, 12);
+    }
+    if (j.contains("scale_factor")) {
+        scale_factor = j["scale_factor"];
+    }
+}
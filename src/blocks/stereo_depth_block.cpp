@@ -0,0 +1,290 @@
+#include "blocks/stereo_depth_block.hpp"
+
+#include <imnodes.h>
+#include <imgui.h>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace {
+
+void to_gray(const cv::Mat& image, cv::Mat& gray) {
+    if (image.channels() == 3) {
+        cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+    } else {
+        gray = image;
+    }
+}
+
+}  // namespace
+
+stereo_depth_block::stereo_depth_block(int id)
+    : block(id, "Stereo Depth") {
+    left_in = std::make_shared<data_port<cv::Mat>>("left_image");
+    right_in = std::make_shared<data_port<cv::Mat>>("right_image");
+    K_in = std::make_shared<data_port<cv::Mat>>("K");
+    R_in = std::make_shared<data_port<cv::Mat>>("R");
+    t_in = std::make_shared<data_port<cv::Mat>>("t");
+    kpts_in = std::make_shared<data_port<std::vector<cv::KeyPoint>>>("keypoints");
+
+    depth_out = std::make_shared<data_port<cv::Mat>>("depth");
+    points_out = std::make_shared<data_port<std::vector<cv::Point3f>>>("3D Points");
+}
+
+void stereo_depth_block::process(const std::vector<link_t>&) {
+    const cv::Mat* left = left_in->get();
+    const cv::Mat* right = right_in->get();
+    const cv::Mat* K = K_in->get();
+    const cv::Mat* t = t_in->get();
+    if (!K || K->empty() || !t || t->empty()) return;
+
+    const bool sparse = mode_index == 0;
+
+    // A new pair: both images of it must be from the same frame
+    const int pair_frame_id = left_in->frame_id;
+    if (left && right && !left->empty() && !right->empty() && right_in->frame_id == pair_frame_id &&
+        pair_frame_id != last_pair_frame_id) {
+        last_pair_frame_id = pair_frame_id;
+        if (left->size() != right->size()) {
+            std::cerr << "[StereoDepth] Left and right images differ in size\n";
+            return;
+        }
+        if (sparse) {
+            // The keypoints for this pair are extracted from the left image
+            // and only arrive on a later tick, so park the pair until they do
+            if (!pending_pairs.empty() && pair_frame_id < pending_pairs.back().frame_id) {
+                pending_pairs.clear();  // Frame ids going backwards means the source restarted
+            }
+            stereo_pair pair;
+            pair.frame_id = pair_frame_id;
+            to_gray(*left, pair.left_gray);
+            to_gray(*right, pair.right_gray);
+            pending_pairs.push_back(std::move(pair));
+            if (pending_pairs.size() > kMaxPendingPairs) pending_pairs.pop_front();
+        } else {
+            pending_pairs.clear();
+            to_gray(*left, left_gray);
+            to_gray(*right, right_gray);
+            compute(pair_frame_id, *K, *t, nullptr);
+        }
+    }
+
+    if (!sparse) return;
+    const auto* keypoints = kpts_in->get();
+    const int kpts_frame_id = kpts_in->frame_id;
+    if (!keypoints || kpts_frame_id < 0 || kpts_frame_id == last_processed_frame_id) return;
+
+    auto it = std::find_if(pending_pairs.begin(), pending_pairs.end(),
+                           [kpts_frame_id](const stereo_pair& p) { return p.frame_id == kpts_frame_id; });
+    if (it == pending_pairs.end()) return;  // Pair not seen yet, or already dropped
+    left_gray = it->left_gray;
+    right_gray = it->right_gray;
+    pending_pairs.erase(pending_pairs.begin(), it + 1);
+    compute(kpts_frame_id, *K, *t, keypoints);
+}
+
+void stereo_depth_block::compute(int frame_id, const cv::Mat& K, const cv::Mat& t,
+                                 const std::vector<cv::KeyPoint>* keypoints) {
+    last_processed_frame_id = frame_id;
+
+    cv::Mat K_d, t_d;
+    K.convertTo(K_d, CV_64F);
+    t.convertTo(t_d, CV_64F);
+    const double baseline = cv::norm(t_d);
+    if (baseline <= 0.0) {
+        std::cerr << "[StereoDepth] Baseline is zero; connect the stereo extrinsics\n";
+        return;
+    }
+
+    const cv::Mat* R = R_in->get();
+    if (!warned_unrectified && R && !R->empty()) {
+        cv::Mat R_d;
+        R->convertTo(R_d, CV_64F);
+        if (cv::norm(R_d, cv::Mat::eye(3, 3, CV_64F)) > 1e-3) {
+            std::cerr << "[StereoDepth] Extrinsic rotation is not identity; images are assumed rectified\n";
+            warned_unrectified = true;
+        }
+    }
+
+    const double fx = K_d.at<double>(0, 0), fy = K_d.at<double>(1, 1);
+    const double cx = K_d.at<double>(0, 2), cy = K_d.at<double>(1, 2);
+
+    auto start = std::chrono::steady_clock::now();
+    cv::Mat depth;
+    std::vector<cv::Point3f> points;
+    if (keypoints) {
+        compute_sparse(*keypoints, fx, fy, cx, cy, baseline, depth, points);
+    } else {
+        compute_dense(fx, fy, cx, cy, baseline, depth, points);
+    }
+    last_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    last_valid = static_cast<int>(points.size());
+
+    depth_out->set(depth, frame_id);
+    points_out->set(points, frame_id);
+}
+
+void stereo_depth_block::compute_sparse(const std::vector<cv::KeyPoint>& keypoints, double fx, double fy,
+                                        double cx, double cy, double baseline, cv::Mat& depth,
+                                        std::vector<cv::Point3f>& points) {
+    query_points.resize(keypoints.size());
+    for (size_t i = 0; i < keypoints.size(); ++i) query_points[i] = keypoints[i].pt;
+
+    sparse_stereo_params params;
+    params.min_disparity = min_disparity;
+    params.num_disparities = num_disparities;
+    params.block_radius = block_size / 2;
+    params.uniqueness = uniqueness;
+    sparse_stereo_match(left_gray, right_gray, query_points, params, sparse_disparities);
+
+    depth = cv::Mat::zeros(static_cast<int>(keypoints.size()), 1, CV_32F);
+    points.reserve(keypoints.size());
+    for (size_t i = 0; i < keypoints.size(); ++i) {
+        const float d = sparse_disparities[i];
+        if (d <= 0.0f) continue;
+        const double z = fx * baseline / d;
+        if (z > max_depth) continue;
+        depth.at<float>(static_cast<int>(i), 0) = static_cast<float>(z);
+        const cv::Point2f& p = query_points[i];
+        points.emplace_back(static_cast<float>((p.x - cx) * z / fx), static_cast<float>((p.y - cy) * z / fy),
+                            static_cast<float>(z));
+    }
+}
+
+void stereo_depth_block::compute_dense(double fx, double fy, double cx, double cy, double baseline,
+                                       cv::Mat& depth, std::vector<cv::Point3f>& points) {
+    if (!sgbm || sgbm_dirty) {
+        const int bs = block_size | 1;
+        const int nd = std::max(16, (num_disparities + 15) / 16 * 16);
+        // The 3-way variant splits the aggregation across threads by rows
+        sgbm = cv::StereoSGBM::create(min_disparity, nd, bs, 8 * bs * bs, 32 * bs * bs, 1, 63, uniqueness,
+                                      100, 2, cv::StereoSGBM::MODE_SGBM_3WAY);
+        sgbm_dirty = false;
+    }
+    sgbm->compute(left_gray, right_gray, disparity);   // CV_16S, 4 fractional bits
+
+    depth.create(disparity.size(), CV_32F);
+    const float numerator = static_cast<float>(fx * baseline * 16.0);
+    const float max_z = max_depth;
+    // SGBM marks unmatched pixels with (min_disparity - 1) * 16, which is a
+    // positive value once min_disparity >= 2; only zero disparity is unusable
+    const int min_valid = std::max(1, min_disparity * 16);
+    cv::parallel_for_(cv::Range(0, disparity.rows), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; ++y) {
+            const short* d = disparity.ptr<short>(y);
+            float* z = depth.ptr<float>(y);
+            for (int x = 0; x < disparity.cols; ++x) {
+                const float value = d[x] >= min_valid ? numerator / d[x] : 0.0f;
+                z[x] = value <= max_z ? value : 0.0f;
+            }
+        }
+    });
+
+    const int stride = std::max(1, point_stride);
+    for (int y = 0; y < depth.rows; y += stride) {
+        const float* z = depth.ptr<float>(y);
+        for (int x = 0; x < depth.cols; x += stride) {
+            if (z[x] <= 0.0f) continue;
+            points.emplace_back(static_cast<float>((x - cx) * z[x] / fx), static_cast<float>((y - cy) * z[x] / fy),
+                                z[x]);
+        }
+    }
+}
+
+void stereo_depth_block::draw_ui() {
+    ImNodes::BeginNode(id);
+    ImNodes::BeginNodeTitleBar();
+    ImGui::TextUnformatted("Stereo Depth");
+    ImNodes::EndNodeTitleBar();
+
+    ImNodes::BeginInputAttribute(id * 100 + 0);
+    ImGui::Text("Left");
+    ImNodes::EndInputAttribute();
+
+    ImNodes::BeginInputAttribute(id * 100 + 1);
+    ImGui::Text("Right");
+    ImNodes::EndInputAttribute();
+
+    ImNodes::BeginInputAttribute(id * 100 + 2);
+    ImGui::Text("K");
+    ImNodes::EndInputAttribute();
+
+    ImNodes::BeginInputAttribute(id * 100 + 3);
+    ImGui::Text("R");
+    ImNodes::EndInputAttribute();
+
+    ImNodes::BeginInputAttribute(id * 100 + 4);
+    ImGui::Text("t");
+    ImNodes::EndInputAttribute();
+
+    ImNodes::BeginInputAttribute(id * 100 + 5);
+    ImGui::Text("Keypoints");
+    ImNodes::EndInputAttribute();
+
+    ImNodes::BeginOutputAttribute(id * 10 + 0);
+    ImGui::Text("Depth");
+    ImNodes::EndOutputAttribute();
+
+    ImNodes::BeginOutputAttribute(id * 10 + 1);
+    ImGui::Text("3D Points");
+    ImNodes::EndOutputAttribute();
+
+    ImGui::Text("Mode:");
+    ImGui::SetNextItemWidth(120);
+    static const char* mode_names[] = { "Sparse (keypoints)", "Dense (SGM)" };
+    ImGui::Combo("##mode", &mode_index, mode_names, IM_ARRAYSIZE(mode_names));
+
+    ImGui::SetNextItemWidth(120);
+    sgbm_dirty |= ImGui::SliderInt("Min disparity", &min_disparity, 0, 64);
+    ImGui::SetNextItemWidth(120);
+    sgbm_dirty |= ImGui::SliderInt("Disparities", &num_disparities, 16, 256);
+    ImGui::SetNextItemWidth(120);
+    if (ImGui::SliderInt("Block size", &block_size, 3, 21)) {
+        block_size |= 1;
+        sgbm_dirty = true;
+    }
+    ImGui::SetNextItemWidth(120);
+    sgbm_dirty |= ImGui::SliderInt("Uniqueness %", &uniqueness, 0, 50);
+    ImGui::SetNextItemWidth(120);
+    ImGui::SliderFloat("Max depth (m)", &max_depth, 5.0f, 200.0f);
+    if (mode_index == 1) {
+        ImGui::SetNextItemWidth(120);
+        ImGui::SliderInt("Point stride", &point_stride, 1, 16);
+    }
+
+    ImGui::Text("Points: %d  (%.2f ms)", last_valid, last_ms);
+
+    ImNodes::EndNode();
+}
+
+std::vector<std::shared_ptr<base_port>> stereo_depth_block::get_input_ports() {
+    return {left_in, right_in, K_in, R_in, t_in, kpts_in};
+}
+
+std::vector<std::shared_ptr<base_port>> stereo_depth_block::get_output_ports() {
+    return {depth_out, points_out};
+}
+
+nlohmann::json stereo_depth_block::serialize() const {
+    nlohmann::json j;
+    j["mode_index"] = mode_index;
+    j["min_disparity"] = min_disparity;
+    j["num_disparities"] = num_disparities;
+    j["block_size"] = block_size;
+    j["uniqueness"] = uniqueness;
+    j["max_depth"] = max_depth;
+    j["point_stride"] = point_stride;
+    return j;
+}
+
+void stereo_depth_block::deserialize(const nlohmann::json& j) {
+    if (j.contains("mode_index")) mode_index = std::clamp(j["mode_index"].get<int>(), 0, 1);
+    if (j.contains("min_disparity")) min_disparity = std::max(0, j["min_disparity"].get<int>());
+    if (j.contains("num_disparities")) num_disparities = std::max(16, j["num_disparities"].get<int>());
+    if (j.contains("block_size")) block_size = std::max(3, j["block_size"].get<int>()) | 1;
+    if (j.contains("uniqueness")) uniqueness = std::max(0, j["uniqueness"].get<int>());
+    if (j.contains("max_depth")) max_depth = j["max_depth"];
+    if (j.contains("point_stride")) point_stride = std::max(1, j["point_stride"].get<int>());
+    sgbm_dirty = true;
+}
@@ -0,0 +1,152 @@
+#include "blocks/synthetic_scene_block.hpp"
+#include <imnodes.h>
+#include <imgui.h>
+#include <algorithm>
+#include <iostream>
+
+synthetic_scene_block::synthetic_scene_block(int id)
+    : block(id, "Synthetic Scene") {
+    output_prev = std::make_shared<data_port<cv::Mat>>("prev");
+    output_curr = std::make_shared<data_port<cv::Mat>>("curr");
+    output_R = std::make_shared<data_port<cv::Mat>>("R_gt");
+    output_t = std::make_shared<data_port<cv::Mat>>("t_gt");
+    output_K = std::make_shared<data_port<cv::Mat>>("K");
+    output_points = std::make_shared<data_port<std::vector<cv::Point3f>>>("Points");
+    rebuild_scene();
+}
+
+void synthetic_scene_block::rebuild_scene() {
+    scene = std::make_unique<synthetic_scene>(config);
+    config = scene->config();  // Pick up clamped values
+    reset_outputs();
+    std::cout << "[Synthetic Scene] " << config.width << "x" << config.height << ", "
+              << config.frame_count << " frames, seed " << config.seed << "\n";
+}
+
+void synthetic_scene_block::reset_outputs() {
+    index = -1;
+    prev_image.release();
+    curr_image.release();
+    output_prev->set(cv::Mat(), -1);
+    output_curr->set(cv::Mat(), -1);
+    output_R->set(cv::Mat(), -1);
+    output_t->set(cv::Mat(), -1);
+    output_K->set(scene->K(), -1);
+    output_points->set({}, -1);
+}
+
+void synthetic_scene_block::load_next_frame() {
+    if (index + 1 >= config.frame_count) return;
+    ++index;
+
+    cv::Mat image;
+    scene->render(index, image);
+    prev_image = curr_image.empty() ? image : curr_image;  // Set prev = curr at first
+    curr_image = image;
+
+    cv::Mat R, t;
+    scene->relative_motion(index, R, t);
+
+    output_prev->set(prev_image, index);
+    output_curr->set(curr_image, index);
+    output_R->set(R, index);
+    output_t->set(t, index);
+    output_K->set(scene->K(), index);
+    if (emit_points) {
+        output_points->set(scene->visible_landmarks(index), index);
+    }
+}
+
+void synthetic_scene_block::process(const std::vector<link_t>&) {
+    if (mode == SequenceMode::AUTO_PLAY) {
+        load_next_frame();
+    } else if (mode == SequenceMode::MANUAL && advance_requested) {
+        load_next_frame();
+        advance_requested = false;
+    }
+}
+
+void synthetic_scene_block::draw_ui() {
+    ImNodes::BeginNode(id);
+    ImNodes::BeginNodeTitleBar();
+    ImGui::TextUnformatted("Synthetic Scene");
+    ImNodes::EndNodeTitleBar();
+
+    ImNodes::BeginOutputAttribute(id * 10 + 0); ImGui::Text("prev"); ImNodes::EndOutputAttribute();
+    ImNodes::BeginOutputAttribute(id * 10 + 1); ImGui::Text("curr"); ImNodes::EndOutputAttribute();
+    ImNodes::BeginOutputAttribute(id * 10 + 2); ImGui::Text("R_gt"); ImNodes::EndOutputAttribute();
+    ImNodes::BeginOutputAttribute(id * 10 + 3); ImGui::Text("t_gt"); ImNodes::EndOutputAttribute();
+    ImNodes::BeginOutputAttribute(id * 10 + 4); ImGui::Text("K"); ImNodes::EndOutputAttribute();
+    ImNodes::BeginOutputAttribute(id * 10 + 5); ImGui::Text("Points"); ImNodes::EndOutputAttribute();
+
+    int seed = static_cast<int>(config.seed);
+    ImGui::SetNextItemWidth(80);
+    ImGui::InputInt("Width", &config.width);
+    ImGui::SetNextItemWidth(80);
+    ImGui::InputInt("Height", &config.height);
+    ImGui::SetNextItemWidth(80);
+    ImGui::InputInt("Frames", &config.frame_count);
+    ImGui::SetNextItemWidth(80);
+    if (ImGui::InputInt("Seed", &seed)) config.seed = static_cast<uint32_t>(seed);
+    if (ImGui::Button("Apply")) rebuild_scene();
+
+    ImGui::Checkbox("3D points", &emit_points);
+
+    const char* modes[] = {"Auto", "Manual"};
+    ImGui::Text("Mode:");
+    ImGui::SetNextItemWidth(80);
+    ImGui::Combo("##mode", (int*)&mode, modes, IM_ARRAYSIZE(modes));
+
+    if (index >= 0) {
+        ImGui::Text("Frame: %d / %d", index, config.frame_count);
+    } else {
+        ImGui::Text("Not started");
+    }
+
+    if (ImGui::Button("Next")) advance_requested = true;
+    ImGui::SameLine();
+    if (ImGui::Button("Reset")) reset_outputs();
+
+    ImNodes::EndNode();
+}
+
+std::vector<std::shared_ptr<base_port>> synthetic_scene_block::get_input_ports() {
+    return {};
+}
+
+std::vector<std::shared_ptr<base_port>> synthetic_scene_block::get_output_ports() {
+    return {output_prev, output_curr, output_R, output_t, output_K, output_points};
+}
+
+nlohmann::json synthetic_scene_block::serialize() const {
+    nlohmann::json j;
+    j["width"] = config.width;
+    j["height"] = config.height;
+    j["frame_count"] = config.frame_count;
+    j["seed"] = config.seed;
+    j["emit_points"] = emit_points;
+    j["mode"] = static_cast<int>(mode);
+    return j;
+}
+
+void synthetic_scene_block::deserialize(const nlohmann::json& j) {
+    if (j.contains("width")) {
+        config.width = j["width"];
+    }
+    if (j.contains("height")) {
+        config.height = j["height"];
+    }
+    if (j.contains("frame_count")) {
+        config.frame_count = j["frame_count"];
+    }
+    if (j.contains("seed")) {
+        config.seed = j["seed"];
+    }
+    if (j.contains("emit_points")) {
+        emit_points = j["emit_points"];
+    }
+    if (j.contains("mode")) {
+        mode = static_cast<SequenceMode>(j["mode"].get<int>());
+    }
+    rebuild_scene();
+}
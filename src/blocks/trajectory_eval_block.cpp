@@ -0,0 +1,160 @@
+#include "blocks/trajectory_eval_block.hpp"
+
+#include <imnodes.h>
+#include <imgui.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+trajectory_eval_block::trajectory_eval_block(int id)
+    : block(id, "Trajectory Eval") {
+    poses_in = std::make_shared<data_port<trajectory>>("Poses");
+}
+
+void trajectory_eval_block::load_ground_truth() {
+    if (ground_truth_path.empty()) return;
+    metrics.load_ground_truth(ground_truth_path);
+    restart();
+}
+
+void trajectory_eval_block::restart() {
+    // Everything is read again from the first pose on the next frame
+    metrics.similarity = alignment_index == 0;
+    metrics.clear_estimates();
+    poses_cursor = trajectory::cursor();
+    evaluated = false;
+    misaligned = 0;
+    warned_misaligned = false;
+    frames_since_report = 0;
+    last_ate = {};
+    last_rpe = {};
+}
+
+void trajectory_eval_block::process(const std::vector<link_t>&) {
+    const trajectory* poses = poses_in->get();
+    if (!poses || poses->empty() || metrics.ground_truth_size() == 0) return;
+
+    int input_frame_id = poses_in->frame_id;
+    if (input_frame_id == last_processed_frame_id) return;
+    // Frame ids going backwards means the source restarted
+    if (input_frame_id < last_processed_frame_id) restart();
+    last_processed_frame_id = input_frame_id;
+
+    auto start = std::chrono::steady_clock::now();
+
+    // A new sequence (or a revision of its very first pose) is read from scratch
+    const size_t first = poses->first_unread(poses_cursor);
+    if (first == 0 && evaluated) {
+        metrics.clear_estimates();
+        misaligned = 0;
+    }
+    // Source frame ids must increase along the trajectory; anything else
+    // means the poses cannot be matched to ground truth frames
+    int prev_source = first > 0 ? poses->frame_id(first - 1) : -1;
+    for (size_t i = first; i < poses->size(); ++i) {
+        const int source = poses->frame_id(i);
+        const bool ordered = source > prev_source;
+        if (source >= 0) prev_source = source;
+        if (source < 0 || !ordered || !metrics.update(static_cast<size_t>(source + frame_offset), (*poses)[i])) {
+            if (first == 0 || i >= poses_cursor.read) ++misaligned;   // Revisions were counted already
+            if (!warned_misaligned) {
+                std::cerr << "[Trajectory Eval] Pose " << i << " (source frame " << source
+                          << ") does not line up with the ground truth (" << metrics.ground_truth_size()
+                          << " poses); check the file and GT offset\n";
+                warned_misaligned = true;
+            }
+        }
+    }
+    poses->advance(poses_cursor);
+    evaluated = true;
+
+    last_ate = metrics.ate();
+    last_rpe = metrics.rpe();
+    update_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    if (report_every > 0 && ++frames_since_report >= report_every) {
+        frames_since_report = 0;
+        std::cout << "[Trajectory Eval] frame " << input_frame_id
+                  << " ATE " << last_ate.rmse << " m (" << last_ate.poses << " poses, scale " << last_ate.scale << ")"
+                  << " RPE " << last_rpe.translation_pct << " % " << last_rpe.rotation_deg_100m << " deg/100m"
+                  << " (" << last_rpe.segments << " segments)";
+        if (misaligned > 0) std::cout << " " << misaligned << " poses not matched to ground truth";
+        std::cout << "\n";
+    }
+}
+
+void trajectory_eval_block::draw_ui() {
+    ImNodes::BeginNode(id);
+
+    ImNodes::BeginNodeTitleBar();
+    ImGui::TextUnformatted("Trajectory Eval");
+    ImNodes::EndNodeTitleBar();
+
+    ImNodes::BeginInputAttribute(id * 100 + 0);
+    ImGui::Text("Poses");
+    ImNodes::EndInputAttribute();
+
+    ImGui::SetNextItemWidth(150);
+    ImGui::InputText("##ground_truth_path", path_buf, IM_ARRAYSIZE(path_buf));
+    if (ImGui::Button("Load ground truth")) {
+        ground_truth_path = std::string(path_buf);
+        load_ground_truth();
+    }
+
+    static const char* alignment_names[] = { "Sim3", "SE3" };
+    ImGui::SetNextItemWidth(100);
+    if (ImGui::Combo("Alignment", &alignment_index, alignment_names, IM_ARRAYSIZE(alignment_names))) {
+        restart();
+    }
+    ImGui::SetNextItemWidth(100);
+    if (ImGui::InputInt("GT offset", &frame_offset)) {
+        frame_offset = std::max(0, frame_offset);
+        restart();
+    }
+    ImGui::SetNextItemWidth(100);
+    if (ImGui::InputInt("Report every", &report_every)) report_every = std::max(0, report_every);
+
+    if (metrics.ground_truth_size() == 0) {
+        ImGui::TextColored(ImVec4(1, 0.5f, 0, 1), "No ground truth loaded");
+    } else {
+        ImGui::Text("Ground truth: %zu poses", metrics.ground_truth_size());
+    }
+    ImGui::Text("ATE: %.3f m over %d poses", last_ate.rmse, last_ate.poses);
+    if (alignment_index == 0) ImGui::Text("Scale: %.4f", last_ate.scale);
+    ImGui::Text("RPE: %.2f %%, %.3f deg/100m", last_rpe.translation_pct, last_rpe.rotation_deg_100m);
+    ImGui::Text("Segments: %d  (%.3f ms)", last_rpe.segments, update_ms);
+    if (misaligned > 0) ImGui::TextColored(ImVec4(1, 0.5f, 0, 1), "%d poses not matched to ground truth", misaligned);
+
+    ImNodes::EndNode();
+}
+
+std::vector<std::shared_ptr<base_port>> trajectory_eval_block::get_input_ports() {
+    return {poses_in};
+}
+
+std::vector<std::shared_ptr<base_port>> trajectory_eval_block::get_output_ports() {
+    return {};
+}
+
+nlohmann::json trajectory_eval_block::serialize() const {
+    nlohmann::json j;
+    j["ground_truth_path"] = ground_truth_path;
+    j["alignment_index"] = alignment_index;
+    j["gt_frame_offset"] = frame_offset;
+    j["report_every"] = report_every;
+    return j;
+}
+
+void trajectory_eval_block::deserialize(const nlohmann::json& j) {
+    if (j.contains("alignment_index")) alignment_index = std::clamp(j["alignment_index"].get<int>(), 0, 1);
+    if (j.contains("gt_frame_offset")) frame_offset = std::max(0, j["gt_frame_offset"].get<int>());
+    if (j.contains("report_every")) report_every = std::max(0, j["report_every"].get<int>());
+    if (j.contains("ground_truth_path")) {
+        ground_truth_path = j["ground_truth_path"];
+        strncpy(path_buf, ground_truth_path.c_str(), sizeof(path_buf));
+        path_buf[sizeof(path_buf) - 1] = '\0';
+        load_ground_truth();
+    }
+    restart();
+}
@@ -0,0 +1,234 @@
+#include "blocks/undistort_block.hpp"
+
+#include <imnodes.h>
+#include <imgui.h>
+#include <opencv2/calib3d.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+undistort_block::undistort_block(int id)
+    : block(id, "Undistort") {
+    input_image = std::make_shared<data_port<cv::Mat>>("image");
+    input_K = std::make_shared<data_port<cv::Mat>>("K");
+    input_D = std::make_shared<data_port<cv::Mat>>("D");
+    input_keypoints = std::make_shared<data_port<std::vector<cv::KeyPoint>>>("keypoints");
+    input_features = std::make_shared<data_port<feature_set>>("features");
+    output_image = std::make_shared<data_port<cv::Mat>>("image");
+    output_keypoints = std::make_shared<data_port<std::vector<cv::KeyPoint>>>("keypoints");
+    output_features = std::make_shared<data_port<feature_set>>("features");
+}
+
+bool undistort_block::update_calibration() {
+    if (!input_K->data || input_K->data->size() != cv::Size(3, 3)) return false;
+
+    // Intrinsics republishes K and D every frame, so compare values rather
+    // than frame ids
+    cv::Mat new_K, new_D;
+    input_K->data->convertTo(new_K, CV_64F);
+    if (input_D->data && !input_D->data->empty()) input_D->data->reshape(1, 1).convertTo(new_D, CV_64F);
+
+    const bool same_K = !K.empty() && cv::norm(new_K, K, cv::NORM_INF) == 0.0;
+    const bool same_D = new_D.size() == D.size() && (D.empty() || cv::norm(new_D, D, cv::NORM_INF) == 0.0);
+    if (same_K && same_D) return true;
+
+    K = new_K;
+    D = new_D;
+    has_distortion = !D.empty() && cv::countNonZero(D) > 0;
+    map1.release();
+    map2.release();
+    map_size = cv::Size();
+
+    // Redo the current frame with the new calibration
+    last_image_frame_id = -1;
+    last_keypoints_frame_id = -1;
+    last_features_frame_id = -1;
+    return true;
+}
+
+void undistort_block::undistort_image(int frame_id) {
+    const cv::Mat& image = *input_image->data;
+    if (!has_distortion) {
+        output_image->set(image, frame_id);
+        return;
+    }
+
+    if (image.size() != map_size) {
+        // Fixed-point maps: remap's integer fast path, and half the memory
+        // traffic of CV_32FC1 pairs
+        cv::initUndistortRectifyMap(K, D, cv::noArray(), K, image.size(), CV_16SC2, map1, map2);
+        map_size = image.size();
+        std::cout << "[Undistort] Built " << map_size.width << "x" << map_size.height << " remap tables\n";
+    }
+
+    // A fresh buffer per frame: downstream blocks may still hold the last one
+    cv::Mat out;
+    cv::remap(image, out, map1, map2, interpolation_index == 0 ? cv::INTER_LINEAR : cv::INTER_NEAREST,
+              cv::BORDER_CONSTANT);
+    output_image->set(out, frame_id);
+}
+
+void undistort_block::undistort_points() {
+    undistorted.clear();
+    if (points.empty()) return;
+    // P = K keeps the result in pixels of the same camera
+    cv::undistortPoints(points, undistorted, K, D, cv::noArray(), K);
+}
+
+void undistort_block::undistort_keypoints(int frame_id) {
+    const std::vector<cv::KeyPoint>& keypoints = *input_keypoints->data;
+    if (!has_distortion) {
+        output_keypoints->set(keypoints, frame_id);
+        return;
+    }
+
+    points.clear();
+    for (const auto& kp : keypoints) points.push_back(kp.pt);
+    undistort_points();
+
+    std::vector<cv::KeyPoint>& out = *output_keypoints->data;
+    out = keypoints;
+    for (size_t i = 0; i < out.size(); ++i) out[i].pt = undistorted[i];
+    output_keypoints->frame_id = frame_id;
+    last_points = static_cast<int>(out.size());
+}
+
+void undistort_block::undistort_features(int frame_id) {
+    const feature_set& features = *input_features->data;
+    if (!has_distortion) {
+        output_features->set(features, frame_id);
+        return;
+    }
+
+    points.clear();
+    for (size_t i = 0; i < features.count(); ++i) points.push_back(features.pt(i));
+    undistort_points();
+
+    feature_set& out = *output_features->data;
+    out = features;  // Descriptors are shared, only x/y change
+    for (size_t i = 0; i < out.count(); ++i) {
+        out.x[i] = undistorted[i].x;
+        out.y[i] = undistorted[i].y;
+    }
+    output_features->frame_id = frame_id;
+    last_points = static_cast<int>(out.count());
+}
+
+void undistort_block::process(const std::vector<link_t>&) {
+    if (!update_calibration()) return;
+
+    auto start = std::chrono::steady_clock::now();
+    bool worked = false;
+
+    if (mode_index == DENSE) {
+        if (input_image->data && !input_image->data->empty() && input_image->frame_id != last_image_frame_id) {
+            last_image_frame_id = input_image->frame_id;
+            undistort_image(last_image_frame_id);
+            worked = true;
+        }
+    } else {
+        if (input_keypoints->frame_id >= 0 && input_keypoints->frame_id != last_keypoints_frame_id) {
+            last_keypoints_frame_id = input_keypoints->frame_id;
+            undistort_keypoints(last_keypoints_frame_id);
+            worked = true;
+        }
+        if (!input_features->data->empty() && input_features->frame_id != last_features_frame_id) {
+            last_features_frame_id = input_features->frame_id;
+            undistort_features(last_features_frame_id);
+            worked = true;
+        }
+    }
+
+    if (worked) {
+        last_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+void undistort_block::draw_ui() {
+    ImNodes::BeginNode(id);
+
+    ImNodes::BeginNodeTitleBar();
+    ImGui::TextUnformatted("Undistort");
+    ImNodes::EndNodeTitleBar();
+
+    ImNodes::BeginInputAttribute(id * 100 + 0);
+    ImGui::Text("Img");
+    ImGui::Dummy(ImVec2(1, 1));
+    ImNodes::EndInputAttribute();
+
+    ImNodes::BeginInputAttribute(id * 100 + 1);
+    ImGui::Text("K");
+    ImNodes::EndInputAttribute();
+
+    ImNodes::BeginInputAttribute(id * 100 + 2);
+    ImGui::Text("D");
+    ImNodes::EndInputAttribute();
+
+    ImNodes::BeginInputAttribute(id * 100 + 3);
+    ImGui::Text("Kpts");
+    ImNodes::EndInputAttribute();
+
+    ImNodes::BeginInputAttribute(id * 100 + 4);
+    ImGui::Text("Feats");
+    ImNodes::EndInputAttribute();
+
+    ImNodes::BeginOutputAttribute(id * 10 + 0);
+    ImGui::Text("Img");
+    ImNodes::EndOutputAttribute();
+
+    ImNodes::BeginOutputAttribute(id * 10 + 1);
+    ImGui::Text("Kpts");
+    ImNodes::EndOutputAttribute();
+
+    ImNodes::BeginOutputAttribute(id * 10 + 2);
+    ImGui::Text("Feats");
+    ImNodes::EndOutputAttribute();
+
+    static const char* mode_names[] = { "Dense", "Sparse" };
+    ImGui::SetNextItemWidth(100);
+    if (ImGui::Combo("Mode", &mode_index, mode_names, IM_ARRAYSIZE(mode_names))) {
+        last_image_frame_id = -1;
+        last_keypoints_frame_id = -1;
+        last_features_frame_id = -1;
+    }
+    if (mode_index == DENSE) {
+        static const char* interpolation_names[] = { "Linear", "Nearest" };
+        ImGui::SetNextItemWidth(100);
+        if (ImGui::Combo("Interp", &interpolation_index, interpolation_names, IM_ARRAYSIZE(interpolation_names))) {
+            last_image_frame_id = -1;
+        }
+    }
+
+    if (K.empty()) {
+        ImGui::TextColored(ImVec4(1, 0.5f, 0, 1), "No K connected");
+    } else if (!has_distortion) {
+        ImGui::Text("No distortion, passing through");
+    } else if (mode_index == DENSE) {
+        ImGui::Text("Maps %dx%d, %.2f ms", map_size.width, map_size.height, last_ms);
+    } else {
+        ImGui::Text("%d points, %.3f ms", last_points, last_ms);
+    }
+
+    ImNodes::EndNode();
+}
+
+std::vector<std::shared_ptr<base_port>> undistort_block::get_input_ports() {
+    return {input_image, input_K, input_D, input_keypoints, input_features};
+}
+
+std::vector<std::shared_ptr<base_port>> undistort_block::get_output_ports() {
+    return {output_image, output_keypoints, output_features};
+}
+
+nlohmann::json undistort_block::serialize() const {
+    nlohmann::json j;
+    j["mode_index"] = mode_index;
+    j["interpolation_index"] = interpolation_index;
+    return j;
+}
+
+void undistort_block::deserialize(const nlohmann::json& j) {
+    if (j.contains("mode_index")) mode_index = std::clamp(j["mode_index"].get<int>(), 0, 1);
+    if (j.contains("interpolation_index")) interpolation_index = std::clamp(j["interpolation_index"].get<int>(), 0, 1);
+}
@@ -0,0 +1,262 @@
+#include "blocks/video_source_block.hpp"
+#include <imnodes.h>
+#include <imgui.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <cstring>  // For strncpy
+
+video_source_block::video_source_block(int id, const std::string& video_path)
+    : block(id, "Video Source"), path(video_path) {
+    output_prev = std::make_shared<data_port<cv::Mat>>("prev");
+    output_curr = std::make_shared<data_port<cv::Mat>>("curr");
+    strncpy(path_buf, path.c_str(), sizeof(path_buf));
+    path_buf[sizeof(path_buf) - 1] = '\0';
+    // Not opened here: deserialize usually follows with the real path and
+    // start frame, and opening the default first would decode for nothing.
+}
+
+video_source_block::~video_source_block() {
+    stop_decoder();
+}
+
+void video_source_block::start_decoder() {
+    stop_decoder();
+    decoder_pending = false;
+    if (path.empty()) return;
+
+    stop_requested = false;
+    end_of_stream = false;
+    total_frames = 0;
+    decimation_shared = std::max(1, decimation);
+    {
+        std::lock_guard<std::mutex> lock(seek_mutex);
+        pending_seek = start_frame;
+    }
+    queue.set_capacity(static_cast<size_t>(std::max(1, queue_capacity)));
+    queue.reopen();
+    decoder = std::thread(&video_source_block::decode_loop, this);
+}
+
+void video_source_block::stop_decoder() {
+    if (!decoder.joinable()) return;
+    stop_requested = true;
+    queue.close();  // Unblocks a decoder waiting on a full queue
+    decoder.join();
+}
+
+void video_source_block::seek(int frame_index) {
+    if (decoder_pending) start_decoder();  // Otherwise opening would reset to start_frame
+    {
+        std::lock_guard<std::mutex> lock(seek_mutex);
+        pending_seek = std::max(0, frame_index);
+        ++generation;   // Frames already in flight belong to the old position
+    }
+    queue.clear();
+    end_of_stream = false;
+}
+
+void video_source_block::decode_loop() {
+    cv::VideoCapture cap(path);
+    if (!cap.isOpened()) {
+        std::cerr << "[Video Source] Failed to open: " << path << std::endl;
+        end_of_stream = true;
+        return;
+    }
+    total_frames = static_cast<int>(cap.get(cv::CAP_PROP_FRAME_COUNT));
+    std::cout << "[Video Source] Opened " << path << " (" << total_frames << " frames)\n";
+
+    int next_index = 0;
+    int seek_origin = 0;
+    int frame_generation = 0;
+
+    while (!stop_requested) {
+        int target = -1;
+        {
+            std::lock_guard<std::mutex> lock(seek_mutex);
+            std::swap(target, pending_seek);
+            if (target >= 0) frame_generation = generation.load();
+        }
+        if (target >= 0) {
+            if (target != next_index && !cap.set(cv::CAP_PROP_POS_FRAMES, target)) {
+                std::cerr << "[Video Source] Seek to frame " << target << " failed\n";
+            }
+            next_index = target;
+            seek_origin = target;
+            end_of_stream = false;
+        }
+
+        if (end_of_stream) {
+            // Idle until a seek or shutdown; nothing left to decode.
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            continue;
+        }
+
+        // grab() demuxes and decodes; retrieve() does the color conversion and
+        // copy, so decimated frames only pay for the former.
+        if (!cap.grab()) {
+            end_of_stream = true;
+            std::cout << "[Video Source] End of stream at frame " << next_index << "\n";
+            continue;
+        }
+        int index = next_index++;
+        if ((index - seek_origin) % decimation_shared.load() != 0) continue;
+
+        decoded_frame frame;
+        frame.source_index = index;
+        frame.generation = frame_generation;
+        if (!cap.retrieve(frame.image) || frame.image.empty()) {
+            std::cerr << "[Video Source] Failed to decode frame " << index << "\n";
+            continue;
+        }
+        if (!queue.push(std::move(frame))) break;  // Queue closed
+    }
+}
+
+bool video_source_block::emit_next_frame() {
+    decoded_frame frame;
+    const int current_generation = generation.load();
+    while (queue.try_pop(frame)) {
+        if (frame.generation != current_generation) continue;  // Stale after a seek
+
+        if (!has_started) {
+            curr_image = frame.image;
+            prev_image = curr_image;  // Set prev = curr at first
+            has_started = true;
+        } else {
+            prev_image = curr_image;
+            curr_image = frame.image;
+        }
+        current_source_index = frame.source_index;
+        ++frame_id;
+
+        output_prev->set(prev_image, frame_id);
+        output_curr->set(curr_image, frame_id);
+        return true;
+    }
+    return false;
+}
+
+void video_source_block::reset_outputs() {
+    has_started = false;
+    prev_image.release();
+    curr_image.release();
+    output_prev->set(cv::Mat(), -1);
+    output_curr->set(cv::Mat(), -1);
+}
+
+void video_source_block::process(const std::vector<link_t>&) {
+    if (decoder_pending) start_decoder();
+
+    if (mode == SequenceMode::AUTO_PLAY) {
+        emit_next_frame();
+    } else if (mode == SequenceMode::MANUAL && advance_requested) {
+        // Keep the request pending until the decoder has a frame ready
+        if (emit_next_frame()) advance_requested = false;
+    }
+}
+
+void video_source_block::draw_ui() {
+    ImNodes::BeginNode(id);
+    ImNodes::BeginNodeTitleBar();
+    ImGui::TextUnformatted("Video Source");
+    ImNodes::EndNodeTitleBar();
+
+    ImNodes::BeginOutputAttribute(id * 10 + 0); ImGui::Text("prev"); ImNodes::EndOutputAttribute();
+    ImNodes::BeginOutputAttribute(id * 10 + 1); ImGui::Text("curr"); ImNodes::EndOutputAttribute();
+
+    ImGui::Text("File / pattern:");
+    ImGui::SetNextItemWidth(160);
+    ImGui::InputText("##video_path", path_buf, IM_ARRAYSIZE(path_buf));
+    if (ImGui::Button("Open")) {
+        path = std::string(path_buf);
+        reset_outputs();
+        start_decoder();
+    }
+
+    const char* modes[] = {"Auto", "Manual"};
+    ImGui::Text("Mode:");
+    ImGui::SetNextItemWidth(80);
+    ImGui::Combo("##mode", (int*)&mode, modes, IM_ARRAYSIZE(modes));
+
+    ImGui::Text("Skip:");
+    ImGui::SetNextItemWidth(80);
+    if (ImGui::InputInt("##decimation", &decimation)) {
+        decimation = std::max(1, decimation);
+        decimation_shared = decimation;
+    }
+
+    ImGui::Text("Queue:");
+    ImGui::SetNextItemWidth(80);
+    if (ImGui::InputInt("##queue", &queue_capacity)) {
+        queue_capacity = std::clamp(queue_capacity, 1, 256);
+        queue.set_capacity(static_cast<size_t>(queue_capacity));
+    }
+
+    if (current_source_index >= 0) {
+        ImGui::Text("Frame: %d / %d", current_source_index, total_frames.load());
+    } else {
+        ImGui::Text("Not started");
+    }
+    ImGui::Text("Buffered: %d%s", static_cast<int>(queue.size()), end_of_stream ? " (EOS)" : "");
+
+    ImGui::SetNextItemWidth(80);
+    ImGui::InputInt("##seek", &seek_target);
+    ImGui::SameLine();
+    if (ImGui::Button("Seek")) {
+        seek(seek_target);
+        reset_outputs();
+    }
+
+    if (ImGui::Button("Next")) advance_requested = true;
+    ImGui::SameLine();
+    if (ImGui::Button("Reset")) {
+        seek(start_frame);
+        reset_outputs();
+        std::cout << "[Video Source] Reset to frame " << start_frame << "\n";
+    }
+
+    ImNodes::EndNode();
+}
+
+std::vector<std::shared_ptr<base_port>> video_source_block::get_input_ports() {
+    return {};
+}
+
+std::vector<std::shared_ptr<base_port>> video_source_block::get_output_ports() {
+    return {output_prev, output_curr};
+}
+
+nlohmann::json video_source_block::serialize() const {
+    nlohmann::json j;
+    j["path"] = path;
+    j["mode"] = static_cast<int>(mode);
+    j["decimation"] = decimation;
+    j["queue_capacity"] = queue_capacity;
+    j["start_frame"] = start_frame;
+    return j;
+}
+
+void video_source_block::deserialize(const nlohmann::json& j) {
+    if (j.contains("path")) {
+        path = j["path"];
+        strncpy(path_buf, path.c_str(), sizeof(path_buf));
+        path_buf[sizeof(path_buf) - 1] = '\0';
+    }
+    if (j.contains("mode")) {
+        mode = static_cast<SequenceMode>(j["mode"].get<int>());
+    }
+    if (j.contains("decimation")) {
+        decimation = std::max(1, j["decimation"].get<int>());
+    }
+    if (j.contains("queue_capacity")) {
+        queue_capacity = std::clamp(j["queue_capacity"].get<int>(), 1, 256);
+    }
+    if (j.contains("start_frame")) {
+        start_frame = std::max(0, j["start_frame"].get<int>());
+        seek_target = start_frame;
+    }
+    stop_decoder();
+    reset_outputs();
+    decoder_pending = true;
+}
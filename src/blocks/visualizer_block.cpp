@@ -1,12 +1,13 @@
 #include "blocks/visualizer_block.hpp"
 #include <imnodes.h>
 #include <imgui.h>
-#include <fstream>   // For file writing
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
 visualizer_block::visualizer_block(int id)
     : block(id, "Visualizer"), last_frame_id(-1) {  // Track last processed frame
-    poses_in = std::make_shared<data_port<std::vector<cv::Mat>>>("Poses");
+    poses_in = std::make_shared<data_port<trajectory>>("Poses");
     points3d_in = std::make_shared<data_port<std::vector<cv::Point3f>>>("3D Points");
     // Removed PCL viewer initialization
 }
@@ -28,31 +29,28 @@ void visualizer_block::process(const std::vector<link_t>&) {
     }
 
     if (poses_ptr && !poses_ptr->empty()) {
-        // Save poses to file for validation
-        std::ofstream ofs("poses_validation.txt");
-        if (ofs.is_open()) {
-            for (size_t i = 0; i < poses_ptr->size(); ++i) {
-                const cv::Mat& pose = (*poses_ptr)[i];
-                if (pose.empty()) continue;
-                ofs << "Pose " << i << ":\n";
-                for (int r = 0; r < pose.rows; ++r) {
-                    for (int c = 0; c < pose.cols; ++c) {
-                        ofs << pose.at<double>(r, c) << " ";
-                    }
-                    ofs << "\n";
-                }
-                ofs << "\n";
-            }
-            ofs.close();
-            std::cout << "[Visualizer] Saved poses to poses_validation.txt for frame " << current_frame_id << "\n";
-        } else {
-            std::cerr << "[Visualizer] Failed to open poses_validation.txt for writing\n";
-        }
+        // Save poses to file for validation; only what changed since the
+        // last frame is queued
+        if (!writer.is_open() && !open_writer()) return;
+        const size_t first = poses_ptr->first_unread(poses_cursor);
+        writer.write(*poses_ptr, first);
+        poses_ptr->advance(poses_cursor);
     } else {
         std::cout << "[Visualizer] No poses available\n";
     }
 }
 
+bool visualizer_block::open_writer() {
+    trajectory_writer::options opts;
+    opts.fmt = static_cast<trajectory_writer::format>(format_index);
+    opts.fsync_every = fsync_every;
+    // A new file starts from the first pose
+    poses_cursor = trajectory::cursor();
+    if (!writer.open(output_path, opts)) return false;
+    std::cout << "[Visualizer] Writing poses to " << output_path << "\n";
+    return true;
+}
+
 void visualizer_block::draw_ui() {
     ImNodes::BeginNode(id);
     ImNodes::BeginNodeTitleBar();
@@ -67,11 +65,31 @@ void visualizer_block::draw_ui() {
     ImGui::Text("Points");
     ImNodes::EndInputAttribute();
 
+    // Output settings take effect on the next frame, with a new file
+    bool reopen = false;
+    ImGui::SetNextItemWidth(150);
+    if (ImGui::InputText("##output_path", path_buf, IM_ARRAYSIZE(path_buf),
+                         ImGuiInputTextFlags_EnterReturnsTrue)) {
+        output_path = std::string(path_buf);
+        reopen = true;
+    }
+    static const char* format_names[] = { "KITTI", "Binary" };
+    ImGui::SetNextItemWidth(100);
+    reopen |= ImGui::Combo("Format", &format_index, format_names, IM_ARRAYSIZE(format_names));
+    ImGui::SetNextItemWidth(100);
+    reopen |= ImGui::InputInt("Fsync every", &fsync_every);
+    fsync_every = std::max(0, fsync_every);
+    if (reopen) writer.close();
+
+    ImGui::Text("Poses: %zu (%.1f KB)", writer.poses_written(), writer.bytes_written() / 1024.0);
+    ImGui::Text("Backlog: %zu, fsyncs: %d", writer.backlog(), writer.fsyncs());
+    if (writer.failed()) ImGui::TextColored(ImVec4(1, 0.3f, 0.3f, 1), "Write failed");
+
     ImNodes::EndNode();
 }
 
 std::vector<std::shared_ptr<base_port>> visualizer_block::get_input_ports() {
-    return {poses_in};
+    return {poses_in, points3d_in};
 }
 
 std::vector<std::shared_ptr<base_port>> visualizer_block::get_output_ports() {
@@ -80,11 +98,19 @@ std::vector<std::shared_ptr<base_port>> visualizer_block::get_output_ports() {
 
 nlohmann::json visualizer_block::serialize() const {
     nlohmann::json j;
-    // Visualizer doesn't have configurable parameters currently
+    j["output_path"] = output_path;
+    j["format_index"] = format_index;
+    j["fsync_every"] = fsync_every;
     return j;
 }
 
 void visualizer_block::deserialize(const nlohmann::json& j) {
-    // Visualizer doesn't have configurable parameters currently
-    (void)j; // Suppress unused parameter warning
+    if (j.contains("format_index")) format_index = std::clamp(j["format_index"].get<int>(), 0, 1);
+    if (j.contains("fsync_every")) fsync_every = std::max(0, j["fsync_every"].get<int>());
+    if (j.contains("output_path")) {
+        output_path = j["output_path"];
+        strncpy(path_buf, output_path.c_str(), sizeof(path_buf));
+        path_buf[sizeof(path_buf) - 1] = '\0';
+    }
+    writer.close();
 }
@@ -12,12 +12,29 @@
 #include "blocks/visualizer_block.hpp"
 #include "blocks/homography_block.hpp"
 #include "blocks/filter_block.hpp"
+#include "blocks/video_source_block.hpp"
+#include "blocks/synthetic_scene_block.hpp"
+#include "blocks/pyramid_block.hpp"
+#include "blocks/feature_tracker_block.hpp"
+#include "blocks/place_recognition_block.hpp"
+#include "blocks/stereo_depth_block.hpp"
+#include "blocks/local_ba_block.hpp"
+#include "blocks/trajectory_eval_block.hpp"
+#include "blocks/undistort_block.hpp"
 
 #include "core/data_port.hpp"
+#include "core/feature_set.hpp"
+#include "core/image_pyramid.hpp"
+#include "core/loop_candidate.hpp"
+#include "core/match_selection.hpp"
+#include "core/se3.hpp"
+#include "core/trajectory.hpp"
 #include "opencv2/core.hpp"
 #include <imnodes.h>
 
 #include <algorithm>
+#include <chrono>
+#include <climits>
 #include <iostream>
 #include <fstream>
 #include <filesystem>
@@ -25,6 +42,24 @@
 #include <nlohmann/json.hpp>
 using json = nlohmann::json;
 
+namespace {
+
+// For ports whose buffer a match_selection may hold as its parent. A shared
+// buffer is left as it is and the port gets a new one; the source's frame id
+// not having moved means there is nothing new to copy.
+template <typename T>
+void copy_shared(data_port<T>& to, const data_port<T>& from) {
+    if (to.data.use_count() > 1) {
+        if (to.frame_id == from.frame_id) return;
+        to.data = std::make_shared<T>(*from.data);
+    } else {
+        *to.data = *from.data;
+    }
+    to.frame_id = from.frame_id;
+}
+
+} // namespace
+
 void block_graph::add_block(std::shared_ptr<block> new_block) {
     std::cout << "[block_graph] Adding block ID " << new_block->id << " of type " << new_block->name << "\n";
     blocks_.push_back(new_block);
@@ -117,6 +152,8 @@ void block_graph::process_all() {
     for (auto& b : blocks_)
         b->process(links_);
 
+    collect_releases();
+
     for (const auto& link : links_) {
         int from_node_id = link.start_attr / 10;
         int to_node_id   = link.end_attr / 100;
@@ -159,8 +196,7 @@ void block_graph::process_all() {
         // Copy vector<KeyPoint>
         if (auto from_kp = std::dynamic_pointer_cast<data_port<std::vector<cv::KeyPoint>>>(from)) {
             if (auto to_kp = std::dynamic_pointer_cast<data_port<std::vector<cv::KeyPoint>>>(to)) {
-                *to_kp->data = *from_kp->data;
-                to_kp->frame_id = from_kp->frame_id;
+                copy_shared(*to_kp, *from_kp);
                 // std::cout << "[block_graph] Copied keypoints from block " << from_node_id << " to block " << to_node_id << "\n";
                 continue;
             }
@@ -169,8 +205,7 @@ void block_graph::process_all() {
         // Copy vector<DMatch>
         if (auto from_match = std::dynamic_pointer_cast<data_port<std::vector<cv::DMatch>>>(from)) {
             if (auto to_match = std::dynamic_pointer_cast<data_port<std::vector<cv::DMatch>>>(to)) {
-                *to_match->data = *from_match->data;
-                to_match->frame_id = from_match->frame_id;
+                copy_shared(*to_match, *from_match);
                 // std::cout << "[block_graph] Copied matches from block " << from_node_id << " to block " << to_node_id << "\n";
                 continue;
             }
@@ -186,8 +221,134 @@ void block_graph::process_all() {
             }
         }
 
+        // Copy vector<cv::Point3f>
+        if (auto from_pts = std::dynamic_pointer_cast<data_port<std::vector<cv::Point3f>>>(from)) {
+            if (auto to_pts = std::dynamic_pointer_cast<data_port<std::vector<cv::Point3f>>>(to)) {
+                *to_pts->data = *from_pts->data;
+                to_pts->frame_id = from_pts->frame_id;
+                continue;
+            }
+        }
+
+        // Copy image_pyramid (levels share one buffer, so this is shallow)
+        if (auto from_pyr = std::dynamic_pointer_cast<data_port<image_pyramid>>(from)) {
+            if (auto to_pyr = std::dynamic_pointer_cast<data_port<image_pyramid>>(to)) {
+                if (!from_pyr->data->empty()) {
+                    *to_pyr->data = *from_pyr->data;
+                    to_pyr->frame_id = from_pyr->frame_id;
+                }
+                continue;
+            }
+        }
+
+        // Copy int (counters such as inlier feedback)
+        if (auto from_int = std::dynamic_pointer_cast<data_port<int>>(from)) {
+            if (auto to_int = std::dynamic_pointer_cast<data_port<int>>(to)) {
+                *to_int->data = *from_int->data;
+                to_int->frame_id = from_int->frame_id;
+                continue;
+            }
+        }
+
+        // Copy feature_set (deep, so only when a new frame arrives)
+        if (auto from_fs = std::dynamic_pointer_cast<data_port<feature_set>>(from)) {
+            if (auto to_fs = std::dynamic_pointer_cast<data_port<feature_set>>(to)) {
+                if (to_fs->frame_id != from_fs->frame_id) copy_shared(*to_fs, *from_fs);
+                continue;
+            }
+        }
+
+        // Copy vector<loop_candidate>
+        if (auto from_lc = std::dynamic_pointer_cast<data_port<std::vector<loop_candidate>>>(from)) {
+            if (auto to_lc = std::dynamic_pointer_cast<data_port<std::vector<loop_candidate>>>(to)) {
+                *to_lc->data = *from_lc->data;
+                to_lc->frame_id = from_lc->frame_id;
+                continue;
+            }
+        }
+
+        // Copy se3
+        if (auto from_pose = std::dynamic_pointer_cast<data_port<se3>>(from)) {
+            if (auto to_pose = std::dynamic_pointer_cast<data_port<se3>>(to)) {
+                *to_pose->data = *from_pose->data;
+                to_pose->frame_id = from_pose->frame_id;
+                continue;
+            }
+        }
+
+        // Copy trajectory (a handle, the poses themselves are shared)
+        if (auto from_traj = std::dynamic_pointer_cast<data_port<trajectory>>(from)) {
+            if (auto to_traj = std::dynamic_pointer_cast<data_port<trajectory>>(to)) {
+                *to_traj->data = *from_traj->data;
+                to_traj->frame_id = from_traj->frame_id;
+                continue;
+            }
+        }
+
+        // Copy match_selection (parents are shared, only the indices are copied)
+        if (auto from_sel = std::dynamic_pointer_cast<data_port<match_selection>>(from)) {
+            if (auto to_sel = std::dynamic_pointer_cast<data_port<match_selection>>(to)) {
+                if (to_sel->frame_id != from_sel->frame_id) {
+                    *to_sel->data = *from_sel->data;
+                    to_sel->frame_id = from_sel->frame_id;
+                }
+                continue;
+            }
+        }
+
         std::cerr << "[block_graph] Unsupported port type or mismatched types in link from " << from_node_id << " to " << to_node_id << "\n";
     }
+
+    update_deadlines();
+}
+
+void block_graph::collect_releases() {
+    for (auto& b : blocks_) {
+        auto* source = dynamic_cast<timed_source*>(b.get());
+        if (!source) continue;
+
+        frame_release release;
+        while (source->poll_release(release)) {
+            deadline_monitor_.on_release(release);
+        }
+    }
+}
+
+void block_graph::update_deadlines() {
+    if (deadline_monitor_.pending() == 0) return;
+
+    // A frame is done once every linked input of every sink (block without
+    // outputs) carries its frame_id or a newer one.
+    int completed_frame_id = INT_MAX;
+    bool has_sink = false;
+    for (auto& b : blocks_) {
+        if (!b->get_output_ports().empty()) continue;
+
+        auto inputs = b->get_input_ports();
+        for (const auto& link : links_) {
+            if (link.end_attr / 100 != b->id) continue;
+            int port_index = link.end_attr % 100;
+            if (port_index >= inputs.size()) continue;
+
+            completed_frame_id = std::min(completed_frame_id, inputs[port_index]->frame_id);
+            has_sink = true;
+        }
+    }
+
+    if (has_sink) {
+        deadline_monitor_.on_progress(completed_frame_id, std::chrono::steady_clock::now());
+    } else {
+        // No sink linked: nothing will ever complete these frames
+        deadline_monitor_.discard_pending();
+    }
+}
+
+const deadline_monitor& block_graph::get_deadline_monitor() const {
+    return deadline_monitor_;
+}
+
+void block_graph::reset_deadline_monitor() {
+    deadline_monitor_.reset();
 }
 
 std::shared_ptr<block> block_graph::create_block_by_type(const std::string& type, int id) {
@@ -230,6 +391,34 @@ std::shared_ptr<block> block_graph::create_block_by_type(const std::string& type
     if (type == "Filter Block") {
         return std::make_shared<filter_block>(id);
     }
+    if (type == "Video Source") {
+        std::string path = "/home/ismo/Downloads/data_odometry_gray/dataset/sequences/00/image_0/%06d.png";
+        return std::make_shared<video_source_block>(id, path);
+    }
+    if (type == "Synthetic Scene") {
+        return std::make_shared<synthetic_scene_block>(id);
+    }
+    if (type == "Pyramid") {
+        return std::make_shared<pyramid_block>(id);
+    }
+    if (type == "Feature Tracker") {
+        return std::make_shared<feature_tracker_block>(id);
+    }
+    if (type == "Place Recognition") {
+        return std::make_shared<place_recognition_block>(id);
+    }
+    if (type == "Stereo Depth") {
+        return std::make_shared<stereo_depth_block>(id);
+    }
+    if (type == "Local BA") {
+        return std::make_shared<local_ba_block>(id);
+    }
+    if (type == "Trajectory Eval") {
+        return std::make_shared<trajectory_eval_block>(id);
+    }
+    if (type == "Undistort") {
+        return std::make_shared<undistort_block>(id);
+    }
 
     std::cerr << "[block_graph] No factory for block type: " << type << std::endl;
     return nullptr;
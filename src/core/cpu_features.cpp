@@ -0,0 +1,32 @@
+#include "core/cpu_features.hpp"
+
+namespace {
+
+cpu_features query_cpu_features() {
+    cpu_features f;
+#if INSIGHT_X86_SIMD
+    __builtin_cpu_init();
+    f.popcnt = __builtin_cpu_supports("popcnt");
+    f.sse42 = __builtin_cpu_supports("sse4.2");
+    f.avx2 = __builtin_cpu_supports("avx2");
+    f.avx512bw = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+    f.avx512_vpopcntdq = f.avx512bw && __builtin_cpu_supports("avx512vpopcntdq");
+#endif
+    return f;
+}
+
+}  // namespace
+
+const cpu_features& get_cpu_features() {
+    static const cpu_features features = query_cpu_features();
+    return features;
+}
+
+const char* simd_level_name(simd_level level) {
+    switch (level) {
+        case simd_level::AVX512: return "AVX-512";
+        case simd_level::AVX2:   return "AVX2";
+        case simd_level::SSE42:  return "SSE4.2";
+        default:                 return "scalar";
+    }
+}
@@ -0,0 +1,44 @@
+#include "core/deadline_monitor.hpp"
+#include <algorithm>
+#include <iostream>
+
+void deadline_monitor::reset() {
+    pending_.clear();
+    stats_ = stats{};
+    latency_sum_ms_ = 0.0;
+    last_released_id_ = -1;
+}
+
+void deadline_monitor::on_release(const frame_release& r) {
+    if (r.frame_id <= last_released_id_) {
+        // Source was reset or rewound, start a fresh measurement
+        std::cout << "[deadline_monitor] Frame ids restarted at " << r.frame_id << ", resetting stats\n";
+        reset();
+    }
+    last_released_id_ = r.frame_id;
+    pending_.push_back(r);
+    if (pending_.size() > kMaxPending) pending_.pop_front();
+}
+
+void deadline_monitor::on_progress(int completed_frame_id, std::chrono::steady_clock::time_point now) {
+    while (!pending_.empty() && pending_.front().frame_id <= completed_frame_id) {
+        const frame_release& r = pending_.front();
+        double latency_ms = std::chrono::duration<double, std::milli>(now - r.release).count();
+        double slack_ms = std::chrono::duration<double, std::milli>(r.deadline - now).count();
+
+        stats_.completed++;
+        if (slack_ms < 0.0) stats_.missed++;
+        stats_.last_latency_ms = latency_ms;
+        stats_.last_slack_ms = slack_ms;
+        stats_.max_latency_ms = std::max(stats_.max_latency_ms, latency_ms);
+        latency_sum_ms_ += latency_ms;
+        stats_.mean_latency_ms = latency_sum_ms_ / stats_.completed;
+
+        if (stats_.completed % 100 == 0) {
+            std::cout << "[deadline_monitor] " << stats_.completed << " frames, "
+                      << stats_.missed << " missed deadlines, latency mean "
+                      << stats_.mean_latency_ms << " ms, max " << stats_.max_latency_ms << " ms\n";
+        }
+        pending_.pop_front();
+    }
+}
@@ -0,0 +1,30 @@
+#include "core/descriptor_quantization.hpp"
+#include <cmath>
+
+void rootsift_u8(const cv::Mat& descriptors, cv::Mat& out) {
+    if (descriptors.empty()) {
+        out.release();
+        return;
+    }
+    CV_Assert(descriptors.type() == CV_32F);
+
+    // Separate buffer so `out` may alias the input
+    cv::Mat q(descriptors.rows, descriptors.cols, CV_8U);
+    for (int r = 0; r < descriptors.rows; ++r) {
+        const float* src = descriptors.ptr<float>(r);
+        uint8_t* dst = q.ptr<uint8_t>(r);
+
+        float l1 = 0.0f;
+        for (int c = 0; c < descriptors.cols; ++c) l1 += std::abs(src[c]);
+        const float inv = l1 > 0.0f ? 1.0f / l1 : 0.0f;
+        for (int c = 0; c < descriptors.cols; ++c) {
+            dst[c] = cv::saturate_cast<uint8_t>(512.0f * std::sqrt(std::abs(src[c]) * inv));
+        }
+    }
+    out = q;
+}
+
+descriptor_metric metric_of(const cv::Mat& descriptors) {
+    if (descriptors.type() != CV_8U) return descriptor_metric::L2_F32;
+    return descriptors.cols == kRootSiftU8Bytes ? descriptor_metric::L2_U8 : descriptor_metric::HAMMING;
+}
@@ -0,0 +1,46 @@
+#include "core/feature_budget_controller.hpp"
+#include <algorithm>
+
+feature_budget_controller::decision
+feature_budget_controller::update(double elapsed_ms, int detected, int inliers, const decision& current) {
+    const int requested = std::max(1, current.nfeatures);
+
+    // Extraction time is roughly linear in the requested count; smooth the
+    // per-feature cost so one slow frame does not halve the budget.
+    const double sample = elapsed_ms / requested;
+    cost_ms_ = cost_ms_ <= 0.0 ? sample : 0.8 * cost_ms_ + 0.2 * sample;
+    over_budget_ = elapsed_ms > cfg.budget_ms;
+
+    // 10% headroom for scheduling jitter
+    const double affordable = cost_ms_ > 0.0 ? cfg.budget_ms * 0.9 / cost_ms_ : cfg.max_features;
+
+    int wanted = requested;
+    if (inliers >= 0) {
+        if (inliers < cfg.target_inliers) {
+            wanted = requested + requested / 5;
+        } else if (inliers > 2 * cfg.target_inliers) {
+            wanted = requested - requested / 10;
+        }
+    }
+
+    decision next;
+    double capped = std::min<double>(wanted, affordable);
+    if (over_budget_) capped = std::min<double>(capped, requested - requested / 10);
+    next.nfeatures = std::clamp(static_cast<int>(capped), cfg.min_features, cfg.max_features);
+
+    // Too few corners for the quota: loosen FAST. Still over budget at the
+    // floor: tighten it so fewer candidates reach Harris ranking.
+    next.fast_threshold = current.fast_threshold;
+    if (detected < requested * 8 / 10) {
+        next.fast_threshold -= 2;
+    } else if (over_budget_ && next.nfeatures <= cfg.min_features) {
+        next.fast_threshold += 2;
+    }
+    next.fast_threshold = std::clamp(next.fast_threshold, cfg.min_threshold, cfg.max_threshold);
+    return next;
+}
+
+void feature_budget_controller::reset() {
+    cost_ms_ = 0.0;
+    over_budget_ = false;
+}
@@ -0,0 +1,70 @@
+#include "core/feature_set.hpp"
+
+void feature_set::clear() {
+    x.clear();
+    y.clear();
+    response.clear();
+    size.clear();
+    angle.clear();
+    octave.clear();
+    descriptors.release();
+}
+
+void feature_set::reserve(size_t n) {
+    x.reserve(n);
+    y.reserve(n);
+    response.reserve(n);
+    size.reserve(n);
+    angle.reserve(n);
+    octave.reserve(n);
+}
+
+void feature_set::push_back(const cv::KeyPoint& kp) {
+    x.push_back(kp.pt.x);
+    y.push_back(kp.pt.y);
+    response.push_back(kp.response);
+    size.push_back(kp.size);
+    angle.push_back(kp.angle);
+    octave.push_back(kp.octave);
+}
+
+feature_set feature_set::from_keypoints(const std::vector<cv::KeyPoint>& keypoints,
+                                        const cv::Mat& descriptors) {
+    feature_set set;
+    set.reserve(keypoints.size());
+    for (const auto& kp : keypoints) set.push_back(kp);
+    set.descriptors = descriptors;
+    return set;
+}
+
+void feature_set::to_keypoints(std::vector<cv::KeyPoint>& keypoints) const {
+    keypoints.resize(count());
+    for (size_t i = 0; i < count(); ++i) {
+        keypoints[i] = cv::KeyPoint(x[i], y[i], size[i], angle[i], response[i], octave[i]);
+    }
+}
+
+bool gather_matched_points(const feature_set& query, const feature_set& train,
+                           const std::vector<cv::DMatch>& matches,
+                           std::vector<cv::Point2f>& pts1, std::vector<cv::Point2f>& pts2) {
+    pts1.clear();
+    pts2.clear();
+    pts1.reserve(matches.size());
+    pts2.reserve(matches.size());
+
+    const int nq = static_cast<int>(query.count()), nt = static_cast<int>(train.count());
+    const float* qx = query.x.data();
+    const float* qy = query.y.data();
+    const float* tx = train.x.data();
+    const float* ty = train.y.data();
+    for (const auto& m : matches) {
+        if (m.queryIdx < 0 || m.queryIdx >= nq || m.trainIdx < 0 || m.trainIdx >= nt) {
+            pts1.clear();
+            pts2.clear();
+            return false;
+        }
+        pts1.emplace_back(qx[m.queryIdx], qy[m.queryIdx]);
+        pts2.emplace_back(tx[m.trainIdx], ty[m.trainIdx]);
+    }
+    return true;
+}
@@ -0,0 +1,50 @@
+#include "core/grid_index.hpp"
+
+void grid_index::build(const std::vector<cv::KeyPoint>& keypoints, float cell_size) {
+    xs_.resize(keypoints.size());
+    ys_.resize(keypoints.size());
+    for (size_t i = 0; i < keypoints.size(); ++i) {
+        xs_[i] = keypoints[i].pt.x;
+        ys_[i] = keypoints[i].pt.y;
+    }
+    build_from_coords(cell_size);
+}
+
+void grid_index::build(const std::vector<cv::Point2f>& points, float cell_size) {
+    xs_.resize(points.size());
+    ys_.resize(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        xs_[i] = points[i].x;
+        ys_[i] = points[i].y;
+    }
+    build_from_coords(cell_size);
+}
+
+void grid_index::build_from_coords(float cell_size) {
+    const int n = static_cast<int>(xs_.size());
+    items_.resize(n);
+    if (n == 0) {
+        cols_ = rows_ = 0;
+        start_.assign(1, 0);
+        return;
+    }
+
+    // Grid spans the bounding box of the points
+    min_x_ = *std::min_element(xs_.begin(), xs_.end());
+    min_y_ = *std::min_element(ys_.begin(), ys_.end());
+    const float max_x = *std::max_element(xs_.begin(), xs_.end());
+    const float max_y = *std::max_element(ys_.begin(), ys_.end());
+    inv_cell_ = 1.0f / std::max(1.0f, cell_size);
+    cols_ = cell_x(max_x) + 1;
+    rows_ = cell_y(max_y) + 1;
+
+    // Counting sort: histogram, exclusive prefix sum, scatter
+    start_.assign(static_cast<size_t>(cols_) * rows_ + 1, 0);
+    for (int i = 0; i < n; ++i) ++start_[cell_y(ys_[i]) * cols_ + cell_x(xs_[i]) + 1];
+    for (size_t c = 1; c < start_.size(); ++c) start_[c] += start_[c - 1];
+
+    fill_.assign(start_.begin(), start_.end() - 1);
+    for (int i = 0; i < n; ++i) {
+        items_[fill_[cell_y(ys_[i]) * cols_ + cell_x(xs_[i])]++] = i;
+    }
+}
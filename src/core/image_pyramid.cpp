@@ -0,0 +1,80 @@
+#include "core/image_pyramid.hpp"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr size_t kRowAlign = 64;
+
+inline size_t aligned_step(int width) {
+    return (static_cast<size_t>(width) + kRowAlign - 1) & ~(kRowAlign - 1);
+}
+
+}  // namespace
+
+void build_image_pyramid(const cv::Mat& image, int nlevels, float scale_factor, image_pyramid& out) {
+    if (image.empty()) {
+        out = image_pyramid();
+        return;
+    }
+    nlevels = std::max(1, nlevels);
+    scale_factor = std::max(1.01f, scale_factor);
+    const bool dyadic = std::abs(scale_factor - 2.0f) < 1e-3f;
+
+    // Level geometry
+    std::vector<cv::Size> sizes(nlevels);
+    std::vector<float> scales(nlevels);
+    sizes[0] = image.size();
+    scales[0] = 1.0f;
+    for (int i = 1; i < nlevels; ++i) {
+        scales[i] = scales[i - 1] * scale_factor;
+        if (dyadic) {
+            sizes[i] = cv::Size((sizes[i - 1].width + 1) / 2, (sizes[i - 1].height + 1) / 2);
+        } else {
+            sizes[i] = cv::Size(cvRound(image.cols / scales[i]), cvRound(image.rows / scales[i]));
+        }
+        if (sizes[i].width < 8 || sizes[i].height < 8) {
+            sizes.resize(i);
+            scales.resize(i);
+            break;
+        }
+    }
+
+    size_t total = 0;
+    for (const auto& sz : sizes) total += aligned_step(sz.width) * sz.height;
+
+    // Reuse the previous buffer only if no downstream block still holds it
+    if (!out.storage || out.storage.use_count() > 1) {
+        out.storage = std::make_shared<image_pyramid::buffer_t>(total);
+    } else if (out.storage->size() < total) {
+        out.storage->resize(total);
+    }
+
+    out.levels.clear();
+    out.scales = scales;
+    out.scale_factor = scale_factor;
+
+    uchar* base = out.storage->data();
+    size_t offset = 0;
+    for (const auto& sz : sizes) {
+        out.levels.emplace_back(sz.height, sz.width, CV_8UC1, base + offset, aligned_step(sz.width));
+        offset += aligned_step(sz.width) * sz.height;
+    }
+
+    // Destination headers already have the right size/type, so OpenCV writes
+    // straight into the shared buffer instead of reallocating.
+    if (image.channels() == 3) {
+        cv::cvtColor(image, out.levels[0], cv::COLOR_BGR2GRAY);
+    } else {
+        image.copyTo(out.levels[0]);
+    }
+
+    for (size_t i = 1; i < out.levels.size(); ++i) {
+        if (dyadic) {
+            cv::pyrDown(out.levels[i - 1], out.levels[i], out.levels[i].size());
+        } else {
+            cv::resize(out.levels[i - 1], out.levels[i], out.levels[i].size(), 0, 0, cv::INTER_AREA);
+        }
+    }
+}
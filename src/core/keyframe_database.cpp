@@ -0,0 +1,53 @@
+#include "core/keyframe_database.hpp"
+#include <algorithm>
+
+int keyframe_database::add(const bow_vector& v) {
+    const int entry = entries_++;
+    for (const auto& [word, weight] : v) {
+        if (word >= static_cast<int>(inverted_.size())) inverted_.resize(word + 1);
+        inverted_[word].push_back({entry, weight});
+    }
+    return entry;
+}
+
+void keyframe_database::query(const bow_vector& v, int max_results, int entry_limit,
+                              std::vector<result>& out) const {
+    out.clear();
+    entry_limit = std::min(entry_limit, entries_);
+    if (entry_limit <= 0 || max_results <= 0) return;
+
+    if (static_cast<int>(scores_.size()) < entries_) scores_.resize(entries_, 0.0f);
+    touched_.clear();
+
+    for (const auto& [word, weight] : v) {
+        if (word >= static_cast<int>(inverted_.size())) continue;
+        // Postings are in insertion order, so everything past the limit is
+        // at the end of the list
+        for (const posting& p : inverted_[word]) {
+            if (p.entry >= entry_limit) break;
+            if (scores_[p.entry] == 0.0f) touched_.push_back(p.entry);
+            scores_[p.entry] += std::min(weight, p.weight);
+        }
+    }
+
+    out.reserve(touched_.size());
+    for (int e : touched_) {
+        out.push_back({e, scores_[e]});
+        scores_[e] = 0.0f;
+    }
+
+    auto better = [](const result& a, const result& b) { return a.score > b.score; };
+    if (static_cast<int>(out.size()) > max_results) {
+        std::partial_sort(out.begin(), out.begin() + max_results, out.end(), better);
+        out.resize(max_results);
+    } else {
+        std::sort(out.begin(), out.end(), better);
+    }
+}
+
+void keyframe_database::clear() {
+    inverted_.clear();
+    scores_.clear();
+    touched_.clear();
+    entries_ = 0;
+}
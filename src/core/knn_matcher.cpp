@@ -0,0 +1,341 @@
+#include "core/knn_matcher.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#if INSIGHT_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr int kQueryBlock = 64;           // Rows per parallel work item
+constexpr size_t kTrainBlockBytes = 16384; // Train rows kept hot in L1 per pass
+
+inline void offer(knn2_match& r, int idx, int dist) {
+    if (dist < r.best_dist) {
+        r.second_dist = r.best_dist;
+        r.second_idx = r.best_idx;
+        r.best_dist = dist;
+        r.best_idx = idx;
+    } else if (dist < r.second_dist) {
+        r.second_dist = dist;
+        r.second_idx = idx;
+    }
+}
+
+// Train rows [t0, t1) against one query row
+using scan_fn = void (*)(const uint8_t* q, const uint8_t* train, size_t step,
+                         int t0, int t1, int bytes, knn2_match& r);
+
+inline int hamming_bytes(const uint8_t* a, const uint8_t* b, int bytes) {
+    int d = 0;
+    int i = 0;
+    for (; i + 8 <= bytes; i += 8) {
+        uint64_t x, y;
+        std::memcpy(&x, a + i, 8);
+        std::memcpy(&y, b + i, 8);
+        d += __builtin_popcountll(x ^ y);
+    }
+    for (; i < bytes; ++i) d += __builtin_popcount(static_cast<unsigned>(a[i] ^ b[i]));
+    return d;
+}
+
+void scan_scalar(const uint8_t* q, const uint8_t* train, size_t step, int t0, int t1, int bytes, knn2_match& r) {
+    for (int t = t0; t < t1; ++t) offer(r, t, hamming_bytes(q, train + t * step, bytes));
+}
+
+inline int l2sq_bytes(const uint8_t* a, const uint8_t* b, int bytes) {
+    int d = 0;
+    for (int i = 0; i < bytes; ++i) {
+        const int e = static_cast<int>(a[i]) - static_cast<int>(b[i]);
+        d += e * e;
+    }
+    return d;
+}
+
+void scan_l2_scalar(const uint8_t* q, const uint8_t* train, size_t step, int t0, int t1, int bytes, knn2_match& r) {
+    for (int t = t0; t < t1; ++t) offer(r, t, l2sq_bytes(q, train + t * step, bytes));
+}
+
+#if INSIGHT_X86_SIMD
+
+__attribute__((target("popcnt")))
+inline int hamming_popcnt(const uint8_t* a, const uint8_t* b, int bytes) {
+    int d = 0;
+    int i = 0;
+    for (; i + 8 <= bytes; i += 8) {
+        uint64_t x, y;
+        std::memcpy(&x, a + i, 8);
+        std::memcpy(&y, b + i, 8);
+        d += static_cast<int>(_mm_popcnt_u64(x ^ y));
+    }
+    for (; i < bytes; ++i) d += _mm_popcnt_u32(static_cast<unsigned>(a[i] ^ b[i]));
+    return d;
+}
+
+__attribute__((target("popcnt")))
+void scan_popcnt(const uint8_t* q, const uint8_t* train, size_t step, int t0, int t1, int bytes, knn2_match& r) {
+    for (int t = t0; t < t1; ++t) offer(r, t, hamming_popcnt(q, train + t * step, bytes));
+}
+
+// Per-64-bit-lane popcount of q ^ row via the nibble lookup (Mula)
+__attribute__((target("avx2")))
+inline __m256i popcnt_lanes_avx2(__m256i qv, const uint8_t* row) {
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0F);
+    __m256i x = _mm256_xor_si256(qv, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row)));
+    __m256i lo = _mm256_and_si256(x, low);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(x, 4), low);
+    __m256i cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lut, lo), _mm256_shuffle_epi8(lut, hi));
+    return _mm256_sad_epu8(cnt, _mm256_setzero_si256());
+}
+
+// 32-byte rows, four train rows per step
+__attribute__((target("avx2,popcnt")))
+void scan32_avx2(const uint8_t* q, const uint8_t* train, size_t step, int t0, int t1, int bytes, knn2_match& r) {
+    const __m256i qv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(q));
+    alignas(32) int64_t d[4];
+
+    int t = t0;
+    for (; t + 4 <= t1; t += 4) {
+        const uint8_t* row = train + t * step;
+        __m256i p0 = popcnt_lanes_avx2(qv, row);
+        __m256i p1 = popcnt_lanes_avx2(qv, row + step);
+        __m256i p2 = popcnt_lanes_avx2(qv, row + 2 * step);
+        __m256i p3 = popcnt_lanes_avx2(qv, row + 3 * step);
+
+        // Horizontal sums of four rows into one vector, in row order
+        __m256i s01 = _mm256_add_epi64(_mm256_unpacklo_epi64(p0, p1), _mm256_unpackhi_epi64(p0, p1));
+        __m256i s23 = _mm256_add_epi64(_mm256_unpacklo_epi64(p2, p3), _mm256_unpackhi_epi64(p2, p3));
+        __m256i sums = _mm256_add_epi64(_mm256_permute2x128_si256(s01, s23, 0x20),
+                                        _mm256_permute2x128_si256(s01, s23, 0x31));
+
+        // Only rows beating the current second best can change the result
+        __m256i closer = _mm256_cmpgt_epi64(_mm256_set1_epi64x(r.second_dist), sums);
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(closer));
+        if (!mask) continue;
+        _mm256_store_si256(reinterpret_cast<__m256i*>(d), sums);
+        while (mask) {
+            int i = __builtin_ctz(mask);
+            mask &= mask - 1;
+            offer(r, t + i, static_cast<int>(d[i]));
+        }
+    }
+    for (; t < t1; ++t) offer(r, t, hamming_popcnt(q, train + t * step, bytes));
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq")))
+inline __m512i popcnt_pair_avx512(__m512i qv, const uint8_t* a, const uint8_t* b) {
+    __m512i rows = _mm512_inserti64x4(
+        _mm512_castsi256_si512(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a))),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b)), 1);
+    return _mm512_popcnt_epi64(_mm512_xor_si512(qv, rows));
+}
+
+// 32-byte rows, eight train rows per step
+__attribute__((target("avx512f,avx512vpopcntdq,avx2,popcnt")))
+void scan32_avx512(const uint8_t* q, const uint8_t* train, size_t step, int t0, int t1, int bytes, knn2_match& r) {
+    const __m512i qv = _mm512_broadcast_i64x4(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(q)));
+    const __m512i order = _mm512_setr_epi64(0, 2, 1, 3, 4, 6, 5, 7);
+    alignas(64) int64_t d[8];
+
+    int t = t0;
+    for (; t + 8 <= t1; t += 8) {
+        const uint8_t* row = train + t * step;
+        __m512i r0 = popcnt_pair_avx512(qv, row, row + step);
+        __m512i r1 = popcnt_pair_avx512(qv, row + 2 * step, row + 3 * step);
+        __m512i r2 = popcnt_pair_avx512(qv, row + 4 * step, row + 5 * step);
+        __m512i r3 = popcnt_pair_avx512(qv, row + 6 * step, row + 7 * step);
+
+        // Fold 4 lanes per row: rows come out as 0,2,1,3,4,6,5,7, then reorder
+        __m512i s01 = _mm512_add_epi64(_mm512_unpacklo_epi64(r0, r1), _mm512_unpackhi_epi64(r0, r1));
+        __m512i s23 = _mm512_add_epi64(_mm512_unpacklo_epi64(r2, r3), _mm512_unpackhi_epi64(r2, r3));
+        __m512i sums = _mm512_add_epi64(_mm512_shuffle_i64x2(s01, s23, _MM_SHUFFLE(2, 0, 2, 0)),
+                                        _mm512_shuffle_i64x2(s01, s23, _MM_SHUFFLE(3, 1, 3, 1)));
+        sums = _mm512_permutexvar_epi64(order, sums);
+
+        unsigned mask = _mm512_cmplt_epi64_mask(sums, _mm512_set1_epi64(r.second_dist));
+        if (!mask) continue;
+        _mm512_store_si512(d, sums);
+        while (mask) {
+            int i = __builtin_ctz(mask);
+            mask &= mask - 1;
+            offer(r, t + i, static_cast<int>(d[i]));
+        }
+    }
+    for (; t < t1; ++t) offer(r, t, hamming_popcnt(q, train + t * step, bytes));
+}
+
+__attribute__((target("popcnt")))
+void subset_popcnt(const uint8_t* q, const uint8_t* train, size_t step, const int* rows, int count, int bytes, knn2_match& r) {
+    for (int k = 0; k < count; ++k) offer(r, rows[k], hamming_popcnt(q, train + rows[k] * step, bytes));
+}
+
+// Squared L2 over uint8 vectors: |a - b| with two saturating subtractions,
+// widened to 16 bits and squared-and-summed with madd, 32 bytes per step
+__attribute__((target("avx2")))
+inline int l2sq_avx2(const uint8_t* a, const uint8_t* b, int bytes) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i acc = zero;
+    int i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        const __m256i diff = _mm256_or_si256(_mm256_subs_epu8(va, vb), _mm256_subs_epu8(vb, va));
+        const __m256i lo = _mm256_unpacklo_epi8(diff, zero);
+        const __m256i hi = _mm256_unpackhi_epi8(diff, zero);
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(lo, lo));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(hi, hi));
+    }
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    int d = _mm_cvtsi128_si32(sum);
+    for (; i < bytes; ++i) {
+        const int e = static_cast<int>(a[i]) - static_cast<int>(b[i]);
+        d += e * e;
+    }
+    return d;
+}
+
+__attribute__((target("avx2")))
+void scan_l2_avx2(const uint8_t* q, const uint8_t* train, size_t step, int t0, int t1, int bytes, knn2_match& r) {
+    for (int t = t0; t < t1; ++t) offer(r, t, l2sq_avx2(q, train + t * step, bytes));
+}
+
+#endif  // INSIGHT_X86_SIMD
+
+scan_fn select_l2_scan(simd_level level) {
+#if INSIGHT_X86_SIMD
+    if (level >= simd_level::AVX2 && get_cpu_features().avx2) return scan_l2_avx2;
+#endif
+    (void)level;
+    return scan_l2_scalar;
+}
+
+scan_fn select_scan(int bytes, simd_level level) {
+#if INSIGHT_X86_SIMD
+    const cpu_features& cpu = get_cpu_features();
+    if (bytes == 32) {
+        if (level == simd_level::AVX512 && cpu.avx512_vpopcntdq) return scan32_avx512;
+        if (level >= simd_level::AVX2 && cpu.avx2 && cpu.popcnt) return scan32_avx2;
+    }
+    if (level != simd_level::SCALAR && cpu.popcnt) return scan_popcnt;
+#endif
+    (void)bytes;
+    (void)level;
+    return scan_scalar;
+}
+
+// Train-block outer loop: each block is reused by every query row. The
+// ratio test is best < ratio * second on whatever distance `scan` returns.
+void knn2_rows(scan_fn scan, const uint8_t* query, size_t query_step, int query_rows,
+               const uint8_t* train, size_t train_step, int train_rows,
+               int bytes, float ratio, knn2_match* results) {
+    const int train_block = std::max(64, static_cast<int>(kTrainBlockBytes / std::max(1, bytes)));
+
+    for (int q = 0; q < query_rows; ++q) {
+        results[q] = {-1, INT_MAX, -1, INT_MAX, false};
+    }
+
+    for (int t0 = 0; t0 < train_rows; t0 += train_block) {
+        const int t1 = std::min(train_rows, t0 + train_block);
+        for (int q = 0; q < query_rows; ++q) {
+            scan(query + q * query_step, train, train_step, t0, t1, bytes, results[q]);
+        }
+    }
+
+    for (int q = 0; q < query_rows; ++q) {
+        knn2_match& r = results[q];
+        r.accepted = r.second_idx >= 0 && r.best_dist < ratio * r.second_dist;
+    }
+}
+
+void knn2_parallel(scan_fn scan, const cv::Mat& query, const cv::Mat& train, float ratio,
+                   std::vector<knn2_match>& results) {
+    CV_Assert(query.type() == CV_8U && train.type() == CV_8U && query.cols == train.cols);
+    results.resize(query.rows);
+    if (query.empty() || train.empty()) {
+        for (auto& r : results) r = {-1, INT_MAX, -1, INT_MAX, false};
+        return;
+    }
+
+    const int blocks = (query.rows + kQueryBlock - 1) / kQueryBlock;
+    cv::parallel_for_(cv::Range(0, blocks), [&](const cv::Range& range) {
+        for (int b = range.start; b < range.end; ++b) {
+            const int q0 = b * kQueryBlock;
+            const int q1 = std::min(query.rows, q0 + kQueryBlock);
+            knn2_rows(scan, query.ptr<uint8_t>(q0), query.step, q1 - q0,
+                      train.ptr<uint8_t>(0), train.step, train.rows,
+                      query.cols, ratio, results.data() + q0);
+        }
+    });
+}
+
+}  // namespace
+
+void knn2_hamming_rows(const uint8_t* query, size_t query_step, int query_rows,
+                       const uint8_t* train, size_t train_step, int train_rows,
+                       int bytes, float ratio, knn2_match* results, simd_level level) {
+    knn2_rows(select_scan(bytes, level), query, query_step, query_rows,
+              train, train_step, train_rows, bytes, ratio, results);
+}
+
+void knn2_hamming(const cv::Mat& query, const cv::Mat& train, float ratio,
+                  std::vector<knn2_match>& results, simd_level level) {
+    knn2_parallel(select_scan(query.cols, level), query, train, ratio, results);
+}
+
+void knn2_l2_u8(const cv::Mat& query, const cv::Mat& train, float ratio,
+                std::vector<knn2_match>& results, simd_level level) {
+    // Distances are squared, so the ratio is too
+    knn2_parallel(select_l2_scan(level), query, train, ratio * ratio, results);
+}
+
+void knn2_hamming_subset(const uint8_t* query, const uint8_t* train, size_t train_step,
+                         const int* rows, int count, int bytes, float ratio,
+                         knn2_match& result, simd_level level) {
+    result = {-1, INT_MAX, -1, INT_MAX, false};
+    // Candidate rows are scattered, so the blocked scans do not apply; the
+    // win here is the hardware popcount
+#if INSIGHT_X86_SIMD
+    if (level != simd_level::SCALAR && get_cpu_features().popcnt) {
+        subset_popcnt(query, train, train_step, rows, count, bytes, result);
+    } else
+#endif
+    {
+        (void)level;
+        for (int k = 0; k < count; ++k) {
+            offer(result, rows[k], hamming_bytes(query, train + rows[k] * train_step, bytes));
+        }
+    }
+    result.accepted = result.second_idx >= 0 && result.best_dist < ratio * result.second_dist;
+}
+
+void knn2_l2_u8_subset(const uint8_t* query, const uint8_t* train, size_t train_step,
+                       const int* rows, int count, int bytes, float ratio,
+                       knn2_match& result, simd_level level) {
+    result = {-1, INT_MAX, -1, INT_MAX, false};
+#if INSIGHT_X86_SIMD
+    if (level >= simd_level::AVX2 && get_cpu_features().avx2) {
+        for (int k = 0; k < count; ++k) offer(result, rows[k], l2sq_avx2(query, train + rows[k] * train_step, bytes));
+    } else
+#endif
+    {
+        (void)level;
+        for (int k = 0; k < count; ++k) offer(result, rows[k], l2sq_bytes(query, train + rows[k] * train_step, bytes));
+    }
+    result.accepted = result.second_idx >= 0 && result.best_dist < ratio * ratio * result.second_dist;
+}
+
+void collect_matches(const std::vector<knn2_match>& results, std::vector<cv::DMatch>& matches) {
+    matches.clear();
+    for (size_t q = 0; q < results.size(); ++q) {
+        const knn2_match& r = results[q];
+        if (r.accepted) {
+            matches.emplace_back(static_cast<int>(q), r.best_idx, static_cast<float>(r.best_dist));
+        }
+    }
+}
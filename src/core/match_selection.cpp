@@ -0,0 +1,95 @@
+#include "core/match_selection.hpp"
+#include <numeric>
+
+namespace {
+
+bool indices_in_range(const std::vector<cv::DMatch>& matches, size_t n1, size_t n2) {
+    const int nq = static_cast<int>(n1), nt = static_cast<int>(n2);
+    for (const auto& m : matches) {
+        if (m.queryIdx < 0 || m.queryIdx >= nq || m.trainIdx < 0 || m.trainIdx >= nt) return false;
+    }
+    return true;
+}
+
+void select_every(const std::vector<cv::DMatch>& matches, std::vector<int>& indices) {
+    indices.resize(matches.size());
+    std::iota(indices.begin(), indices.end(), 0);
+}
+
+cv::KeyPoint keypoint_at(const feature_set& f, int i) {
+    return cv::KeyPoint(f.x[i], f.y[i], f.size[i], f.angle[i], f.response[i], f.octave[i]);
+}
+
+} // namespace
+
+bool match_selection::select_all(std::shared_ptr<const std::vector<cv::KeyPoint>> keypoints1,
+                                 std::shared_ptr<const std::vector<cv::KeyPoint>> keypoints2,
+                                 std::shared_ptr<const std::vector<cv::DMatch>> matches,
+                                 match_selection& out) {
+    out = match_selection();
+    if (!keypoints1 || !keypoints2 || !matches ||
+        !indices_in_range(*matches, keypoints1->size(), keypoints2->size())) {
+        return false;
+    }
+    out.keypoints1 = std::move(keypoints1);
+    out.keypoints2 = std::move(keypoints2);
+    select_every(*matches, out.indices);
+    out.matches = std::move(matches);
+    return true;
+}
+
+bool match_selection::select_all(std::shared_ptr<const feature_set> features1,
+                                 std::shared_ptr<const feature_set> features2,
+                                 std::shared_ptr<const std::vector<cv::DMatch>> matches,
+                                 match_selection& out) {
+    out = match_selection();
+    if (!features1 || !features2 || !matches ||
+        !indices_in_range(*matches, features1->count(), features2->count())) {
+        return false;
+    }
+    out.features1 = std::move(features1);
+    out.features2 = std::move(features2);
+    select_every(*matches, out.indices);
+    out.matches = std::move(matches);
+    return true;
+}
+
+match_selection match_selection::subset(const cv::Mat& mask) const {
+    match_selection out;
+    out.matches = matches;
+    out.keypoints1 = keypoints1;
+    out.keypoints2 = keypoints2;
+    out.features1 = features1;
+    out.features2 = features2;
+
+    out.indices.reserve(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i) {
+        if (mask.at<uchar>(static_cast<int>(i), 0)) out.indices.push_back(indices[i]);
+    }
+    return out;
+}
+
+void match_selection::gather_points(std::vector<cv::Point2f>& pts1, std::vector<cv::Point2f>& pts2,
+                                    std::vector<cv::DMatch>* selected_matches) const {
+    pts1.resize(size());
+    pts2.resize(size());
+    for (size_t i = 0; i < size(); ++i) {
+        pts1[i] = point1(i);
+        pts2[i] = point2(i);
+    }
+    if (selected_matches) materialize(nullptr, nullptr, selected_matches);
+}
+
+void match_selection::materialize(std::vector<cv::KeyPoint>* kpts1, std::vector<cv::KeyPoint>* kpts2,
+                                  std::vector<cv::DMatch>* selected_matches) const {
+    if (kpts1) kpts1->resize(size());
+    if (kpts2) kpts2->resize(size());
+    if (selected_matches) selected_matches->resize(size());
+
+    for (size_t i = 0; i < size(); ++i) {
+        const cv::DMatch& m = match(i);
+        if (kpts1) (*kpts1)[i] = keypoints1 ? (*keypoints1)[m.queryIdx] : keypoint_at(*features1, m.queryIdx);
+        if (kpts2) (*kpts2)[i] = keypoints2 ? (*keypoints2)[m.trainIdx] : keypoint_at(*features2, m.trainIdx);
+        if (selected_matches) (*selected_matches)[i] = m;
+    }
+}
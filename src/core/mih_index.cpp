@@ -0,0 +1,224 @@
+#include "core/mih_index.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <climits>
+#include <cstring>
+
+namespace {
+
+constexpr int kBuckets = 1 << 16;
+constexpr int kQueryBlock = 64;
+
+// 16-bit masks grouped by popcount: probing at radius s walks masks of weight s
+const std::array<std::vector<uint16_t>, 17>& masks_by_weight() {
+    static const std::array<std::vector<uint16_t>, 17> masks = [] {
+        std::array<std::vector<uint16_t>, 17> m;
+        for (int v = 0; v < kBuckets; ++v) m[__builtin_popcount(v)].push_back(static_cast<uint16_t>(v));
+        return m;
+    }();
+    return masks;
+}
+
+inline uint16_t substring(const uint8_t* code, int j) {
+    uint16_t s;
+    std::memcpy(&s, code + 2 * j, 2);
+    return s;
+}
+
+__attribute__((always_inline)) inline int hamming32(const uint8_t* a, const uint8_t* b) {
+    int d = 0;
+    for (int i = 0; i < mih_index::kBytes; i += 8) {
+        uint64_t x, y;
+        std::memcpy(&x, a + i, 8);
+        std::memcpy(&y, b + i, 8);
+        d += __builtin_popcountll(x ^ y);
+    }
+    return d;
+}
+
+__attribute__((always_inline)) inline void offer(knn2_match& r, int idx, int dist) {
+    // A row can turn up in several tables; only a repeat of the current
+    // best or second best could corrupt the result
+    if (idx == r.best_idx || idx == r.second_idx) return;
+    if (dist < r.best_dist) {
+        r.second_dist = r.best_dist;
+        r.second_idx = r.best_idx;
+        r.best_dist = dist;
+        r.best_idx = idx;
+    } else if (dist < r.second_dist) {
+        r.second_dist = dist;
+        r.second_idx = idx;
+    }
+}
+
+struct search_args {
+    const uint8_t* codes;
+    int rows;
+    int indexed;
+    const int* offsets;
+    const int* ids;
+    const uint64_t* occupied;
+    float ratio;
+    int max_radius;
+};
+
+// Searches query rows [0, n) together: the probe loops run table by table
+// over the whole block, so each 256 KB offset table stays in cache while
+// every query in the block probes it. Returns the full distances evaluated.
+__attribute__((always_inline)) inline long long search_block(const search_args& a, const uint8_t* query, size_t step,
+                                                             int n, knn2_match* out) {
+    long long evaluated = 0;
+    int unseen[kQueryBlock];   // Lower bound on the distance of rows not yet seen
+    bool done[kQueryBlock];
+    int active = 0;
+
+    for (int i = 0; i < n; ++i) {
+        const uint8_t* q = query + i * step;
+        knn2_match& r = out[i];
+        r = {-1, INT_MAX, -1, INT_MAX, false};
+        // Pending rows are not hashed yet: scan them
+        for (int t = a.indexed; t < a.rows; ++t) offer(r, t, hamming32(q, a.codes + t * mih_index::kBytes));
+        evaluated += a.rows - a.indexed;
+        unseen[i] = a.indexed == 0 ? INT_MAX : 0;
+        done[i] = a.indexed == 0;
+        active += !done[i];
+    }
+
+    // After probing radius s in substrings 0..j, every unseen row differs by
+    // at least s+1 bits in those substrings and s in the rest, so its
+    // distance is at least 16*s + j + 1.
+    const auto& masks = masks_by_weight();
+    for (int s = 0; s <= a.max_radius && active > 0; ++s) {
+        for (int j = 0; j < mih_index::kSubstrings && active > 0; ++j) {
+            const int* offsets = a.offsets + static_cast<size_t>(j) * (kBuckets + 1);
+            const int* ids = a.ids + static_cast<size_t>(j) * a.indexed;
+            const uint64_t* occupied = a.occupied + static_cast<size_t>(j) * (kBuckets / 64);
+            int bound = mih_index::kSubstrings * s + j + 1;
+            if (bound > mih_index::kBytes * 8) bound = INT_MAX;   // Nothing left unseen
+
+            for (int i = 0; i < n; ++i) {
+                if (done[i]) continue;
+                const uint8_t* q = query + i * step;
+                knn2_match& r = out[i];
+                const uint16_t key = substring(q, j);
+                for (uint16_t mask : masks[s]) {
+                    const uint16_t bucket = key ^ mask;
+                    if (!(occupied[bucket >> 6] >> (bucket & 63) & 1)) continue;
+                    for (int k = offsets[bucket]; k < offsets[bucket + 1]; ++k) {
+                        const int t = ids[k];
+                        offer(r, t, hamming32(q, a.codes + t * mih_index::kBytes));
+                    }
+                    evaluated += offsets[bucket + 1] - offsets[bucket];
+                }
+
+                // Both neighbours exact, or the ratio test passes whatever is unseen
+                unseen[i] = bound;
+                if (r.second_dist < bound || r.best_dist < a.ratio * std::min(r.second_dist, bound)) {
+                    done[i] = true;
+                    --active;
+                }
+            }
+        }
+    }
+
+    // A search cut short by max_radius is only accepted if the test passes
+    // against the bound reached
+    for (int i = 0; i < n; ++i) {
+        knn2_match& r = out[i];
+        r.accepted = r.best_idx >= 0 && (r.second_idx >= 0 || unseen[i] != INT_MAX) &&
+                     r.best_dist < a.ratio * std::min(r.second_dist, unseen[i]);
+    }
+    return evaluated;
+}
+
+long long search_block_scalar(const search_args& a, const uint8_t* q, size_t step, int n, knn2_match* out) {
+    return search_block(a, q, step, n, out);
+}
+
+#if INSIGHT_X86_SIMD
+__attribute__((target("popcnt")))
+long long search_block_popcnt(const search_args& a, const uint8_t* q, size_t step, int n, knn2_match* out) {
+    return search_block(a, q, step, n, out);
+}
+#endif
+
+}  // namespace
+
+void mih_index::clear() {
+    codes_.clear();
+    offsets_.clear();
+    ids_.clear();
+    occupied_.clear();
+    indexed_ = 0;
+}
+
+void mih_index::add(const cv::Mat& descriptors) {
+    if (descriptors.empty()) return;
+    CV_Assert(descriptors.type() == CV_8U && descriptors.cols == kBytes);
+
+    const size_t old = codes_.size();
+    codes_.resize(old + static_cast<size_t>(descriptors.rows) * kBytes);
+    for (int r = 0; r < descriptors.rows; ++r) {
+        std::memcpy(codes_.data() + old + static_cast<size_t>(r) * kBytes, descriptors.ptr(r), kBytes);
+    }
+
+    // Linear scans of pending rows cost about as much as probing once they
+    // reach a fraction of the table size
+    if (pending() > std::max(256, indexed_ / 4)) rebuild();
+}
+
+void mih_index::rebuild() {
+    const int n = size();
+    offsets_.assign(static_cast<size_t>(kSubstrings) * (kBuckets + 1), 0);
+    ids_.resize(static_cast<size_t>(kSubstrings) * n);
+    occupied_.assign(static_cast<size_t>(kSubstrings) * (kBuckets / 64), 0);
+
+    // One counting sort per substring table
+    cv::parallel_for_(cv::Range(0, kSubstrings), [&](const cv::Range& range) {
+        std::vector<int> fill(kBuckets);
+        for (int j = range.start; j < range.end; ++j) {
+            int* offsets = offsets_.data() + static_cast<size_t>(j) * (kBuckets + 1);
+            int* ids = ids_.data() + static_cast<size_t>(j) * n;
+            for (int t = 0; t < n; ++t) ++offsets[substring(codes_.data() + t * kBytes, j) + 1];
+            uint64_t* occupied = occupied_.data() + static_cast<size_t>(j) * (kBuckets / 64);
+            for (int b = 0; b < kBuckets; ++b) {
+                if (offsets[b + 1]) occupied[b >> 6] |= uint64_t(1) << (b & 63);
+                offsets[b + 1] += offsets[b];
+            }
+            std::copy(offsets, offsets + kBuckets, fill.begin());
+            for (int t = 0; t < n; ++t) ids[fill[substring(codes_.data() + t * kBytes, j)]++] = t;
+        }
+    });
+    indexed_ = n;
+}
+
+void mih_index::knn2(const cv::Mat& query, float ratio, std::vector<knn2_match>& results,
+                     int max_radius, simd_level level) const {
+    CV_Assert(query.empty() || (query.type() == CV_8U && query.cols == kBytes));
+    results.resize(query.rows);
+    last_candidates_ = 0.0;
+    if (query.empty()) return;
+
+    search_args args{codes_.data(), size(), indexed_, offsets_.data(), ids_.data(),
+                     occupied_.data(), ratio, std::clamp(max_radius, 0, 16)};
+
+    auto search = search_block_scalar;
+#if INSIGHT_X86_SIMD
+    if (level != simd_level::SCALAR && get_cpu_features().popcnt) search = search_block_popcnt;
+#endif
+    (void)level;
+
+    std::atomic<long long> evaluated{0};
+    const int blocks = (query.rows + kQueryBlock - 1) / kQueryBlock;
+    cv::parallel_for_(cv::Range(0, blocks), [&](const cv::Range& range) {
+        long long local = 0;
+        for (int b = range.start; b < range.end; ++b) {
+            const int q0 = b * kQueryBlock;
+            const int q1 = std::min(query.rows, q0 + kQueryBlock);
+            local += search(args, query.ptr<uint8_t>(q0), query.step, q1 - q0, results.data() + q0);
+        }
+        evaluated += local;
+    });
+    last_candidates_ = static_cast<double>(evaluated) / query.rows;
+}
@@ -0,0 +1,218 @@
+#include "core/orb_simd.hpp"
+#include <opencv2/imgproc.hpp>
+#include <cmath>
+
+namespace {
+
+constexpr int kEdgeThreshold = 31;   // Same as cv::ORB's default
+constexpr int kPatchSize = 31;
+constexpr float kHarrisK = 0.04f;
+
+// Smallest distance to the border at which a rotated 31x31 patch still fits
+constexpr int kDescribeMargin = 23;
+
+// Geometric feature budget per level, as in cv::ORB
+std::vector<int> features_per_level(int nfeatures, float scale_factor, int nlevels) {
+    std::vector<int> per_level(nlevels);
+    const float inv_factor = 1.0f / scale_factor;
+    float share = nfeatures * (1.0f - inv_factor) / (1.0f - std::pow(inv_factor, static_cast<float>(nlevels)));
+    int assigned = 0;
+    for (int i = 0; i < nlevels - 1; ++i) {
+        per_level[i] = cvRound(share);
+        assigned += per_level[i];
+        share *= inv_factor;
+    }
+    per_level[nlevels - 1] = std::max(nfeatures - assigned, 0);
+    return per_level;
+}
+
+void smooth_level(const cv::Mat& level, cv::Mat& blurred) {
+    cv::GaussianBlur(level, blurred, cv::Size(7, 7), 2, 2, cv::BORDER_REFLECT_101);
+}
+
+}  // namespace
+
+cv::Ptr<orb_simd> orb_simd::create(int nfeatures, float scale_factor, int nlevels, int fast_threshold) {
+    return cv::Ptr<orb_simd>(new orb_simd(nfeatures, scale_factor, nlevels, fast_threshold));
+}
+
+orb_simd::orb_simd(int nfeatures, float scale_factor, int nlevels, int fast_threshold)
+    : nfeatures(std::max(1, nfeatures)),
+      scale_factor(std::max(1.01f, scale_factor)),
+      nlevels(std::max(1, nlevels)),
+      fast_threshold(std::max(1, std::min(fast_threshold, 254))),
+      simd(get_cpu_features().best()) {}
+
+void orb_simd::detectAndCompute(cv::InputArray image, cv::InputArray mask,
+                                std::vector<cv::KeyPoint>& keypoints,
+                                cv::OutputArray descriptors,
+                                bool useProvidedKeypoints) {
+    cv::Mat img = image.getMat();
+    if (img.empty()) {
+        if (!useProvidedKeypoints) keypoints.clear();
+        if (descriptors.needed()) descriptors.release();
+        return;
+    }
+
+    build_image_pyramid(img, nlevels, scale_factor, pyramid);
+
+    cv::Mat desc;
+    if (useProvidedKeypoints) {
+        compute_provided(pyramid, keypoints, desc);
+    } else {
+        run(pyramid, mask.getMat(), keypoints, descriptors.needed() ? &desc : nullptr);
+    }
+    if (descriptors.needed()) descriptors.assign(desc);
+}
+
+void orb_simd::detect_and_compute(const image_pyramid& shared,
+                                  std::vector<cv::KeyPoint>& keypoints,
+                                  cv::Mat& descriptors) {
+    if (shared.empty()) {
+        keypoints.clear();
+        descriptors.release();
+        return;
+    }
+    run(shared, cv::Mat(), keypoints, &descriptors);
+}
+
+void orb_simd::detect_level(const cv::Mat& level, const cv::Mat& mask, int octave, int budget,
+                            level_state& state, std::vector<cv::KeyPoint>& keypoints) const {
+    using namespace orb_kernels;
+    keypoints.clear();
+
+    state.raw.clear();
+    fast9_detect(level.data, level.step, level.cols, level.rows, fast_threshold,
+                 kEdgeThreshold, state.raw, simd);
+    fast9_nonmax(state.raw, level.cols, level.rows, state.score_map, state.suppressed);
+
+    keypoints.reserve(state.suppressed.size());
+    for (const auto& c : state.suppressed) {
+        if (!mask.empty() && mask.at<uchar>(c.y, c.x) == 0) continue;
+        keypoints.emplace_back(static_cast<float>(c.x), static_cast<float>(c.y),
+                               static_cast<float>(kPatchSize), -1.0f,
+                               static_cast<float>(c.score), octave);
+    }
+
+    // Rank by FAST score first, then re-rank the survivors by Harris
+    cv::KeyPointsFilter::retainBest(keypoints, 2 * budget);
+    for (auto& kp : keypoints) {
+        kp.response = harris_response(level.data, level.step,
+                                      static_cast<int>(kp.pt.x), static_cast<int>(kp.pt.y),
+                                      kHarrisK, simd);
+    }
+    cv::KeyPointsFilter::retainBest(keypoints, budget);
+    if (static_cast<int>(keypoints.size()) > budget) keypoints.resize(budget);  // retainBest keeps ties
+
+    for (auto& kp : keypoints) {
+        kp.angle = ic_angle(level.data, level.step,
+                            static_cast<int>(kp.pt.x), static_cast<int>(kp.pt.y));
+    }
+}
+
+void orb_simd::describe_level(const cv::Mat& blurred, const std::vector<cv::KeyPoint>& keypoints,
+                              cv::Mat& descriptors) const {
+    const auto& pattern = orb_kernels::default_brief_pattern();
+    descriptors.create(static_cast<int>(keypoints.size()), 32, CV_8U);
+    for (size_t k = 0; k < keypoints.size(); ++k) {
+        orb_kernels::rbrief_describe(blurred.data, blurred.step,
+                                     cvRound(keypoints[k].pt.x), cvRound(keypoints[k].pt.y),
+                                     keypoints[k].angle, pattern,
+                                     descriptors.ptr<uint8_t>(static_cast<int>(k)), simd);
+    }
+}
+
+void orb_simd::run(const image_pyramid& pyr, const cv::Mat& mask,
+                   std::vector<cv::KeyPoint>& keypoints, cv::Mat* descriptors) {
+    const int n = static_cast<int>(pyr.size());
+    const std::vector<int> per_level = features_per_level(nfeatures, pyr.scale_factor, n);
+    levels.resize(n);
+
+    std::vector<std::vector<cv::KeyPoint>> level_kpts(n);
+    std::vector<cv::Mat> level_desc(n);
+
+    // Levels are independent; each owns its scratch and output slot
+    cv::parallel_for_(cv::Range(0, n), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i) {
+            if (per_level[i] <= 0) continue;
+            const cv::Mat& level = pyr.levels[i];
+
+            cv::Mat level_mask;
+            if (!mask.empty()) {
+                cv::resize(mask, level_mask, level.size(), 0, 0, cv::INTER_NEAREST);
+            }
+            detect_level(level, level_mask, i, per_level[i], levels[i], level_kpts[i]);
+            if (level_kpts[i].empty()) continue;
+
+            if (descriptors) {
+                smooth_level(level, levels[i].blurred);
+                describe_level(levels[i].blurred, level_kpts[i], level_desc[i]);
+            }
+
+            const float scale = pyr.scales[i];
+            for (auto& kp : level_kpts[i]) {
+                kp.pt.x *= scale;
+                kp.pt.y *= scale;
+                kp.size *= scale;
+            }
+        }
+    });
+
+    // Merge in level order so the output is deterministic
+    keypoints.clear();
+    std::vector<cv::Mat> nonempty;
+    for (int i = 0; i < n; ++i) {
+        keypoints.insert(keypoints.end(), level_kpts[i].begin(), level_kpts[i].end());
+        if (!level_desc[i].empty()) nonempty.push_back(level_desc[i]);
+    }
+    if (descriptors) {
+        if (nonempty.empty()) {
+            descriptors->release();
+        } else {
+            cv::vconcat(nonempty, *descriptors);
+        }
+    }
+}
+
+void orb_simd::compute_provided(const image_pyramid& pyr,
+                                std::vector<cv::KeyPoint>& keypoints, cv::Mat& descriptors) {
+    const int n = static_cast<int>(pyr.size());
+    levels.resize(n);
+    std::vector<bool> smoothed(n, false);
+
+    std::vector<cv::KeyPoint> kept;
+    kept.reserve(keypoints.size());
+    std::vector<cv::Point> level_pts;
+    level_pts.reserve(keypoints.size());
+
+    // Map each keypoint back onto its level and drop those too close to the border
+    for (const auto& kp : keypoints) {
+        const int octave = std::max(0, std::min(kp.octave, n - 1));
+        const float scale = pyr.scales[octave];
+        const cv::Mat& level = pyr.levels[octave];
+        const int x = cvRound(kp.pt.x / scale), y = cvRound(kp.pt.y / scale);
+        if (x < kDescribeMargin || y < kDescribeMargin ||
+            x >= level.cols - kDescribeMargin || y >= level.rows - kDescribeMargin) {
+            continue;
+        }
+        kept.push_back(kp);
+        kept.back().octave = octave;
+        if (kept.back().angle < 0) kept.back().angle = orb_kernels::ic_angle(level.data, level.step, x, y);
+        level_pts.emplace_back(x, y);
+    }
+
+    const auto& pattern = orb_kernels::default_brief_pattern();
+    descriptors.create(static_cast<int>(kept.size()), 32, CV_8U);
+    for (size_t k = 0; k < kept.size(); ++k) {
+        const int octave = kept[k].octave;
+        if (!smoothed[octave]) {
+            smooth_level(pyr.levels[octave], levels[octave].blurred);
+            smoothed[octave] = true;
+        }
+        const cv::Mat& blurred = levels[octave].blurred;
+        orb_kernels::rbrief_describe(blurred.data, blurred.step, level_pts[k].x, level_pts[k].y,
+                                     kept[k].angle, pattern,
+                                     descriptors.ptr<uint8_t>(static_cast<int>(k)), simd);
+    }
+    keypoints.swap(kept);
+}
@@ -0,0 +1,515 @@
+#include "core/orb_simd_kernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if INSIGHT_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace orb_kernels {
+
+namespace {
+
+// Bresenham circle of radius 3, clockwise from 12 o'clock
+const int kCircle[16][2] = {
+    {0, -3}, {1, -3}, {2, -2}, {3, -1}, {3, 0}, {3, 1}, {2, 2}, {1, 3},
+    {0, 3}, {-1, 3}, {-2, 2}, {-3, 1}, {-3, 0}, {-3, -1}, {-2, -2}, {-1, -3}
+};
+
+constexpr int kHalfPatch = 15;
+constexpr float kDegToRad = 0.017453292519943295f;
+
+void circle_offsets(size_t step, int offs[16]) {
+    for (int k = 0; k < 16; ++k) {
+        offs[k] = kCircle[k][1] * static_cast<int>(step) + kCircle[k][0];
+    }
+}
+
+// Sum of absolute differences beyond the threshold for the dominant side
+inline int fast_score(const uint8_t* p, const int* offs, int t) {
+    int v = p[0];
+    int bright = 0, dark = 0;
+    for (int k = 0; k < 16; ++k) {
+        int q = p[offs[k]];
+        if (q > v + t) bright += q - v - t;
+        else if (q < v - t) dark += v - t - q;
+    }
+    return std::max(bright, dark);
+}
+
+inline bool fast9_test(const uint8_t* p, const int* offs, int t) {
+    int v = p[0];
+    int hi = v + t, lo = v - t;
+    int run_b = 0, run_d = 0;
+    for (int k = 0; k < 25; ++k) {
+        int q = p[offs[k & 15]];
+        run_b = q > hi ? run_b + 1 : 0;
+        run_d = q < lo ? run_d + 1 : 0;
+        if (run_b >= 9 || run_d >= 9) return true;
+    }
+    return false;
+}
+
+void fast9_row_scalar(const uint8_t* row, const int* offs, int x0, int x1, int y, int t,
+                      std::vector<corner>& out) {
+    for (int x = x0; x < x1; ++x) {
+        const uint8_t* p = row + x;
+        if (fast9_test(p, offs, t)) out.push_back({x, y, fast_score(p, offs, t)});
+    }
+}
+
+#if INSIGHT_X86_SIMD
+
+// The segment test is done on 16/32/64 pixels at once: for each of the 25
+// circle positions (16 + 9 wrap-around) a per-lane run counter is incremented
+// where the pixel is brighter (darker) than centre +- t and reset elsewhere.
+// A lane is a corner once either running maximum reaches 9.
+
+__attribute__((target("sse4.2")))
+void fast9_row_sse42(const uint8_t* row, const int* offs, int x0, int x1, int y, int t,
+                     std::vector<corner>& out) {
+    const __m128i sign = _mm_set1_epi8(static_cast<char>(0x80));
+    const __m128i tv = _mm_set1_epi8(static_cast<char>(t));
+    const __m128i one = _mm_set1_epi8(1);
+    const __m128i nine = _mm_set1_epi8(9);
+
+    int x = x0;
+    for (; x + 16 <= x1; x += 16) {
+        const uint8_t* p = row + x;
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i hi = _mm_xor_si128(_mm_adds_epu8(v, tv), sign);
+        __m128i lo = _mm_xor_si128(_mm_subs_epu8(v, tv), sign);
+
+        // Any 9-arc covers two neighbouring compass points (0/4/8/12)
+        __m128i b[4], d[4];
+        for (int k = 0; k < 4; ++k) {
+            __m128i q = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + offs[4 * k])), sign);
+            b[k] = _mm_cmpgt_epi8(q, hi);
+            d[k] = _mm_cmpgt_epi8(lo, q);
+        }
+        __m128i maybe = _mm_or_si128(
+            _mm_or_si128(_mm_or_si128(_mm_and_si128(b[0], b[1]), _mm_and_si128(b[1], b[2])),
+                         _mm_or_si128(_mm_and_si128(b[2], b[3]), _mm_and_si128(b[3], b[0]))),
+            _mm_or_si128(_mm_or_si128(_mm_and_si128(d[0], d[1]), _mm_and_si128(d[1], d[2])),
+                         _mm_or_si128(_mm_and_si128(d[2], d[3]), _mm_and_si128(d[3], d[0]))));
+        if (_mm_movemask_epi8(maybe) == 0) continue;
+
+        __m128i run_b = _mm_setzero_si128(), run_d = _mm_setzero_si128();
+        __m128i max_b = _mm_setzero_si128(), max_d = _mm_setzero_si128();
+        for (int k = 0; k < 25; ++k) {
+            __m128i q = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + offs[k & 15])), sign);
+            run_b = _mm_and_si128(_mm_add_epi8(run_b, one), _mm_cmpgt_epi8(q, hi));
+            run_d = _mm_and_si128(_mm_add_epi8(run_d, one), _mm_cmpgt_epi8(lo, q));
+            max_b = _mm_max_epu8(max_b, run_b);
+            max_d = _mm_max_epu8(max_d, run_d);
+        }
+        __m128i is_corner = _mm_or_si128(_mm_cmpeq_epi8(_mm_max_epu8(max_b, nine), max_b),
+                                         _mm_cmpeq_epi8(_mm_max_epu8(max_d, nine), max_d));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(is_corner));
+        while (mask) {
+            int i = __builtin_ctz(mask);
+            mask &= mask - 1;
+            out.push_back({x + i, y, fast_score(p + i, offs, t)});
+        }
+    }
+    fast9_row_scalar(row, offs, x, x1, y, t, out);
+}
+
+__attribute__((target("avx2")))
+void fast9_row_avx2(const uint8_t* row, const int* offs, int x0, int x1, int y, int t,
+                    std::vector<corner>& out) {
+    const __m256i sign = _mm256_set1_epi8(static_cast<char>(0x80));
+    const __m256i tv = _mm256_set1_epi8(static_cast<char>(t));
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i nine = _mm256_set1_epi8(9);
+
+    int x = x0;
+    for (; x + 32 <= x1; x += 32) {
+        const uint8_t* p = row + x;
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i hi = _mm256_xor_si256(_mm256_adds_epu8(v, tv), sign);
+        __m256i lo = _mm256_xor_si256(_mm256_subs_epu8(v, tv), sign);
+
+        __m256i b[4], d[4];
+        for (int k = 0; k < 4; ++k) {
+            __m256i q = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + offs[4 * k])), sign);
+            b[k] = _mm256_cmpgt_epi8(q, hi);
+            d[k] = _mm256_cmpgt_epi8(lo, q);
+        }
+        __m256i maybe = _mm256_or_si256(
+            _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(b[0], b[1]), _mm256_and_si256(b[1], b[2])),
+                            _mm256_or_si256(_mm256_and_si256(b[2], b[3]), _mm256_and_si256(b[3], b[0]))),
+            _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(d[0], d[1]), _mm256_and_si256(d[1], d[2])),
+                            _mm256_or_si256(_mm256_and_si256(d[2], d[3]), _mm256_and_si256(d[3], d[0]))));
+        if (_mm256_movemask_epi8(maybe) == 0) continue;
+
+        __m256i run_b = _mm256_setzero_si256(), run_d = _mm256_setzero_si256();
+        __m256i max_b = _mm256_setzero_si256(), max_d = _mm256_setzero_si256();
+        for (int k = 0; k < 25; ++k) {
+            __m256i q = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + offs[k & 15])), sign);
+            run_b = _mm256_and_si256(_mm256_add_epi8(run_b, one), _mm256_cmpgt_epi8(q, hi));
+            run_d = _mm256_and_si256(_mm256_add_epi8(run_d, one), _mm256_cmpgt_epi8(lo, q));
+            max_b = _mm256_max_epu8(max_b, run_b);
+            max_d = _mm256_max_epu8(max_d, run_d);
+        }
+        __m256i is_corner = _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_max_epu8(max_b, nine), max_b),
+                                            _mm256_cmpeq_epi8(_mm256_max_epu8(max_d, nine), max_d));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(is_corner));
+        while (mask) {
+            int i = __builtin_ctz(mask);
+            mask &= mask - 1;
+            out.push_back({x + i, y, fast_score(p + i, offs, t)});
+        }
+    }
+    fast9_row_scalar(row, offs, x, x1, y, t, out);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+void fast9_row_avx512(const uint8_t* row, const int* offs, int x0, int x1, int y, int t,
+                      std::vector<corner>& out) {
+    const __m512i tv = _mm512_set1_epi8(static_cast<char>(t));
+    const __m512i one = _mm512_set1_epi8(1);
+    const __m512i nine = _mm512_set1_epi8(9);
+
+    int x = x0;
+    for (; x + 64 <= x1; x += 64) {
+        const uint8_t* p = row + x;
+        __m512i v = _mm512_loadu_si512(p);
+        __m512i hi = _mm512_adds_epu8(v, tv);
+        __m512i lo = _mm512_subs_epu8(v, tv);
+
+        __mmask64 b[4], d[4];
+        for (int k = 0; k < 4; ++k) {
+            __m512i q = _mm512_loadu_si512(p + offs[4 * k]);
+            b[k] = _mm512_cmpgt_epu8_mask(q, hi);
+            d[k] = _mm512_cmplt_epu8_mask(q, lo);
+        }
+        uint64_t maybe = (b[0] & b[1]) | (b[1] & b[2]) | (b[2] & b[3]) | (b[3] & b[0])
+                       | (d[0] & d[1]) | (d[1] & d[2]) | (d[2] & d[3]) | (d[3] & d[0]);
+        if (maybe == 0) continue;
+
+        __m512i run_b = _mm512_setzero_si512(), run_d = _mm512_setzero_si512();
+        __m512i max_b = _mm512_setzero_si512(), max_d = _mm512_setzero_si512();
+        for (int k = 0; k < 25; ++k) {
+            __m512i q = _mm512_loadu_si512(p + offs[k & 15]);
+            run_b = _mm512_maskz_add_epi8(_mm512_cmpgt_epu8_mask(q, hi), run_b, one);
+            run_d = _mm512_maskz_add_epi8(_mm512_cmplt_epu8_mask(q, lo), run_d, one);
+            max_b = _mm512_max_epu8(max_b, run_b);
+            max_d = _mm512_max_epu8(max_d, run_d);
+        }
+        uint64_t mask = _mm512_cmpge_epu8_mask(max_b, nine) | _mm512_cmpge_epu8_mask(max_d, nine);
+        while (mask) {
+            int i = __builtin_ctzll(mask);
+            mask &= mask - 1;
+            out.push_back({x + i, y, fast_score(p + i, offs, t)});
+        }
+    }
+    fast9_row_scalar(row, offs, x, x1, y, t, out);
+}
+
+#endif  // INSIGHT_X86_SIMD
+
+float harris_finish(int a, int b, int c, float k) {
+    // Same normalisation as cv::ORB (Sobel gain 4, 7x7 block, 8-bit range)
+    const float scale = 1.f / ((1 << 2) * 7 * 255.f);
+    const float scale_sq_sq = scale * scale * scale * scale;
+    return ((float)a * b - (float)c * c - k * ((float)a + b) * ((float)a + b)) * scale_sq_sq;
+}
+
+float harris_scalar(const uint8_t* img, size_t step, int x, int y, float k) {
+    const int s = static_cast<int>(step);
+    int a = 0, b = 0, c = 0;
+    for (int yy = y - 3; yy <= y + 3; ++yy) {
+        const uint8_t* ptr = img + yy * step + (x - 3);
+        for (int i = 0; i < 7; ++i, ++ptr) {
+            int dx = (ptr[1] - ptr[-1]) * 2 + (ptr[-s + 1] - ptr[-s - 1]) + (ptr[s + 1] - ptr[s - 1]);
+            int dy = (ptr[s] - ptr[-s]) * 2 + (ptr[s - 1] - ptr[-s - 1]) + (ptr[s + 1] - ptr[-s + 1]);
+            a += dx * dx;
+            b += dy * dy;
+            c += dx * dy;
+        }
+    }
+    return harris_finish(a, b, c, k);
+}
+
+#if INSIGHT_X86_SIMD
+
+// One 7-pixel block row per iteration in 16-bit lanes (lane 7 masked off);
+// madd folds the products into 32-bit accumulators.
+__attribute__((target("sse4.2")))
+float harris_sse42(const uint8_t* img, size_t step, int x, int y, float k) {
+    const __m128i lane_mask = _mm_setr_epi16(-1, -1, -1, -1, -1, -1, -1, 0);
+    __m128i sa = _mm_setzero_si128(), sb = _mm_setzero_si128(), sc = _mm_setzero_si128();
+
+    for (int yy = y - 3; yy <= y + 3; ++yy) {
+        const uint8_t* up = img + (yy - 1) * step + x;
+        const uint8_t* mid = img + yy * step + x;
+        const uint8_t* down = img + (yy + 1) * step + x;
+
+        // L = column - 1, M = column, R = column + 1 for the 7 block columns
+        __m128i l_up = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(up - 4)));
+        __m128i r_up = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(up - 2)));
+        __m128i m_up = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(up - 3)));
+        __m128i l_mid = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(mid - 4)));
+        __m128i r_mid = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(mid - 2)));
+        __m128i l_dn = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(down - 4)));
+        __m128i r_dn = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(down - 2)));
+        __m128i m_dn = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(down - 3)));
+
+        __m128i dx = _mm_add_epi16(_mm_slli_epi16(_mm_sub_epi16(r_mid, l_mid), 1),
+                                   _mm_add_epi16(_mm_sub_epi16(r_up, l_up), _mm_sub_epi16(r_dn, l_dn)));
+        __m128i dy = _mm_add_epi16(_mm_slli_epi16(_mm_sub_epi16(m_dn, m_up), 1),
+                                   _mm_add_epi16(_mm_sub_epi16(l_dn, l_up), _mm_sub_epi16(r_dn, r_up)));
+        dx = _mm_and_si128(dx, lane_mask);
+        dy = _mm_and_si128(dy, lane_mask);
+
+        sa = _mm_add_epi32(sa, _mm_madd_epi16(dx, dx));
+        sb = _mm_add_epi32(sb, _mm_madd_epi16(dy, dy));
+        sc = _mm_add_epi32(sc, _mm_madd_epi16(dx, dy));
+    }
+
+    // Horizontal sums of the three accumulators
+    __m128i ab = _mm_hadd_epi32(sa, sb);
+    __m128i cc = _mm_hadd_epi32(sc, sc);
+    __m128i abcc = _mm_hadd_epi32(ab, cc);
+    int a = _mm_extract_epi32(abcc, 0);
+    int b = _mm_extract_epi32(abcc, 1);
+    int c = _mm_extract_epi32(abcc, 2);
+    return harris_finish(a, b, c, k);
+}
+
+#endif  // INSIGHT_X86_SIMD
+
+void rbrief_scalar(const uint8_t* center, int step, float c, float s,
+                   const brief_pattern& pat, uint8_t* desc) {
+    for (int byte = 0; byte < 32; ++byte) {
+        int value = 0;
+        for (int bit = 0; bit < 8; ++bit) {
+            int i = byte * 8 + bit;
+            float ax_r = pat.ax[i] * c - pat.ay[i] * s;
+            float ay_r = pat.ax[i] * s + pat.ay[i] * c;
+            float bx_r = pat.bx[i] * c - pat.by[i] * s;
+            float by_r = pat.bx[i] * s + pat.by[i] * c;
+            int va = center[static_cast<int>(std::lrint(ay_r)) * step + static_cast<int>(std::lrint(ax_r))];
+            int vb = center[static_cast<int>(std::lrint(by_r)) * step + static_cast<int>(std::lrint(bx_r))];
+            value |= (va < vb) << bit;
+        }
+        desc[byte] = static_cast<uint8_t>(value);
+    }
+}
+
+#if INSIGHT_X86_SIMD
+
+// 8 pairs per step: rotate the pattern points, round, turn them into byte
+// offsets and gather. Gathers read 4 bytes, so only the low byte is kept.
+__attribute__((target("avx2")))
+void rbrief_avx2(const uint8_t* center, int step, float c, float s,
+                 const brief_pattern& pat, uint8_t* desc) {
+    const __m256 vc = _mm256_set1_ps(c), vs = _mm256_set1_ps(s);
+    const __m256i vstep = _mm256_set1_epi32(step);
+    const __m256i low_byte = _mm256_set1_epi32(0xFF);
+    const int* base = reinterpret_cast<const int*>(center);
+
+    for (int byte = 0; byte < 32; ++byte) {
+        const int i = byte * 8;
+        __m256 ax = _mm256_load_ps(pat.ax + i), ay = _mm256_load_ps(pat.ay + i);
+        __m256 bx = _mm256_load_ps(pat.bx + i), by = _mm256_load_ps(pat.by + i);
+
+        __m256i ax_r = _mm256_cvtps_epi32(_mm256_sub_ps(_mm256_mul_ps(ax, vc), _mm256_mul_ps(ay, vs)));
+        __m256i ay_r = _mm256_cvtps_epi32(_mm256_add_ps(_mm256_mul_ps(ax, vs), _mm256_mul_ps(ay, vc)));
+        __m256i bx_r = _mm256_cvtps_epi32(_mm256_sub_ps(_mm256_mul_ps(bx, vc), _mm256_mul_ps(by, vs)));
+        __m256i by_r = _mm256_cvtps_epi32(_mm256_add_ps(_mm256_mul_ps(bx, vs), _mm256_mul_ps(by, vc)));
+
+        __m256i off_a = _mm256_add_epi32(_mm256_mullo_epi32(ay_r, vstep), ax_r);
+        __m256i off_b = _mm256_add_epi32(_mm256_mullo_epi32(by_r, vstep), bx_r);
+        __m256i va = _mm256_and_si256(_mm256_i32gather_epi32(base, off_a, 1), low_byte);
+        __m256i vb = _mm256_and_si256(_mm256_i32gather_epi32(base, off_b, 1), low_byte);
+
+        __m256i lt = _mm256_cmpgt_epi32(vb, va);
+        desc[byte] = static_cast<uint8_t>(_mm256_movemask_ps(_mm256_castsi256_ps(lt)));
+    }
+}
+
+// 16 pairs per step; the comparison mask is directly two descriptor bytes.
+__attribute__((target("avx512f,avx512bw")))
+void rbrief_avx512(const uint8_t* center, int step, float c, float s,
+                   const brief_pattern& pat, uint8_t* desc) {
+    const __m512 vc = _mm512_set1_ps(c), vs = _mm512_set1_ps(s);
+    const __m512i vstep = _mm512_set1_epi32(step);
+    const __m512i low_byte = _mm512_set1_epi32(0xFF);
+    const void* base = center;
+
+    for (int half = 0; half < 16; ++half) {
+        const int i = half * 16;
+        __m512 ax = _mm512_load_ps(pat.ax + i), ay = _mm512_load_ps(pat.ay + i);
+        __m512 bx = _mm512_load_ps(pat.bx + i), by = _mm512_load_ps(pat.by + i);
+
+        __m512i ax_r = _mm512_cvtps_epi32(_mm512_sub_ps(_mm512_mul_ps(ax, vc), _mm512_mul_ps(ay, vs)));
+        __m512i ay_r = _mm512_cvtps_epi32(_mm512_add_ps(_mm512_mul_ps(ax, vs), _mm512_mul_ps(ay, vc)));
+        __m512i bx_r = _mm512_cvtps_epi32(_mm512_sub_ps(_mm512_mul_ps(bx, vc), _mm512_mul_ps(by, vs)));
+        __m512i by_r = _mm512_cvtps_epi32(_mm512_add_ps(_mm512_mul_ps(bx, vs), _mm512_mul_ps(by, vc)));
+
+        __m512i off_a = _mm512_add_epi32(_mm512_mullo_epi32(ay_r, vstep), ax_r);
+        __m512i off_b = _mm512_add_epi32(_mm512_mullo_epi32(by_r, vstep), bx_r);
+        __m512i va = _mm512_and_si512(_mm512_i32gather_epi32(off_a, base, 1), low_byte);
+        __m512i vb = _mm512_and_si512(_mm512_i32gather_epi32(off_b, base, 1), low_byte);
+
+        __mmask16 lt = _mm512_cmplt_epi32_mask(va, vb);
+        desc[2 * half] = static_cast<uint8_t>(lt & 0xFF);
+        desc[2 * half + 1] = static_cast<uint8_t>(lt >> 8);
+    }
+}
+
+#endif  // INSIGHT_X86_SIMD
+
+brief_pattern make_brief_pattern() {
+    // Isotropic Gaussian sampling (BRIEF G II, sigma^2 = S^2/25 for S = 31),
+    // clipped to the radius-15 disc, from a fixed xorshift stream.
+    brief_pattern pat;
+    uint32_t state = 0x2F6B1D3Bu;
+    auto next_uniform = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return (state >> 8) * (1.0 / 16777216.0) + 0.5 / 16777216.0;
+    };
+    auto next_point = [&](float& px, float& py) {
+        const double sigma = 31.0 / 5.0;
+        for (;;) {
+            double u1 = next_uniform(), u2 = next_uniform();
+            double r = std::sqrt(-2.0 * std::log(u1)) * sigma;
+            double gx = std::round(r * std::cos(2.0 * 3.14159265358979323846 * u2));
+            double gy = std::round(r * std::sin(2.0 * 3.14159265358979323846 * u2));
+            if (gx * gx + gy * gy <= kHalfPatch * kHalfPatch) {
+                px = static_cast<float>(gx);
+                py = static_cast<float>(gy);
+                return;
+            }
+        }
+    };
+    for (int i = 0; i < 256; ++i) {
+        do {
+            next_point(pat.ax[i], pat.ay[i]);
+            next_point(pat.bx[i], pat.by[i]);
+        } while (pat.ax[i] == pat.bx[i] && pat.ay[i] == pat.by[i]);
+    }
+    return pat;
+}
+
+}  // namespace
+
+const brief_pattern& default_brief_pattern() {
+    static const brief_pattern pattern = make_brief_pattern();
+    return pattern;
+}
+
+void fast9_detect(const uint8_t* img, size_t step, int width, int height,
+                  int threshold, int border, std::vector<corner>& out, simd_level level) {
+    border = std::max(border, 3);
+    threshold = std::clamp(threshold, 1, 254);
+    if (width <= 2 * border || height <= 2 * border) return;
+
+    int offs[16];
+    circle_offsets(step, offs);
+    const int x0 = border, x1 = width - border;
+
+    for (int y = border; y < height - border; ++y) {
+        const uint8_t* row = img + y * step;
+        switch (level) {
+#if INSIGHT_X86_SIMD
+            case simd_level::AVX512: fast9_row_avx512(row, offs, x0, x1, y, threshold, out); break;
+            case simd_level::AVX2:   fast9_row_avx2(row, offs, x0, x1, y, threshold, out); break;
+            case simd_level::SSE42:  fast9_row_sse42(row, offs, x0, x1, y, threshold, out); break;
+#endif
+            default:                 fast9_row_scalar(row, offs, x0, x1, y, threshold, out); break;
+        }
+    }
+}
+
+void fast9_nonmax(const std::vector<corner>& in, int width, int height,
+                  std::vector<uint16_t>& scratch, std::vector<corner>& out) {
+    scratch.assign(static_cast<size_t>(width) * height, 0);
+    for (const auto& c : in) {
+        scratch[static_cast<size_t>(c.y) * width + c.x] = static_cast<uint16_t>(std::min(c.score, 65535));
+    }
+
+    out.clear();
+    for (const auto& c : in) {
+        if (c.x < 1 || c.y < 1 || c.x >= width - 1 || c.y >= height - 1) continue;
+        const uint16_t* up = &scratch[static_cast<size_t>(c.y - 1) * width + c.x];
+        const uint16_t* mid = up + width;
+        const uint16_t* down = mid + width;
+        const int s = mid[0];
+        if (s > up[-1] && s > up[0] && s > up[1] &&
+            s > mid[-1] && s > mid[1] &&
+            s > down[-1] && s > down[0] && s > down[1]) {
+            out.push_back(c);
+        }
+    }
+}
+
+float harris_response(const uint8_t* img, size_t step, int x, int y, float k, simd_level level) {
+#if INSIGHT_X86_SIMD
+    if (level != simd_level::SCALAR) return harris_sse42(img, step, x, y, k);
+#endif
+    (void)level;
+    return harris_scalar(img, step, x, y, k);
+}
+
+float ic_angle(const uint8_t* img, size_t step, int x, int y) {
+    // Half-widths of the radius-15 disc per row, symmetric as in cv::ORB
+    static const std::vector<int> umax = [] {
+        std::vector<int> u(kHalfPatch + 2);
+        int vmax = static_cast<int>(std::floor(kHalfPatch * std::sqrt(2.0) / 2 + 1));
+        int vmin = static_cast<int>(std::ceil(kHalfPatch * std::sqrt(2.0) / 2));
+        for (int v = 0; v <= vmax; ++v) {
+            u[v] = static_cast<int>(std::lround(std::sqrt(static_cast<double>(kHalfPatch * kHalfPatch - v * v))));
+        }
+        for (int v = kHalfPatch, v0 = 0; v >= vmin; --v) {
+            while (u[v0] == u[v0 + 1]) ++v0;
+            u[v] = v0;
+            ++v0;
+        }
+        return u;
+    }();
+
+    const int s = static_cast<int>(step);
+    const uint8_t* center = img + y * step + x;
+    int m_01 = 0, m_10 = 0;
+
+    for (int u = -kHalfPatch; u <= kHalfPatch; ++u) m_10 += u * center[u];
+
+    for (int v = 1; v <= kHalfPatch; ++v) {
+        int v_sum = 0;
+        int d = umax[v];
+        for (int u = -d; u <= d; ++u) {
+            int val_plus = center[u + v * s], val_minus = center[u - v * s];
+            v_sum += val_plus - val_minus;
+            m_10 += u * (val_plus + val_minus);
+        }
+        m_01 += v * v_sum;
+    }
+
+    float angle = static_cast<float>(std::atan2(static_cast<double>(m_01), static_cast<double>(m_10)) * 180.0 / 3.14159265358979323846);
+    if (angle < 0) angle += 360.0f;
+    return angle;
+}
+
+void rbrief_describe(const uint8_t* img, size_t step, int x, int y, float angle_deg,
+                     const brief_pattern& pattern, uint8_t* desc, simd_level level) {
+    const float rad = angle_deg * kDegToRad;
+    const float c = std::cos(rad), s = std::sin(rad);
+    const uint8_t* center = img + y * step + x;
+    const int istep = static_cast<int>(step);
+
+    switch (level) {
+#if INSIGHT_X86_SIMD
+        case simd_level::AVX512: rbrief_avx512(center, istep, c, s, pattern, desc); break;
+        case simd_level::AVX2:   rbrief_avx2(center, istep, c, s, pattern, desc); break;
+#endif
+        default:                 rbrief_scalar(center, istep, c, s, pattern, desc); break;
+    }
+}
+
+}  // namespace orb_kernels
@@ -0,0 +1,263 @@
+#include "core/robust_estimation.hpp"
+#include <opencv2/calib3d.hpp>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+
+cv::UsacParams usac_params(const robust_config& cfg, bool ordered) {
+    cv::UsacParams p;
+    p.threshold = cfg.threshold;
+    p.confidence = cfg.confidence;
+    p.maxIterations = cfg.max_iterations;
+    p.isParallel = cfg.parallel;
+    // PROSAC only makes sense on quality-ordered input
+    p.sampler = ordered ? cv::SAMPLING_PROSAC : cv::SAMPLING_UNIFORM;
+    if (cfg.method == robust_method::MAGSAC) {
+        p.score = cv::SCORE_METHOD_MAGSAC;
+        p.loMethod = cv::LOCAL_OPTIM_SIGMA;
+        p.loIterations = 10;
+        p.loSampleSize = 50;
+    } else {
+        p.score = cv::SCORE_METHOD_MSAC;
+        p.loMethod = cv::LOCAL_OPTIM_INNER_AND_ITER_LO;
+        p.loIterations = 10;
+        p.loSampleSize = 14;
+    }
+    return p;
+}
+
+// Best-first order of the correspondences by match distance (stable, so
+// ties keep the matcher's order)
+std::vector<int> quality_order(const std::vector<cv::DMatch>& matches) {
+    std::vector<int> order(matches.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&matches](int a, int b) { return matches[a].distance < matches[b].distance; });
+    return order;
+}
+
+// Runs `fit` on the points in quality order when distances are available
+// and maps the mask back to the caller's order
+template <typename Fit>
+cv::Mat fit_ordered(const std::vector<cv::Point2f>& pts1, const std::vector<cv::Point2f>& pts2,
+                    const std::vector<cv::DMatch>* matches, cv::Mat& mask, Fit&& fit) {
+    const bool ordered = matches && matches->size() == pts1.size();
+    if (!ordered) return fit(pts1, pts2, false, mask);
+
+    const std::vector<int> order = quality_order(*matches);
+    std::vector<cv::Point2f> sorted1(pts1.size()), sorted2(pts2.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        sorted1[i] = pts1[order[i]];
+        sorted2[i] = pts2[order[i]];
+    }
+
+    cv::Mat sorted_mask;
+    cv::Mat model = fit(sorted1, sorted2, true, sorted_mask);
+    if (model.empty() || sorted_mask.total() != order.size()) {
+        mask.release();
+        return model;
+    }
+
+    mask.create(static_cast<int>(order.size()), 1, CV_8U);
+    const uchar* src = sorted_mask.ptr<uchar>(0);
+    for (size_t i = 0; i < order.size(); ++i) mask.at<uchar>(order[i], 0) = src[i];
+    return model;
+}
+
+}  // namespace
+
+cv::Mat estimate_essential(const std::vector<cv::Point2f>& pts1, const std::vector<cv::Point2f>& pts2,
+                           const cv::Mat& K, const std::vector<cv::DMatch>* matches,
+                           const robust_config& cfg, cv::Mat& mask) {
+    if (cfg.method == robust_method::RANSAC) {
+        return cv::findEssentialMat(pts1, pts2, K, cv::RANSAC, cfg.confidence, cfg.threshold,
+                                    cfg.max_iterations, mask);
+    }
+    return fit_ordered(pts1, pts2, matches, mask,
+        [&](const std::vector<cv::Point2f>& a, const std::vector<cv::Point2f>& b, bool ordered, cv::Mat& m) {
+            return cv::findEssentialMat(a, b, K, K, cv::noArray(), cv::noArray(), m, usac_params(cfg, ordered));
+        });
+}
+
+cv::Mat estimate_homography(const std::vector<cv::Point2f>& pts1, const std::vector<cv::Point2f>& pts2,
+                            const std::vector<cv::DMatch>* matches,
+                            const robust_config& cfg, cv::Mat& mask) {
+    if (cfg.method == robust_method::RANSAC) {
+        return cv::findHomography(pts1, pts2, cv::RANSAC, cfg.threshold, mask, cfg.max_iterations, cfg.confidence);
+    }
+    return fit_ordered(pts1, pts2, matches, mask,
+        [&](const std::vector<cv::Point2f>& a, const std::vector<cv::Point2f>& b, bool ordered, cv::Mat& m) {
+            return cv::findHomography(a, b, m, usac_params(cfg, ordered));
+        });
+}
+
+namespace {
+
+cv::Matx33d skew(const cv::Vec3d& v) {
+    return cv::Matx33d(0, -v[2], v[1],
+                       v[2], 0, -v[0],
+                       -v[1], v[0], 0);
+}
+
+// Rotation by the axis-angle vector w
+cv::Matx33d exp_so3(const cv::Vec3d& w) {
+    const double theta = std::sqrt(w.dot(w));
+    const cv::Matx33d W = skew(w);
+    if (theta < 1e-12) return cv::Matx33d::eye() + W;
+    return cv::Matx33d::eye() + W * (std::sin(theta) / theta) +
+           W * W * ((1.0 - std::cos(theta)) / (theta * theta));
+}
+
+// Pixel-space fundamental matrix of the pose
+cv::Matx33d fundamental(const cv::Matx33d& R, const cv::Vec3d& t, const cv::Matx33d& K_inv) {
+    return K_inv.t() * skew(t) * R * K_inv;
+}
+
+// Signed Sampson residual; its square is the Sampson distance
+inline double sampson(const cv::Matx33d& F, const cv::Point2f& p1, const cv::Point2f& p2) {
+    const double x1 = p1.x, y1 = p1.y, x2 = p2.x, y2 = p2.y;
+    const double a0 = F(0, 0) * x1 + F(0, 1) * y1 + F(0, 2);
+    const double a1 = F(1, 0) * x1 + F(1, 1) * y1 + F(1, 2);
+    const double a2 = F(2, 0) * x1 + F(2, 1) * y1 + F(2, 2);
+    const double b0 = F(0, 0) * x2 + F(1, 0) * y2 + F(2, 0);
+    const double b1 = F(0, 1) * x2 + F(1, 1) * y2 + F(2, 1);
+    const double den = a0 * a0 + a1 * a1 + b0 * b0 + b1 * b1;
+    if (den <= 0.0) return 0.0;
+    return (x2 * a0 + y2 * a1 + a2) / std::sqrt(den);
+}
+
+// Cheirality as recoverPose checks it: the point triangulated from the two
+// normalized rays lies in front of both cameras and closer than 50
+// baselines. Depths solve z2 x2 = z1 R x1 + t in least squares.
+bool in_front(const cv::Matx33d& R, const cv::Vec3d& t, const cv::Vec3d& x1, const cv::Vec3d& x2) {
+    constexpr double kMaxDepth = 50.0;
+    const cv::Vec3d a = R * x1;
+    const double aa = a.dot(a), ab = a.dot(x2), bb = x2.dot(x2);
+    const double det = aa * bb - ab * ab;
+    if (det <= 1e-12 * aa * bb) return false;   // Parallel rays: no depth to check
+    const double at = a.dot(t), bt = x2.dot(t);
+    const double z1 = (ab * bt - bb * at) / det;
+    const double z2 = (aa * bt - ab * at) / det;
+    return z1 > 0.0 && z2 > 0.0 && z1 < kMaxDepth && z2 < kMaxDepth;
+}
+
+// Pose perturbed by the 5-vector d: rotation delta d[0..2] applied on the
+// left, translation moved along the tangent basis (u, v) and renormalized
+void apply_delta(const cv::Matx33d& R, const cv::Vec3d& t, const cv::Vec3d& u, const cv::Vec3d& v,
+                 const double* d, cv::Matx33d& R_out, cv::Vec3d& t_out) {
+    R_out = exp_so3(cv::Vec3d(d[0], d[1], d[2])) * R;
+    t_out = t + u * d[3] + v * d[4];
+    t_out = t_out * (1.0 / std::sqrt(t_out.dot(t_out)));
+}
+
+double masked_cost(const cv::Matx33d& F, const std::vector<cv::Point2f>& pts1,
+                   const std::vector<cv::Point2f>& pts2, const uchar* mask) {
+    double cost = 0.0;
+    for (size_t i = 0; i < pts1.size(); ++i) {
+        if (!mask[i]) continue;
+        const double r = sampson(F, pts1[i], pts2[i]);
+        cost += r * r;
+    }
+    return cost;
+}
+
+}  // namespace
+
+int count_pose_inliers(const cv::Matx33d& R, const cv::Vec3d& t,
+                       const std::vector<cv::Point2f>& pts1, const std::vector<cv::Point2f>& pts2,
+                       const cv::Matx33d& K, double threshold, cv::Mat& mask) {
+    const cv::Matx33d K_inv = K.inv();
+    const cv::Matx33d F = fundamental(R, t, K_inv);
+    const double threshold_sq = threshold * threshold;
+    mask.create(static_cast<int>(pts1.size()), 1, CV_8U);
+    int inliers = 0;
+    for (size_t i = 0; i < pts1.size(); ++i) {
+        const double r = sampson(F, pts1[i], pts2[i]);
+        const bool in = r * r < threshold_sq &&
+                        in_front(R, t, K_inv * cv::Vec3d(pts1[i].x, pts1[i].y, 1.0),
+                                 K_inv * cv::Vec3d(pts2[i].x, pts2[i].y, 1.0));
+        mask.at<uchar>(static_cast<int>(i), 0) = in ? 1 : 0;
+        inliers += in;
+    }
+    return inliers;
+}
+
+bool refine_pose(cv::Matx33d& R, cv::Vec3d& t,
+                 const std::vector<cv::Point2f>& pts1, const std::vector<cv::Point2f>& pts2,
+                 const cv::Matx33d& K, const cv::Mat& mask, int iterations) {
+    if (mask.total() != pts1.size() || pts1.size() != pts2.size()) return false;
+    const uchar* in = mask.ptr<uchar>(0);
+    if (cv::countNonZero(mask) < 5) return false;
+
+    const cv::Matx33d K_inv = K.inv();
+    constexpr double kStep = 1e-6;   // Forward-difference step
+    double lambda = 1e-3;
+    double cost = masked_cost(fundamental(R, t, K_inv), pts1, pts2, in);
+    bool improved = false;
+
+    for (int it = 0; it < iterations; ++it) {
+        // Tangent basis of the unit sphere at t
+        const cv::Vec3d axis = std::abs(t[0]) < 0.9 ? cv::Vec3d(1, 0, 0) : cv::Vec3d(0, 1, 0);
+        cv::Vec3d u = t.cross(axis);
+        u = u * (1.0 / std::sqrt(u.dot(u)));
+        const cv::Vec3d v = t.cross(u);
+
+        // Numeric Jacobian of every residual, accumulated straight into the
+        // normal equations so no n x 5 matrix is stored
+        cv::Matx33d F[6];
+        F[0] = fundamental(R, t, K_inv);
+        for (int k = 0; k < 5; ++k) {
+            double d[5] = {0, 0, 0, 0, 0};
+            d[k] = kStep;
+            cv::Matx33d Rk;
+            cv::Vec3d tk;
+            apply_delta(R, t, u, v, d, Rk, tk);
+            F[k + 1] = fundamental(Rk, tk, K_inv);
+        }
+
+        cv::Matx<double, 5, 5> JtJ = cv::Matx<double, 5, 5>::zeros();
+        cv::Matx<double, 5, 1> Jtr = cv::Matx<double, 5, 1>::zeros();
+        for (size_t i = 0; i < pts1.size(); ++i) {
+            if (!in[i]) continue;
+            const double r = sampson(F[0], pts1[i], pts2[i]);
+            double J[5];
+            for (int k = 0; k < 5; ++k) J[k] = (sampson(F[k + 1], pts1[i], pts2[i]) - r) / kStep;
+            for (int a = 0; a < 5; ++a) {
+                Jtr(a, 0) += J[a] * r;
+                for (int b = a; b < 5; ++b) JtJ(a, b) += J[a] * J[b];
+            }
+        }
+        for (int a = 0; a < 5; ++a) {
+            for (int b = 0; b < a; ++b) JtJ(a, b) = JtJ(b, a);
+        }
+
+        // Damped step; grow the damping until the error goes down
+        bool stepped = false;
+        for (int attempt = 0; attempt < 5 && !stepped; ++attempt) {
+            cv::Matx<double, 5, 5> A = JtJ;
+            for (int a = 0; a < 5; ++a) A(a, a) += lambda * (JtJ(a, a) + 1e-12);
+            cv::Matx<double, 5, 1> delta;
+            if (!cv::solve(A, -Jtr, delta, cv::DECOMP_CHOLESKY)) {
+                lambda *= 10.0;
+                continue;
+            }
+            cv::Matx33d R_new;
+            cv::Vec3d t_new;
+            apply_delta(R, t, u, v, delta.val, R_new, t_new);
+            const double new_cost = masked_cost(fundamental(R_new, t_new, K_inv), pts1, pts2, in);
+            if (new_cost < cost) {
+                R = R_new;
+                t = t_new;
+                cost = new_cost;
+                lambda = std::max(lambda * 0.1, 1e-9);
+                stepped = improved = true;
+            } else {
+                lambda *= 10.0;
+            }
+        }
+        if (!stepped) break;
+    }
+    return improved;
+}
@@ -0,0 +1,460 @@
+#include "core/sliding_window_ba.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+using Matx63d = cv::Matx<double, 6, 3>;
+using Matx66d = cv::Matx<double, 6, 6>;
+using Matx26d = cv::Matx<double, 2, 6>;
+using Vec6d = cv::Vec<double, 6>;
+
+cv::Matx33d skew(const cv::Vec3d& v) {
+    return cv::Matx33d(0, -v[2], v[1],
+                       v[2], 0, -v[0],
+                       -v[1], v[0], 0);
+}
+
+cv::Matx33d exp_so3(const cv::Vec3d& w) {
+    const double theta = std::sqrt(w.dot(w));
+    const cv::Matx33d W = skew(w);
+    if (theta < 1e-12) return cv::Matx33d::eye() + W;
+    return cv::Matx33d::eye() + W * (std::sin(theta) / theta) +
+           W * W * ((1.0 - std::cos(theta)) / (theta * theta));
+}
+
+// Current estimate, indexed by window slot and optimized landmark
+struct estimate {
+    std::vector<cv::Matx33d> R;
+    std::vector<cv::Vec3d> t;
+    std::vector<cv::Vec3d> X;
+};
+
+// Observations of the optimized landmarks, grouped by landmark (CSR)
+struct problem {
+    int free_poses = 0;
+    std::vector<int> pose_var;        // Per slot: free pose index, -1 if fixed
+    std::vector<int> lm_ids;          // Per optimized landmark
+    std::vector<int> lm_start;        // Observations of landmark l: [lm_start[l], lm_start[l + 1])
+    std::vector<int> obs_slot;
+    std::vector<int> obs_index;       // Position in the frame's observation list
+    std::vector<cv::Point2f> obs_px;
+};
+
+struct camera {
+    double fx, fy, cx, cy;
+};
+
+// Point in front of the camera and its pixel residual (prediction - measurement)
+inline bool residual(const camera& cam, const cv::Matx33d& R, const cv::Vec3d& t, const cv::Vec3d& X,
+                     const cv::Point2f& px, cv::Vec3d& pc, cv::Vec2d& r) {
+    pc = R * X + t;
+    if (pc[2] < 1e-6) return false;
+    const double inv_z = 1.0 / pc[2];
+    r = cv::Vec2d(cam.fx * pc[0] * inv_z + cam.cx - px.x, cam.fy * pc[1] * inv_z + cam.cy - px.y);
+    return true;
+}
+
+inline double huber_cost(double e2, double delta) {
+    const double e = std::sqrt(e2);
+    return e <= delta ? e2 : 2.0 * delta * e - delta * delta;
+}
+
+// Splits [0, n) into contiguous chunks for per-chunk accumulators
+int chunk_count(int n) {
+    return std::max(1, std::min(n, 2 * std::max(1, cv::getNumThreads())));
+}
+
+inline int chunk_begin(int c, int chunks, int n) {
+    return static_cast<int>(static_cast<long long>(n) * c / chunks);
+}
+
+}  // namespace
+
+int sliding_window_ba::add_frame(const cv::Matx33d& R, const cv::Vec3d& t) {
+    frames_.push_back({next_frame_id_, R, t, {}});
+    while (static_cast<int>(frames_.size()) > std::max(1, opts.window_size)) {
+        for (const observation& o : frames_.front().observations) {
+            auto it = landmarks_.find(o.landmark);
+            if (it != landmarks_.end() && --it->second.observations <= 0) landmarks_.erase(it);
+        }
+        frames_.pop_front();
+    }
+    return next_frame_id_++;
+}
+
+int sliding_window_ba::add_landmark(const cv::Vec3d& X) {
+    landmarks_[next_landmark_id_].X = X;
+    return next_landmark_id_++;
+}
+
+void sliding_window_ba::add_observation(int frame_id, int landmark_id, const cv::Point2f& px) {
+    auto it = landmarks_.find(landmark_id);
+    if (!has_frame(frame_id) || it == landmarks_.end()) return;
+    frame(frame_id).observations.push_back({landmark_id, px});
+    ++it->second.observations;
+}
+
+bool sliding_window_ba::has_frame(int frame_id) const {
+    return !frames_.empty() && frame_id >= frames_.front().id && frame_id <= frames_.back().id;
+}
+
+void sliding_window_ba::clear() {
+    frames_.clear();
+    landmarks_.clear();
+    next_frame_id_ = 0;
+    next_landmark_id_ = 0;
+}
+
+void sliding_window_ba::triangulated_points(std::vector<cv::Point3f>& out) const {
+    out.clear();
+    out.reserve(landmarks_.size());
+    for (const auto& [id, lm] : landmarks_) {
+        if (lm.observations >= 2) out.emplace_back(cv::Vec3f(lm.X));
+    }
+}
+
+sliding_window_ba::stats sliding_window_ba::optimize(const cv::Matx33d& K) {
+    using clock = std::chrono::steady_clock;
+    const auto start = clock::now();
+    auto elapsed_ms = [&start]() {
+        return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    };
+
+    stats result;
+    const int slots = static_cast<int>(frames_.size());
+    const int fixed = std::min(std::max(0, opts.fixed_frames), slots);
+
+    problem pb;
+    pb.free_poses = slots - fixed;
+    pb.pose_var.resize(slots);
+    for (int s = 0; s < slots; ++s) pb.pose_var[s] = s < fixed ? -1 : s - fixed;
+
+    // Only landmarks seen at least twice constrain anything
+    std::unordered_map<int, int> lm_index;
+    std::vector<int> counts;
+    for (const frame_state& f : frames_) {
+        for (const observation& o : f.observations) {
+            if (landmarks_.at(o.landmark).observations < 2) continue;
+            auto [it, inserted] = lm_index.emplace(o.landmark, static_cast<int>(pb.lm_ids.size()));
+            if (inserted) {
+                pb.lm_ids.push_back(o.landmark);
+                counts.push_back(0);
+            }
+            ++counts[it->second];
+        }
+    }
+    const int L = static_cast<int>(pb.lm_ids.size());
+    if (pb.free_poses <= 0 || L == 0) return result;
+
+    pb.lm_start.assign(L + 1, 0);
+    for (int l = 0; l < L; ++l) pb.lm_start[l + 1] = pb.lm_start[l] + counts[l];
+    const int N = pb.lm_start[L];
+    pb.obs_slot.resize(N);
+    pb.obs_index.resize(N);
+    pb.obs_px.resize(N);
+    std::vector<int> fill(pb.lm_start.begin(), pb.lm_start.end() - 1);
+    for (int s = 0; s < slots; ++s) {
+        const auto& observations = frames_[s].observations;
+        for (int i = 0; i < static_cast<int>(observations.size()); ++i) {
+            auto it = lm_index.find(observations[i].landmark);
+            if (it == lm_index.end()) continue;
+            const int k = fill[it->second]++;
+            pb.obs_slot[k] = s;
+            pb.obs_index[k] = i;
+            pb.obs_px[k] = observations[i].px;
+        }
+    }
+    result.landmarks = L;
+    result.observations = N;
+
+    estimate cur;
+    cur.R.resize(slots);
+    cur.t.resize(slots);
+    for (int s = 0; s < slots; ++s) {
+        cur.R[s] = frames_[s].R;
+        cur.t[s] = frames_[s].t;
+    }
+    cur.X.resize(L);
+    for (int l = 0; l < L; ++l) cur.X[l] = landmarks_.at(pb.lm_ids[l]).X;
+
+    const camera cam{K(0, 0), K(1, 1), K(0, 2), K(1, 2)};
+    const double delta = opts.huber_px;
+    const double behind_cost = huber_cost(100.0 * opts.outlier_px * opts.outlier_px, delta);
+    const int chunks = chunk_count(L);
+    const double outlier_sq = opts.outlier_px * opts.outlier_px;
+    std::vector<char> rejected(N, 0);   // Zero weight once found to be outliers
+    std::vector<char> frozen(L, 0);     // Fewer than two observations left
+
+    // Robust cost and plain squared error of an estimate
+    auto evaluate = [&](const estimate& e, double& squared_error) {
+        std::vector<double> robust(chunks, 0.0), squared(chunks, 0.0);
+        cv::parallel_for_(cv::Range(0, chunks), [&](const cv::Range& range) {
+            for (int c = range.start; c < range.end; ++c) {
+                for (int l = chunk_begin(c, chunks, L); l < chunk_begin(c + 1, chunks, L); ++l) {
+                    for (int k = pb.lm_start[l]; k < pb.lm_start[l + 1]; ++k) {
+                        if (rejected[k]) continue;
+                        const int s = pb.obs_slot[k];
+                        cv::Vec3d pc;
+                        cv::Vec2d r;
+                        if (!residual(cam, e.R[s], e.t[s], e.X[l], pb.obs_px[k], pc, r)) {
+                            robust[c] += behind_cost;
+                            continue;
+                        }
+                        const double e2 = r.dot(r);
+                        robust[c] += huber_cost(e2, delta);
+                        squared[c] += e2;
+                    }
+                }
+            }
+        });
+        squared_error = 0.0;
+        double cost = 0.0;
+        for (int c = 0; c < chunks; ++c) {
+            cost += robust[c];
+            squared_error += squared[c];
+        }
+        return cost;
+    };
+
+    const int P6 = 6 * pb.free_poses;
+    std::vector<Matx63d> W(N);                 // J_pose^T J_landmark per observation (weighted)
+    std::vector<cv::Matx33d> H_ll_inv(L);
+    std::vector<cv::Vec3d> b_l(L);
+    std::vector<cv::Mat> chunk_S(chunks), chunk_g(chunks);
+    std::vector<std::vector<double>> chunk_diag(chunks);
+
+    // Builds the reduced camera system S dp = g (landmarks eliminated)
+    auto linearize = [&](double lambda, cv::Mat& S, cv::Mat& g) {
+        cv::parallel_for_(cv::Range(0, chunks), [&](const cv::Range& range) {
+            for (int c = range.start; c < range.end; ++c) {
+                cv::Mat& Sc = chunk_S[c];
+                cv::Mat& gc = chunk_g[c];
+                std::vector<double>& diag = chunk_diag[c];
+                Sc = cv::Mat::zeros(P6, P6, CV_64F);
+                gc = cv::Mat::zeros(P6, 1, CV_64F);
+                diag.assign(P6, 0.0);
+
+                for (int l = chunk_begin(c, chunks, L); l < chunk_begin(c + 1, chunks, L); ++l) {
+                    if (frozen[l]) {
+                        for (int k = pb.lm_start[l]; k < pb.lm_start[l + 1]; ++k) W[k] = Matx63d::zeros();
+                        H_ll_inv[l] = cv::Matx33d::zeros();
+                        b_l[l] = cv::Vec3d(0, 0, 0);
+                        continue;
+                    }
+                    cv::Matx33d H_ll = cv::Matx33d::zeros();
+                    cv::Vec3d bl(0, 0, 0);
+
+                    for (int k = pb.lm_start[l]; k < pb.lm_start[l + 1]; ++k) {
+                        const int s = pb.obs_slot[k];
+                        W[k] = Matx63d::zeros();
+                        if (rejected[k]) continue;
+                        cv::Vec3d pc;
+                        cv::Vec2d r;
+                        if (!residual(cam, cur.R[s], cur.t[s], cur.X[l], pb.obs_px[k], pc, r)) continue;
+
+                        const double e = std::sqrt(r.dot(r));
+                        const double w = e <= delta ? 1.0 : delta / e;   // Huber IRLS weight
+                        const double inv_z = 1.0 / pc[2];
+                        const cv::Matx23d J_proj(cam.fx * inv_z, 0, -cam.fx * pc[0] * inv_z * inv_z,
+                                                 0, cam.fy * inv_z, -cam.fy * pc[1] * inv_z * inv_z);
+                        const cv::Matx23d J_l = J_proj * cur.R[s];
+                        H_ll += J_l.t() * J_l * w;
+                        bl -= cv::Vec3d(J_l.t() * r * w);
+
+                        const int p = pb.pose_var[s];
+                        if (p < 0) continue;
+                        // d pc = d rho - [pc]x d phi for the left update exp(phi) * (R, t) + rho
+                        const cv::Matx23d J_rot = J_proj * skew(pc) * -1.0;
+                        Matx26d J_p;
+                        for (int i = 0; i < 2; ++i) {
+                            for (int j = 0; j < 3; ++j) {
+                                J_p(i, j) = J_proj(i, j);
+                                J_p(i, j + 3) = J_rot(i, j);
+                            }
+                        }
+                        const Matx66d H_pp = J_p.t() * J_p * w;
+                        const Vec6d bp = Vec6d(J_p.t() * r * -w);
+                        for (int i = 0; i < 6; ++i) {
+                            double* row = Sc.ptr<double>(6 * p + i) + 6 * p;
+                            for (int j = 0; j < 6; ++j) row[j] += H_pp(i, j);
+                            gc.at<double>(6 * p + i) += bp[i];
+                            diag[6 * p + i] += H_pp(i, i);
+                        }
+                        W[k] = J_p.t() * J_l * w;
+                    }
+
+                    for (int i = 0; i < 3; ++i) H_ll(i, i) = H_ll(i, i) * (1.0 + lambda) + 1e-9;
+                    bool ok = false;
+                    const cv::Matx33d inv = H_ll.inv(cv::DECOMP_CHOLESKY, &ok);
+                    H_ll_inv[l] = ok ? inv : cv::Matx33d::zeros();
+                    b_l[l] = bl;
+                    if (!ok) continue;
+
+                    // Schur complement: S -= W H_ll^-1 W^T, g -= W H_ll^-1 b_l
+                    for (int k = pb.lm_start[l]; k < pb.lm_start[l + 1]; ++k) {
+                        const int p = pb.pose_var[pb.obs_slot[k]];
+                        if (p < 0) continue;
+                        const Matx63d V = W[k] * inv;
+                        const Vec6d gv = Vec6d(V * bl);
+                        for (int i = 0; i < 6; ++i) gc.at<double>(6 * p + i) -= gv[i];
+                        for (int m = pb.lm_start[l]; m < pb.lm_start[l + 1]; ++m) {
+                            const int q = pb.pose_var[pb.obs_slot[m]];
+                            if (q < p) continue;   // Upper triangle only, mirrored below
+                            const Matx66d block = V * W[m].t();
+                            for (int i = 0; i < 6; ++i) {
+                                double* row = Sc.ptr<double>(6 * p + i) + 6 * q;
+                                for (int j = 0; j < 6; ++j) row[j] -= block(i, j);
+                            }
+                        }
+                    }
+                }
+            }
+        });
+
+        S = chunk_S[0].clone();
+        g = chunk_g[0].clone();
+        std::vector<double> diag = chunk_diag[0];
+        for (int c = 1; c < chunks; ++c) {
+            S += chunk_S[c];
+            g += chunk_g[c];
+            for (int i = 0; i < P6; ++i) diag[i] += chunk_diag[c][i];
+        }
+        for (int i = 0; i < P6; ++i) {
+            for (int j = 0; j < i; ++j) S.at<double>(i, j) = S.at<double>(j, i);
+            S.at<double>(i, i) += lambda * diag[i] + 1e-9;
+        }
+    };
+
+    // Marks observations the estimate does not explain; returns how many
+    auto reject_outliers = [&](const estimate& e) {
+        int count = 0;
+        for (int l = 0; l < L; ++l) {
+            int kept = 0;
+            for (int k = pb.lm_start[l]; k < pb.lm_start[l + 1]; ++k) {
+                if (rejected[k]) continue;
+                const int s = pb.obs_slot[k];
+                cv::Vec3d pc;
+                cv::Vec2d r;
+                if (residual(cam, e.R[s], e.t[s], e.X[l], pb.obs_px[k], pc, r) && r.dot(r) <= outlier_sq) {
+                    ++kept;
+                    continue;
+                }
+                rejected[k] = 1;
+                ++count;
+            }
+            // A single ray leaves the depth free; hold the point where it is
+            frozen[l] = kept < 2;
+        }
+        return count;
+    };
+
+    double squared_error = 0.0;
+    double cost = evaluate(cur, squared_error);
+    result.initial_rms = std::sqrt(squared_error / N);
+    result.final_rms = result.initial_rms;
+
+    // Two stages: once the first converges (or uses half the iterations),
+    // outliers are taken out and the rest is solved again without them
+    double lambda = 1e-4;
+    double last_iteration_ms = 0.0;
+    bool first_stage = true;
+    int stage_iterations = 0;
+    cv::Mat S, g, dp;
+    estimate trial;
+    for (int it = 0; it < opts.max_iterations; ++it) {
+        const double iteration_start = elapsed_ms();
+        if (it > 0 && iteration_start + last_iteration_ms > opts.time_budget_ms) {
+            result.time_limited = true;
+            break;
+        }
+
+        linearize(lambda, S, g);
+        if (!cv::solve(S, g, dp, cv::DECOMP_CHOLESKY)) {
+            lambda *= 10.0;
+            last_iteration_ms = elapsed_ms() - iteration_start;
+            continue;
+        }
+
+        // Poses first, then each landmark from the pose update (back-substitution)
+        trial = cur;
+        for (int s = fixed; s < slots; ++s) {
+            const double* d = dp.ptr<double>(6 * pb.pose_var[s]);
+            const cv::Matx33d dR = exp_so3(cv::Vec3d(d[3], d[4], d[5]));
+            trial.R[s] = dR * cur.R[s];
+            trial.t[s] = dR * cur.t[s] + cv::Vec3d(d[0], d[1], d[2]);
+        }
+        cv::parallel_for_(cv::Range(0, L), [&](const cv::Range& range) {
+            for (int l = range.start; l < range.end; ++l) {
+                cv::Vec3d rhs = b_l[l];
+                for (int k = pb.lm_start[l]; k < pb.lm_start[l + 1]; ++k) {
+                    const int p = pb.pose_var[pb.obs_slot[k]];
+                    if (p < 0) continue;
+                    const Vec6d d(dp.ptr<double>(6 * p));
+                    rhs -= cv::Vec3d(W[k].t() * d);
+                }
+                trial.X[l] = cur.X[l] + cv::Vec3d(H_ll_inv[l] * rhs);
+            }
+        });
+
+        double trial_squared = 0.0;
+        const double trial_cost = evaluate(trial, trial_squared);
+        bool converged = false;
+        if (trial_cost < cost) {
+            const double decrease = (cost - trial_cost) / std::max(cost, 1e-12);
+            std::swap(cur, trial);
+            cost = trial_cost;
+            squared_error = trial_squared;
+            lambda = std::max(lambda / 3.0, 1e-9);
+            ++result.iterations;
+            converged = decrease < 1e-6;
+        } else {
+            lambda *= 4.0;
+        }
+        last_iteration_ms = elapsed_ms() - iteration_start;
+
+        ++stage_iterations;
+        if (first_stage && (converged || 2 * stage_iterations >= opts.max_iterations)) {
+            first_stage = false;
+            if (reject_outliers(cur) > 0) {
+                cost = evaluate(cur, squared_error);
+                continue;
+            }
+        }
+        if (converged) break;
+    }
+    result.final_rms = std::sqrt(squared_error / std::max(1, N - static_cast<int>(
+                                                             std::count(rejected.begin(), rejected.end(), 1))));
+
+    for (int s = fixed; s < slots; ++s) {
+        frames_[s].R = cur.R[s];
+        frames_[s].t = cur.t[s];
+    }
+    for (int l = 0; l < L; ++l) landmarks_.at(pb.lm_ids[l]).X = cur.X[l];
+
+    // Drop observations the solution does not explain
+    reject_outliers(cur);
+    std::vector<std::vector<char>> drop(slots);
+    for (int s = 0; s < slots; ++s) drop[s].assign(frames_[s].observations.size(), 0);
+    for (int k = 0; k < N; ++k) {
+        if (rejected[k]) drop[pb.obs_slot[k]][pb.obs_index[k]] = 1;
+    }
+    for (int s = 0; s < slots; ++s) {
+        auto& observations = frames_[s].observations;
+        size_t kept = 0;
+        for (size_t i = 0; i < observations.size(); ++i) {
+            if (!drop[s][i]) {
+                observations[kept++] = observations[i];
+                continue;
+            }
+            ++result.outliers_removed;
+            auto it = landmarks_.find(observations[i].landmark);
+            if (it != landmarks_.end() && --it->second.observations <= 0) landmarks_.erase(it);
+        }
+        observations.resize(kept);
+    }
+
+    result.ms = elapsed_ms();
+    return result;
+}
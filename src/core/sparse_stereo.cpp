@@ -0,0 +1,70 @@
+#include "core/sparse_stereo.hpp"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+
+// SAD between the window at (x, y) in `left` and at (x - d, y) in `right`
+inline int window_sad(const cv::Mat& left, const cv::Mat& right, int x, int y, int d, int r) {
+    int sum = 0;
+    for (int dy = -r; dy <= r; ++dy) {
+        const uchar* a = left.ptr<uchar>(y + dy) + x - r;
+        const uchar* b = right.ptr<uchar>(y + dy) + x - d - r;
+        for (int dx = 0; dx <= 2 * r; ++dx) sum += std::abs(a[dx] - b[dx]);
+    }
+    return sum;
+}
+
+float match_point(const cv::Mat& left, const cv::Mat& right, const cv::Point2f& p,
+                  const sparse_stereo_params& params, std::vector<int>& costs) {
+    const int r = params.block_radius;
+    const int x = static_cast<int>(std::lround(p.x));
+    const int y = static_cast<int>(std::lround(p.y));
+    if (y - r < 0 || y + r >= left.rows || x - r < 0 || x + r >= left.cols) return -1.0f;
+
+    // Disparities whose window stays inside the right image
+    const int d0 = std::max(params.min_disparity, x + r - (right.cols - 1));
+    const int d1 = std::min(params.min_disparity + params.num_disparities - 1, x - r);
+    if (d1 - d0 < 2) return -1.0f;
+
+    costs.resize(d1 - d0 + 1);
+    int best = 0;
+    for (int d = d0; d <= d1; ++d) {
+        costs[d - d0] = window_sad(left, right, x, y, d, r);
+        if (costs[d - d0] < costs[best]) best = d - d0;
+    }
+
+    // Runner-up outside the best match's immediate neighbours
+    int second = INT_MAX;
+    for (int i = 0; i < static_cast<int>(costs.size()); ++i) {
+        if (std::abs(i - best) > 1) second = std::min(second, costs[i]);
+    }
+    if (second != INT_MAX && costs[best] * (100 + params.uniqueness) >= second * 100) return -1.0f;
+
+    // Parabola through the best cost and its neighbours
+    float offset = 0.0f;
+    if (best > 0 && best + 1 < static_cast<int>(costs.size())) {
+        const int c_minus = costs[best - 1], c = costs[best], c_plus = costs[best + 1];
+        const int denom = c_minus - 2 * c + c_plus;
+        if (denom > 0) offset = 0.5f * static_cast<float>(c_minus - c_plus) / denom;
+    }
+    return static_cast<float>(d0 + best) + offset;
+}
+
+}  // namespace
+
+void sparse_stereo_match(const cv::Mat& left, const cv::Mat& right, const std::vector<cv::Point2f>& points,
+                         const sparse_stereo_params& params, std::vector<float>& disparities) {
+    CV_Assert(left.type() == CV_8UC1 && right.type() == CV_8UC1 && left.rows == right.rows);
+    disparities.assign(points.size(), -1.0f);
+    if (points.empty() || params.num_disparities < 3 || params.block_radius < 0) return;
+
+    cv::parallel_for_(cv::Range(0, static_cast<int>(points.size())), [&](const cv::Range& range) {
+        std::vector<int> costs;
+        for (int i = range.start; i < range.end; ++i) {
+            disparities[i] = match_point(left, right, points[i], params, costs);
+        }
+    });
+}
@@ -0,0 +1,218 @@
+#include "core/synthetic_scene.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Scene layout (metres, world frame)
+constexpr double kGroundY = 1.65;      // Camera height above the road
+constexpr double kWallX = 7.0;         // Facades at x = +-kWallX
+constexpr double kWallTopY = -9.0;     // Facade height above the camera
+constexpr double kSwayPeriod = 60.0;   // Metres per S-curve
+constexpr double kFogDistance = 120.0;
+
+enum surface { SURFACE_NONE = 0, SURFACE_GROUND, SURFACE_LEFT_WALL, SURFACE_RIGHT_WALL };
+
+inline uint32_t hash2(int32_t x, int32_t y, uint32_t seed) {
+    uint32_t h = seed ^ 0x9E3779B9u;
+    h ^= static_cast<uint32_t>(x) * 0x85EBCA6Bu;
+    h = (h << 13) | (h >> 19);
+    h ^= static_cast<uint32_t>(y) * 0xC2B2AE35u;
+    h *= 0x27D4EB2Fu;
+    h ^= h >> 15;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    return h;
+}
+
+inline float lattice(int32_t x, int32_t y, uint32_t seed) {
+    return static_cast<float>(hash2(x, y, seed) >> 8) * (1.0f / 16777216.0f);
+}
+
+// Piecewise-constant cells: hard edges give the detectors real corners
+inline float cells(double u, double v, uint32_t seed) {
+    return lattice(static_cast<int32_t>(std::floor(u)), static_cast<int32_t>(std::floor(v)), seed);
+}
+
+// Smooth value noise for fine texture inside the cells
+inline float value_noise(double u, double v, uint32_t seed) {
+    double fu = std::floor(u), fv = std::floor(v);
+    int32_t iu = static_cast<int32_t>(fu), iv = static_cast<int32_t>(fv);
+    float a = static_cast<float>(u - fu), b = static_cast<float>(v - fv);
+    a = a * a * (3.0f - 2.0f * a);
+    b = b * b * (3.0f - 2.0f * b);
+    float v00 = lattice(iu, iv, seed), v10 = lattice(iu + 1, iv, seed);
+    float v01 = lattice(iu, iv + 1, seed), v11 = lattice(iu + 1, iv + 1, seed);
+    return (v00 * (1 - a) + v10 * a) * (1 - b) + (v01 * (1 - a) + v11 * a) * b;
+}
+
+inline float surface_texture(int surface_id, double u, double v, uint32_t seed) {
+    uint32_t s = seed * 31u + static_cast<uint32_t>(surface_id) * 0x51ED27u;
+    if (surface_id == SURFACE_GROUND) {
+        // Paving slabs with grain
+        return 0.55f * cells(u / 0.8, v / 0.8, s) + 0.30f * value_noise(u / 0.12, v / 0.12, s + 1)
+             + 0.15f * value_noise(u / 0.03, v / 0.03, s + 2);
+    }
+    // Facades: brick-like rows of offset blocks plus weathering
+    double row = std::floor(v / 0.35);
+    double offset = std::fmod(row, 2.0) * 0.3;
+    return 0.55f * cells((u + offset) / 0.6, v / 0.35, s) + 0.25f * value_noise(u / 2.0, v / 2.0, s + 1)
+         + 0.20f * value_noise(u / 0.05, v / 0.05, s + 2);
+}
+
+inline double sway(double z, double amplitude) {
+    return amplitude * std::sin(2.0 * CV_PI * z / kSwayPeriod);
+}
+
+inline double sway_slope(double z, double amplitude) {
+    return amplitude * 2.0 * CV_PI / kSwayPeriod * std::cos(2.0 * CV_PI * z / kSwayPeriod);
+}
+
+}  // namespace
+
+synthetic_scene::synthetic_scene(const synthetic_scene_config& config)
+    : config_(config) {
+    config_.width = std::max(16, config_.width);
+    config_.height = std::max(16, config_.height);
+    config_.frame_count = std::max(2, config_.frame_count);
+
+    // Bring K to the render resolution; a config read back from config()
+    // already matches, so rebuilding from it is a no-op
+    if (config_.intrinsics_width > 0 && config_.intrinsics_height > 0) {
+        const double sx = static_cast<double>(config_.width) / config_.intrinsics_width;
+        const double sy = static_cast<double>(config_.height) / config_.intrinsics_height;
+        config_.fx *= sx;
+        config_.cx *= sx;
+        config_.fy *= sy;
+        config_.cy *= sy;
+    }
+    config_.intrinsics_width = config_.width;
+    config_.intrinsics_height = config_.height;
+    generate_landmarks();
+}
+
+cv::Mat synthetic_scene::K() const {
+    cv::Mat K = (cv::Mat_<double>(3, 3) << config_.fx, 0, config_.cx,
+                                           0, config_.fy, config_.cy,
+                                           0, 0, 1);
+    return K;
+}
+
+cv::Vec3d synthetic_scene::position(int frame_index) const {
+    double z = frame_index * config_.step_m;
+    return cv::Vec3d(sway(z, config_.sway_m), 0.0, z);
+}
+
+cv::Matx33d synthetic_scene::rotation(int frame_index) const {
+    // Yaw about the (downward) y axis so the optical axis follows the path
+    double z = frame_index * config_.step_m;
+    double yaw = std::atan(sway_slope(z, config_.sway_m));
+    double c = std::cos(yaw), s = std::sin(yaw);
+    return cv::Matx33d(c, 0, s,
+                       0, 1, 0,
+                      -s, 0, c);
+}
+
+void synthetic_scene::relative_motion(int frame_index, cv::Mat& R, cv::Mat& t) const {
+    int prev = std::max(0, frame_index - 1);
+    cv::Matx33d R1 = rotation(prev), R2 = rotation(frame_index);
+    cv::Vec3d C1 = position(prev), C2 = position(frame_index);
+
+    // x_c = R_wc^T (X - C)  =>  x_2 = R2^T R1 x_1 + R2^T (C1 - C2)
+    cv::Matx33d R_rel = R2.t() * R1;
+    cv::Vec3d t_rel = R2.t() * (C1 - C2);
+    R = cv::Mat(R_rel, true);
+    t = cv::Mat(t_rel, true);
+}
+
+float synthetic_scene::shade(const cv::Vec3d& o, const cv::Vec3d& d) const {
+    double best = std::numeric_limits<double>::infinity();
+    int hit = SURFACE_NONE;
+
+    if (d[1] > 1e-9) {
+        double t = (kGroundY - o[1]) / d[1];
+        if (t > 0 && t < best) { best = t; hit = SURFACE_GROUND; }
+    }
+    if (std::abs(d[0]) > 1e-9) {
+        double wall_x = d[0] < 0 ? -kWallX : kWallX;
+        double t = (wall_x - o[0]) / d[0];
+        double y = o[1] + t * d[1];
+        if (t > 0 && t < best && y >= kWallTopY && y <= kGroundY) {
+            best = t;
+            hit = d[0] < 0 ? SURFACE_LEFT_WALL : SURFACE_RIGHT_WALL;
+        }
+    }
+
+    // Sky: vertical gradient, no texture
+    float sky = static_cast<float>(0.75 + 0.2 * std::max(-1.0, std::min(1.0, -d[1])));
+    if (hit == SURFACE_NONE) return sky;
+
+    cv::Vec3d p = o + d * best;
+    float value;
+    if (hit == SURFACE_GROUND) {
+        value = 0.15f + 0.6f * surface_texture(hit, p[0], p[2], config_.seed);
+    } else {
+        value = (hit == SURFACE_LEFT_WALL ? 0.2f : 0.25f) + 0.6f * surface_texture(hit, p[2], p[1], config_.seed);
+    }
+
+    float fog = static_cast<float>(std::min(1.0, best / kFogDistance));
+    return value * (1.0f - fog) + 0.6f * fog;
+}
+
+void synthetic_scene::render(int frame_index, cv::Mat& out) const {
+    out.create(config_.height, config_.width, CV_8UC3);
+
+    const cv::Matx33d R = rotation(frame_index);
+    const cv::Vec3d C = position(frame_index);
+    const double inv_fx = 1.0 / config_.fx, inv_fy = 1.0 / config_.fy;
+
+    cv::parallel_for_(cv::Range(0, config_.height), [&](const cv::Range& rows) {
+        for (int v = rows.start; v < rows.end; ++v) {
+            cv::Vec3b* row = out.ptr<cv::Vec3b>(v);
+            for (int u = 0; u < config_.width; ++u) {
+                cv::Vec3d ray_c((u - config_.cx) * inv_fx, (v - config_.cy) * inv_fy, 1.0);
+                cv::Vec3d ray_w = R * ray_c;
+                uchar g = cv::saturate_cast<uchar>(255.0f * shade(C, ray_w));
+                row[u] = cv::Vec3b(g, g, g);
+            }
+        }
+    });
+}
+
+void synthetic_scene::generate_landmarks() {
+    landmarks_.clear();
+    landmarks_.reserve(config_.landmark_count);
+
+    double z_end = (config_.frame_count + 20) * config_.step_m;
+    uint32_t s = config_.seed * 0x2545F491u + 7u;
+    for (int i = 0; i < config_.landmark_count; ++i) {
+        float r0 = lattice(i, 0, s), r1 = lattice(i, 1, s), r2 = lattice(i, 2, s);
+        double z = r1 * z_end;
+        if (r0 < 0.4f) {
+            double x = (2.0 * r2 - 1.0) * kWallX;
+            landmarks_.emplace_back(static_cast<float>(x), static_cast<float>(kGroundY), static_cast<float>(z));
+        } else {
+            double x = r0 < 0.7f ? -kWallX : kWallX;
+            double y = kWallTopY + r2 * (kGroundY - kWallTopY);
+            landmarks_.emplace_back(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z));
+        }
+    }
+}
+
+std::vector<cv::Point3f> synthetic_scene::visible_landmarks(int frame_index) const {
+    std::vector<cv::Point3f> visible;
+    const cv::Matx33d Rt = rotation(frame_index).t();
+    const cv::Vec3d C = position(frame_index);
+
+    for (const auto& X : landmarks_) {
+        cv::Vec3d x_c = Rt * (cv::Vec3d(X.x, X.y, X.z) - C);
+        if (x_c[2] < 0.5 || x_c[2] > kFogDistance) continue;
+        double u = config_.fx * x_c[0] / x_c[2] + config_.cx;
+        double v = config_.fy * x_c[1] / x_c[2] + config_.cy;
+        if (u >= 0 && u < config_.width && v >= 0 && v < config_.height) {
+            visible.push_back(X);
+        }
+    }
+    return visible;
+}
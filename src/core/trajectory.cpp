@@ -0,0 +1,49 @@
+#include "core/trajectory.hpp"
+#include <algorithm>
+#include <atomic>
+
+namespace {
+
+uint64_t next_sequence_id() {
+    static std::atomic<uint64_t> next{1};
+    return next++;
+}
+
+} // namespace
+
+trajectory::trajectory() {
+    reset();
+}
+
+void trajectory::push_back(const pose& p, int frame_id) {
+    if (seq_->size == seq_->chunks.size() * kChunkSize) {
+        seq_->chunks.push_back(std::make_unique<chunk>());
+    }
+    const size_t i = seq_->size++;
+    entry(i) = {p, frame_id};
+}
+
+void trajectory::revise(size_t i, const pose& p) {
+    entry(i).p = p;
+    seq_->edit_log.push_back(i);
+}
+
+void trajectory::reset() {
+    seq_ = std::make_shared<sequence>();
+    seq_->id = next_sequence_id();
+}
+
+size_t trajectory::first_unread(const cursor& c) const {
+    if (c.sequence != seq_->id) return 0;
+    size_t first = std::min(c.read, seq_->size);
+    for (size_t e = c.edits; e < seq_->edit_log.size(); ++e) {
+        first = std::min(first, seq_->edit_log[e]);
+    }
+    return first;
+}
+
+void trajectory::advance(cursor& c) const {
+    c.sequence = seq_->id;
+    c.read = seq_->size;
+    c.edits = seq_->edit_log.size();
+}
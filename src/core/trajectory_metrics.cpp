@@ -0,0 +1,182 @@
+#include "core/trajectory_metrics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+constexpr double kSegmentLengths[] = {100, 200, 300, 400, 500, 600, 700, 800};
+constexpr int kSegmentLengthCount = sizeof(kSegmentLengths) / sizeof(kSegmentLengths[0]);
+constexpr int kSegmentStep = 10;   // Frames between segment starts, as in the KITTI devkit
+
+double rotation_angle(const mat3& R) {
+    return std::acos(std::clamp((R.trace() - 1.0) * 0.5, -1.0, 1.0));
+}
+
+struct alignment {
+    double scale = 1.0;
+    double error2 = 0.0;    // Mean squared residual
+};
+
+// Umeyama's closed form from the centred moments of the two point sets
+alignment align(int n, const vec3& sum_x, const vec3& sum_y, double sum_xx, double sum_yy,
+                const mat3& sum_yx, bool similarity) {
+    alignment a;
+    const vec3 mu_x = sum_x * (1.0 / n);
+    const vec3 mu_y = sum_y * (1.0 / n);
+    const double var_x = sum_xx / n - mu_x.dot(mu_x);
+    const double var_y = sum_yy / n - mu_y.dot(mu_y);
+
+    cv::Matx33d cov;
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 3; ++c) cov(r, c) = sum_yx(r, c) / n - mu_y[r] * mu_x[c];
+    }
+    cv::Matx31d w;
+    cv::Matx33d u, vt;
+    cv::SVD::compute(cov, w, u, vt);
+
+    // The rotation is U S V^T, with S flipping the weakest axis if U V^T
+    // is a reflection; only tr(D S) is needed for the scale and residual
+    const double d = cv::determinant(u) * cv::determinant(vt) < 0.0 ? -1.0 : 1.0;
+    const double trace_ds = w(0) + w(1) + d * w(2);
+
+    if (similarity && var_x > 0.0) {
+        a.scale = trace_ds / var_x;
+        a.error2 = var_y - trace_ds * trace_ds / var_x;
+    } else {
+        a.error2 = var_y + var_x - 2.0 * trace_ds;
+    }
+    a.error2 = std::max(0.0, a.error2);
+    return a;
+}
+
+} // namespace
+
+bool trajectory_metrics::load_ground_truth(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        std::cerr << "[TrajectoryMetrics] Failed to open " << path << "\n";
+        return false;
+    }
+
+    std::vector<se3> poses;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        std::istringstream ss(line);
+        double v[12];
+        int k = 0;
+        while (k < 12 && ss >> v[k]) ++k;
+        if (k != 12) {
+            std::cerr << "[TrajectoryMetrics] Expected 12 values on line " << poses.size() + 1
+                      << " of " << path << "\n";
+            return false;
+        }
+        se3 p;
+        for (int r = 0; r < 3; ++r) {
+            for (int c = 0; c < 3; ++c) p.R(r, c) = v[r * 4 + c];
+            p.t[r] = v[r * 4 + 3];
+        }
+        poses.push_back(p);
+    }
+    if (poses.empty()) {
+        std::cerr << "[TrajectoryMetrics] No poses in " << path << "\n";
+        return false;
+    }
+
+    gt_.swap(poses);
+    clear_estimates();
+
+    // Distance travelled along the ground truth up to each frame
+    const int n = static_cast<int>(gt_.size());
+    std::vector<double> dist(n, 0.0);
+    for (int i = 1; i < n; ++i) dist[i] = dist[i - 1] + (gt_[i].t - gt_[i - 1].t).norm();
+
+    // Each segment ends at the first frame strictly past its length; both
+    // ends move forward together, so one sweep per length
+    segments_ending_.assign(n, {});
+    for (int li = 0; li < kSegmentLengthCount; ++li) {
+        int last = 0;
+        for (int first = 0; first < n; first += kSegmentStep) {
+            while (last < n && dist[last] <= dist[first] + kSegmentLengths[li]) ++last;
+            if (last == n) break;
+            segments_ending_[last].push_back({first, li});
+        }
+    }
+
+    std::cout << "[TrajectoryMetrics] Loaded " << n << " ground truth poses from " << path
+              << " (" << dist.back() / 1000.0 << " km)\n";
+    return true;
+}
+
+void trajectory_metrics::clear_estimates() {
+    est_.assign(gt_.size(), se3());
+    have_est_.assign(gt_.size(), 0);
+    n_ = 0;
+    sum_x_ = sum_y_ = vec3();
+    sum_xx_ = sum_yy_ = 0.0;
+    sum_yx_ = mat3();
+    segments_ = 0;
+    sum_t_err_ = sum_r_err_ = 0.0;
+}
+
+void trajectory_metrics::add_moments(const vec3& x, const vec3& y, double sign) {
+    n_ += sign > 0 ? 1 : -1;
+    sum_x_ = sum_x_ + x * sign;
+    sum_y_ = sum_y_ + y * sign;
+    sum_xx_ += sign * x.dot(x);
+    sum_yy_ += sign * y.dot(y);
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 3; ++c) sum_yx_(r, c) += sign * y[r] * x[c];
+    }
+}
+
+bool trajectory_metrics::update(size_t frame, const se3& pose) {
+    if (frame >= gt_.size()) return false;
+
+    const bool revision = have_est_[frame] != 0;
+    if (revision) add_moments(est_[frame].t, gt_[frame].t, -1.0);
+    est_[frame] = pose;
+    have_est_[frame] = 1;
+    add_moments(pose.t, gt_[frame].t, 1.0);
+
+    if (revision) return true;
+    for (const segment& s : segments_ending_[frame]) score_segment(s, static_cast<int>(frame));
+    return true;
+}
+
+void trajectory_metrics::score_segment(const segment& s, int last) {
+    if (!have_est_[s.first]) return;
+
+    se3 delta_est = est_[s.first].inverse() * est_[last];
+    if (similarity) delta_est.t = delta_est.t * ate().scale;
+    const se3 delta_gt = gt_[s.first].inverse() * gt_[last];
+    const se3 error = delta_est.inverse() * delta_gt;
+
+    const double length = kSegmentLengths[s.length_index];
+    sum_t_err_ += error.t.norm() / length;
+    sum_r_err_ += rotation_angle(error.R) / length;
+    ++segments_;
+}
+
+trajectory_metrics::ate_result trajectory_metrics::ate() const {
+    ate_result out;
+    out.poses = n_;
+    if (n_ < 3) return out;
+    const alignment a = align(n_, sum_x_, sum_y_, sum_xx_, sum_yy_, sum_yx_, similarity);
+    out.rmse = std::sqrt(a.error2);
+    out.scale = a.scale;
+    return out;
+}
+
+trajectory_metrics::rpe_result trajectory_metrics::rpe() const {
+    rpe_result out;
+    out.segments = segments_;
+    if (segments_ == 0) return out;
+    out.translation_pct = 100.0 * sum_t_err_ / segments_;
+    out.rotation_deg_100m = 100.0 * (sum_r_err_ / segments_) * 180.0 / CV_PI;
+    return out;
+}
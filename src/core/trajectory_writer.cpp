@@ -0,0 +1,154 @@
+#include "core/trajectory_writer.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+trajectory_writer::~trajectory_writer() {
+    close();
+}
+
+bool trajectory_writer::open(const std::string& path, const options& opts) {
+    close();
+
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) {
+        std::cerr << "[TrajectoryWriter] Failed to open " << path << ": " << std::strerror(errno) << "\n";
+        return false;
+    }
+
+    path_ = path;
+    opts_ = opts;
+    buffer_.clear();
+    buffer_.reserve(opts_.buffer_bytes);
+    offsets_.clear();
+    flushed_ = 0;
+    unsynced_ = 0;
+    poses_written_ = 0;
+    bytes_written_ = 0;
+    fsyncs_ = 0;
+    failed_ = false;
+
+    queue_.set_capacity(opts_.queue_batches);
+    queue_.reopen();
+    worker_ = std::thread(&trajectory_writer::run, this);
+    return true;
+}
+
+void trajectory_writer::close() {
+    if (!worker_.joinable()) return;
+    queue_.close();  // The worker drains what is left, then exits
+    worker_.join();
+    ::close(fd_);
+    fd_ = -1;
+}
+
+void trajectory_writer::write(const trajectory& poses, size_t first) {
+    if (!worker_.joinable() || first > poses.size()) return;
+    batch b;
+    b.first = first;
+    b.poses.reserve(poses.size() - first);
+    for (size_t i = first; i < poses.size(); ++i) b.poses.push_back(poses[i]);
+    queue_.push(std::move(b));
+}
+
+void trajectory_writer::run() {
+    batch b;
+    while (true) {
+        // Write out whatever is buffered before waiting on an empty queue,
+        // so the file is current whenever the producer is idle
+        if (!queue_.try_pop(b)) {
+            if (!failed_) flush();
+            if (!queue_.pop(b)) break;
+        }
+        if (failed_) continue;
+
+        if (b.first < offsets_.size() && !truncate(b.first)) continue;
+        for (size_t i = 0; i < b.poses.size(); ++i) append(b.poses[i]);
+
+        if (opts_.fsync_every > 0 && unsynced_ >= opts_.fsync_every && flush()) sync();
+    }
+
+    if (!failed_ && flush()) sync();
+}
+
+void trajectory_writer::append(const trajectory::pose& p) {
+    offsets_.push_back(flushed_ + static_cast<long long>(buffer_.size()));
+
+    if (opts_.fmt == format::BINARY) {
+        double v[12];
+        for (int r = 0; r < 3; ++r) {
+            for (int c = 0; c < 4; ++c) v[r * 4 + c] = p(r, c);
+        }
+        buffer_.append(reinterpret_cast<const char*>(v), sizeof(v));
+    } else {
+        char line[256];
+        const int n = std::snprintf(line, sizeof(line),
+            "%.6e %.6e %.6e %.6e %.6e %.6e %.6e %.6e %.6e %.6e %.6e %.6e\n",
+            p(0, 0), p(0, 1), p(0, 2), p(0, 3),
+            p(1, 0), p(1, 1), p(1, 2), p(1, 3),
+            p(2, 0), p(2, 1), p(2, 2), p(2, 3));
+        buffer_.append(line, static_cast<size_t>(n));
+    }
+
+    ++poses_written_;
+    ++unsynced_;
+    if (buffer_.size() >= opts_.buffer_bytes) flush();
+}
+
+bool trajectory_writer::truncate(size_t first) {
+    const long long offset = offsets_[first];
+    offsets_.resize(first);
+    poses_written_ = first;
+
+    // Still buffered: just drop the tail of the buffer
+    if (offset >= flushed_) {
+        buffer_.resize(static_cast<size_t>(offset - flushed_));
+        return true;
+    }
+
+    buffer_.clear();
+    if (::ftruncate(fd_, offset) != 0 || ::lseek(fd_, offset, SEEK_SET) < 0) {
+        fail("truncate");
+        return false;
+    }
+    flushed_ = offset;
+    return true;
+}
+
+bool trajectory_writer::flush() {
+    const char* data = buffer_.data();
+    size_t left = buffer_.size();
+    while (left > 0) {
+        const ssize_t n = ::write(fd_, data, left);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            fail("write");
+            return false;
+        }
+        data += n;
+        left -= static_cast<size_t>(n);
+    }
+    flushed_ += static_cast<long long>(buffer_.size());
+    bytes_written_ = static_cast<size_t>(flushed_);
+    buffer_.clear();
+    return true;
+}
+
+void trajectory_writer::sync() {
+    if (::fsync(fd_) != 0) {
+        fail("fsync");
+        return;
+    }
+    unsynced_ = 0;
+    ++fsyncs_;
+}
+
+void trajectory_writer::fail(const char* what) {
+    std::cerr << "[TrajectoryWriter] " << what << " failed on " << path_ << ": " << std::strerror(errno) << "\n";
+    failed_ = true;
+}
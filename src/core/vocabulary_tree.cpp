@@ -0,0 +1,253 @@
+#include "core/vocabulary_tree.hpp"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+namespace {
+
+constexpr uint32_t kMagic = 0x434f5649;   // "IVOC"
+constexpr uint32_t kVersion = 1;
+
+inline int hamming(const uint8_t* a, const uint8_t* b) {
+    int d = 0;
+    for (int i = 0; i < vocabulary_tree::kBytes; i += 8) {
+        uint64_t x, y;
+        std::memcpy(&x, a + i, 8);
+        std::memcpy(&y, b + i, 8);
+        d += __builtin_popcountll(x ^ y);
+    }
+    return d;
+}
+
+// Bitwise majority of the given rows
+void majority(const std::vector<const uint8_t*>& rows, uint8_t* out) {
+    int counts[vocabulary_tree::kBytes * 8] = {};
+    for (const uint8_t* r : rows) {
+        for (int b = 0; b < vocabulary_tree::kBytes * 8; ++b) counts[b] += (r[b >> 3] >> (b & 7)) & 1;
+    }
+    std::memset(out, 0, vocabulary_tree::kBytes);
+    const int half = static_cast<int>(rows.size());
+    for (int b = 0; b < vocabulary_tree::kBytes * 8; ++b) {
+        if (2 * counts[b] > half) out[b >> 3] |= static_cast<uint8_t>(1 << (b & 7));
+    }
+}
+
+// k-majority clustering of `rows` into at most k clusters, k-means++ seeding
+std::vector<std::vector<const uint8_t*>> cluster(const std::vector<const uint8_t*>& rows, int k,
+                                                 int iterations, std::mt19937& rng,
+                                                 std::vector<uint8_t>& centres) {
+    const int n = static_cast<int>(rows.size());
+    k = std::min(k, n);
+    centres.assign(static_cast<size_t>(k) * vocabulary_tree::kBytes, 0);
+
+    // Seeding: next centre drawn with probability proportional to d^2
+    std::vector<double> d2(n, 0.0);
+    std::memcpy(centres.data(), rows[std::uniform_int_distribution<int>(0, n - 1)(rng)], vocabulary_tree::kBytes);
+    for (int i = 0; i < n; ++i) {
+        const double d = hamming(rows[i], centres.data());
+        d2[i] = d * d;
+    }
+    for (int c = 1; c < k; ++c) {
+        std::discrete_distribution<int> pick(d2.begin(), d2.end());
+        uint8_t* centre = centres.data() + c * vocabulary_tree::kBytes;
+        std::memcpy(centre, rows[pick(rng)], vocabulary_tree::kBytes);
+        for (int i = 0; i < n; ++i) {
+            const double d = hamming(rows[i], centre);
+            d2[i] = std::min(d2[i], d * d);
+        }
+    }
+
+    std::vector<int> assignment(n, -1);
+    std::vector<std::vector<const uint8_t*>> groups(k);
+    for (int it = 0; it < std::max(1, iterations); ++it) {
+        bool changed = false;
+        for (auto& g : groups) g.clear();
+        for (int i = 0; i < n; ++i) {
+            int best = 0, best_d = INT_MAX;
+            for (int c = 0; c < k; ++c) {
+                const int d = hamming(rows[i], centres.data() + c * vocabulary_tree::kBytes);
+                if (d < best_d) {
+                    best_d = d;
+                    best = c;
+                }
+            }
+            changed |= assignment[i] != best;
+            assignment[i] = best;
+            groups[best].push_back(rows[i]);
+        }
+        if (!changed && it > 0) break;
+        for (int c = 0; c < k; ++c) {
+            if (!groups[c].empty()) majority(groups[c], centres.data() + c * vocabulary_tree::kBytes);
+        }
+    }
+    return groups;
+}
+
+}  // namespace
+
+bool vocabulary_tree::train(const std::vector<cv::Mat>& images, int branching, int depth,
+                            int iterations, unsigned seed) {
+    std::vector<const uint8_t*> rows;
+    for (const cv::Mat& m : images) {
+        if (m.empty()) continue;
+        CV_Assert(m.type() == CV_8U && m.cols == kBytes);
+        for (int r = 0; r < m.rows; ++r) rows.push_back(m.ptr<uint8_t>(r));
+    }
+    if (rows.empty() || branching < 2 || depth < 1) return false;
+
+    branching_ = branching;
+    depth_ = depth;
+    nodes_.assign(1, node{});
+    centroids_.assign(kBytes, 0);
+    majority(rows, centroids_.data());
+
+    // Breadth-first: each entry is a node still to split and its descriptors
+    struct pending { int node; int level; std::vector<const uint8_t*> rows; };
+    std::vector<pending> queue;
+    queue.push_back({0, 0, std::move(rows)});
+    std::mt19937 rng(seed);
+    int words = 0;
+
+    for (size_t q = 0; q < queue.size(); ++q) {
+        pending p = std::move(queue[q]);
+        const bool leaf = p.level == depth || static_cast<int>(p.rows.size()) <= branching;
+        if (leaf) {
+            nodes_[p.node].word = words++;
+            continue;
+        }
+
+        std::vector<uint8_t> centres;
+        auto groups = cluster(p.rows, branching, iterations, rng, centres);
+        nodes_[p.node].first_child = static_cast<int>(nodes_.size());
+        for (size_t c = 0; c < groups.size(); ++c) {
+            if (groups[c].empty()) continue;
+            const int child = static_cast<int>(nodes_.size());
+            nodes_.push_back(node{});
+            centroids_.insert(centroids_.end(), centres.begin() + c * kBytes, centres.begin() + (c + 1) * kBytes);
+            ++nodes_[p.node].child_count;
+            queue.push_back({child, p.level + 1, std::move(groups[c])});
+        }
+    }
+
+    // idf = log(N / n_i), n_i = training images containing word i
+    std::vector<int> images_with(words, 0), last_image(words, -1);
+    int image_count = 0;
+    for (const cv::Mat& m : images) {
+        if (m.empty()) continue;
+        for (int r = 0; r < m.rows; ++r) {
+            const int w = word(m.ptr<uint8_t>(r));
+            if (last_image[w] != image_count) {
+                last_image[w] = image_count;
+                ++images_with[w];
+            }
+        }
+        ++image_count;
+    }
+    idf_.resize(words);
+    for (int w = 0; w < words; ++w) {
+        idf_[w] = static_cast<float>(std::log(static_cast<double>(image_count) / std::max(1, images_with[w])));
+    }
+    return true;
+}
+
+int vocabulary_tree::word(const uint8_t* descriptor) const {
+    int n = 0;
+    while (nodes_[n].child_count > 0) {
+        const node& parent = nodes_[n];
+        int best = parent.first_child, best_d = INT_MAX;
+        for (int c = parent.first_child; c < parent.first_child + parent.child_count; ++c) {
+            const int d = hamming(descriptor, centroids_.data() + static_cast<size_t>(c) * kBytes);
+            if (d < best_d) {
+                best_d = d;
+                best = c;
+            }
+        }
+        n = best;
+    }
+    return nodes_[n].word;
+}
+
+void vocabulary_tree::transform(const cv::Mat& descriptors, bow_vector& out) const {
+    out.clear();
+    if (empty() || descriptors.empty()) return;
+    CV_Assert(descriptors.type() == CV_8U && descriptors.cols == kBytes);
+
+    std::vector<int> words(descriptors.rows);
+    for (int r = 0; r < descriptors.rows; ++r) words[r] = word(descriptors.ptr<uint8_t>(r));
+    std::sort(words.begin(), words.end());
+
+    // tf * idf per distinct word, then L1 normalization
+    double total = 0.0;
+    for (size_t i = 0; i < words.size();) {
+        size_t j = i;
+        while (j < words.size() && words[j] == words[i]) ++j;
+        const float weight = static_cast<float>(j - i) * idf_[words[i]];
+        if (weight > 0.0f) {
+            out.emplace_back(words[i], weight);
+            total += weight;
+        }
+        i = j;
+    }
+    if (total > 0.0) {
+        for (auto& entry : out) entry.second = static_cast<float>(entry.second / total);
+    }
+}
+
+bool vocabulary_tree::save(const std::string& path) const {
+    std::ofstream f(path, std::ios::binary);
+    if (!f) {
+        std::cerr << "[Vocabulary] Failed to open " << path << " for writing\n";
+        return false;
+    }
+    const uint32_t header[6] = {kMagic, kVersion, static_cast<uint32_t>(branching_), static_cast<uint32_t>(depth_),
+                                static_cast<uint32_t>(nodes_.size()), static_cast<uint32_t>(idf_.size())};
+    f.write(reinterpret_cast<const char*>(header), sizeof(header));
+    f.write(reinterpret_cast<const char*>(nodes_.data()), nodes_.size() * sizeof(node));
+    f.write(reinterpret_cast<const char*>(centroids_.data()), centroids_.size());
+    f.write(reinterpret_cast<const char*>(idf_.data()), idf_.size() * sizeof(float));
+    return static_cast<bool>(f);
+}
+
+bool vocabulary_tree::load(const std::string& path) {
+    std::ifstream f(path, std::ios::binary);
+    uint32_t header[6] = {};
+    if (!f || !f.read(reinterpret_cast<char*>(header), sizeof(header)) || header[0] != kMagic || header[1] != kVersion) {
+        std::cerr << "[Vocabulary] Not a vocabulary file: " << path << "\n";
+        return false;
+    }
+
+    std::vector<node> nodes(header[4]);
+    std::vector<uint8_t> centroids(static_cast<size_t>(header[4]) * kBytes);
+    std::vector<float> idf(header[5]);
+    f.read(reinterpret_cast<char*>(nodes.data()), nodes.size() * sizeof(node));
+    f.read(reinterpret_cast<char*>(centroids.data()), centroids.size());
+    f.read(reinterpret_cast<char*>(idf.data()), idf.size() * sizeof(float));
+    if (!f || nodes.empty()) {
+        std::cerr << "[Vocabulary] Truncated file: " << path << "\n";
+        return false;
+    }
+    // Children always sit after their parent, so requiring that rules out
+    // cycles and self-references that would loop the descent forever
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        const node& n = nodes[i];
+        const bool bad_inner = n.child_count > 0 &&
+            (n.first_child <= 0 || static_cast<size_t>(n.first_child) <= i ||
+             static_cast<size_t>(n.first_child) + n.child_count > nodes.size());
+        const bool bad_leaf = n.child_count == 0 && (n.word < 0 || n.word >= static_cast<int>(idf.size()));
+        if (n.child_count < 0 || bad_inner || bad_leaf) {
+            std::cerr << "[Vocabulary] Corrupt tree in " << path << "\n";
+            return false;
+        }
+    }
+
+    branching_ = static_cast<int>(header[2]);
+    depth_ = static_cast<int>(header[3]);
+    nodes_ = std::move(nodes);
+    centroids_ = std::move(centroids);
+    idf_ = std::move(idf);
+    return true;
+}
@@ -25,6 +25,15 @@
 #include "blocks/visualizer_block.hpp"
 #include "blocks/homography_block.hpp"
 #include "blocks/filter_block.hpp"
+#include "blocks/video_source_block.hpp"
+#include "blocks/synthetic_scene_block.hpp"
+#include "blocks/pyramid_block.hpp"
+#include "blocks/feature_tracker_block.hpp"
+#include "blocks/place_recognition_block.hpp"
+#include "blocks/stereo_depth_block.hpp"
+#include "blocks/local_ba_block.hpp"
+#include "blocks/trajectory_eval_block.hpp"
+#include "blocks/undistort_block.hpp"
 
 static void glfw_error_callback(int error, const char* description) {
     fprintf(stderr, "GLFW Error %d: %s\n", error, description);
@@ -173,6 +182,70 @@ static void render_ui(block_graph& graph, bool& positioned, int& id_counter) {
         graph.set_block_position(id, pos.x, pos.y);
         pending_node_positions[id] = pos;
     }
+    if (ImGui::Button("Video Source")) {
+        int id = 1000 + id_counter++;
+        std::string path = "/home/ismo/Downloads/data_odometry_gray/dataset/sequences/00/image_0/%06d.png";
+        auto pos = ImNodes::EditorContextGetPanning() + ImVec2(600, 100);
+        graph.add_block(std::make_shared<video_source_block>(id, path));
+        graph.set_block_position(id, pos.x, pos.y);
+        pending_node_positions[id] = pos;
+    }
+    if (ImGui::Button("Synthetic Scene")) {
+        int id = 1000 + id_counter++;
+        auto pos = ImNodes::EditorContextGetPanning() + ImVec2(600, 100);
+        graph.add_block(std::make_shared<synthetic_scene_block>(id));
+        graph.set_block_position(id, pos.x, pos.y);
+        pending_node_positions[id] = pos;
+    }
+    if (ImGui::Button("Pyramid")) {
+        int id = 1000 + id_counter++;
+        auto pos = ImNodes::EditorContextGetPanning() + ImVec2(500, 100);
+        graph.add_block(std::make_shared<pyramid_block>(id));
+        graph.set_block_position(id, pos.x, pos.y);
+        pending_node_positions[id] = pos;
+    }
+    if (ImGui::Button("Feature Tracker")) {
+        int id = 1000 + id_counter++;
+        auto pos = ImNodes::EditorContextGetPanning() + ImVec2(500, 100);
+        graph.add_block(std::make_shared<feature_tracker_block>(id));
+        graph.set_block_position(id, pos.x, pos.y);
+        pending_node_positions[id] = pos;
+    }
+    if (ImGui::Button("Place Recognition")) {
+        int id = 1000 + id_counter++;
+        auto pos = ImNodes::EditorContextGetPanning() + ImVec2(700, 100);
+        graph.add_block(std::make_shared<place_recognition_block>(id));
+        graph.set_block_position(id, pos.x, pos.y);
+        pending_node_positions[id] = pos;
+    }
+    if (ImGui::Button("Stereo Depth")) {
+        int id = 1000 + id_counter++;
+        auto pos = ImNodes::EditorContextGetPanning() + ImVec2(500, 100);
+        graph.add_block(std::make_shared<stereo_depth_block>(id));
+        graph.set_block_position(id, pos.x, pos.y);
+        pending_node_positions[id] = pos;
+    }
+    if (ImGui::Button("Local BA")) {
+        int id = 1000 + id_counter++;
+        auto pos = ImNodes::EditorContextGetPanning() + ImVec2(700, 100);
+        graph.add_block(std::make_shared<local_ba_block>(id));
+        graph.set_block_position(id, pos.x, pos.y);
+        pending_node_positions[id] = pos;
+    }
+    if (ImGui::Button("Trajectory Eval")) {
+        int id = 1000 + id_counter++;
+        auto pos = ImNodes::EditorContextGetPanning() + ImVec2(900, 100);
+        graph.add_block(std::make_shared<trajectory_eval_block>(id));
+        graph.set_block_position(id, pos.x, pos.y);
+        pending_node_positions[id] = pos;
+    }
+    if (ImGui::Button("Undistort")) {
+        int id = 1000 + id_counter++;
+        auto pos = ImNodes::EditorContextGetPanning() + ImVec2(300, 100);
+        graph.add_block(std::make_shared<undistort_block>(id));
+        graph.set_block_position(id, pos.x, pos.y);
+        pending_node_positions[id] = pos;
+    }
 
     ImGui::End();
 
@@ -284,6 +357,20 @@ static void render_ui(block_graph& graph, bool& positioned, int& id_counter) {
         }
     }
 
+    // Real-time playback accounting, fed by timed sources
+    const auto& deadlines = graph.get_deadline_monitor();
+    if (deadlines.get_stats().completed > 0 || deadlines.pending() > 0) {
+        const auto& st = deadlines.get_stats();
+        ImGui::SetNextWindowPos(ImVec2(ImGui::GetIO().DisplaySize.x - 260, 0), ImGuiCond_Once);
+        ImGui::Begin("Deadlines", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+        ImGui::Text("Frames: %d (pending %d)", st.completed, deadlines.pending());
+        ImGui::Text("Missed: %d", st.missed);
+        ImGui::Text("Latency: %.1f ms (mean %.1f, max %.1f)", st.last_latency_ms, st.mean_latency_ms, st.max_latency_ms);
+        ImGui::Text("Slack: %.1f ms", st.last_slack_ms);
+        if (ImGui::Button("Reset stats")) graph.reset_deadline_monitor();
+        ImGui::End();
+    }
+
     graph.process_all();
 }
 
@@ -0,0 +1,71 @@
+// Offline vocabulary training for place_recognition_block.
+//
+// Extracts ORB descriptors from every `stride`-th image matching a glob
+// pattern and builds a k-majority vocabulary tree (branching^depth words
+// at most), written in the vocabulary_tree binary format.
+//
+//   train_vocabulary <image glob> <output> [branching=10] [depth=5] [features=1000] [stride=10]
+//   e.g. train_vocabulary "sequences/00/image_0/*.png" kitti00.voc 10 6
+#include "core/vocabulary_tree.hpp"
+#include <opencv2/core.hpp>
+#include <opencv2/core/utility.hpp>
+#include <opencv2/features2d.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <image glob> <output> [branching=10] [depth=5] [features=1000] [stride=10]\n";
+        return 1;
+    }
+    const std::string pattern = argv[1];
+    const std::string output = argv[2];
+    const int branching = argc > 3 ? std::atoi(argv[3]) : 10;
+    const int depth = argc > 4 ? std::atoi(argv[4]) : 5;
+    const int features = argc > 5 ? std::atoi(argv[5]) : 1000;
+    const int stride = argc > 6 ? std::max(1, std::atoi(argv[6])) : 10;
+
+    std::vector<cv::String> files;
+    cv::glob(pattern, files, false);
+    if (files.empty()) {
+        std::cerr << "[train_vocabulary] No images match " << pattern << "\n";
+        return 1;
+    }
+
+    auto orb = cv::ORB::create(features);
+    std::vector<cv::Mat> descriptors;
+    size_t total = 0;
+    for (size_t i = 0; i < files.size(); i += stride) {
+        cv::Mat img = cv::imread(files[i], cv::IMREAD_GRAYSCALE);
+        if (img.empty()) {
+            std::cerr << "[train_vocabulary] Skipping unreadable " << files[i] << "\n";
+            continue;
+        }
+        std::vector<cv::KeyPoint> kps;
+        cv::Mat desc;
+        orb->detectAndCompute(img, cv::noArray(), kps, desc);
+        if (desc.empty()) continue;
+        total += desc.rows;
+        descriptors.push_back(desc);
+    }
+    std::cout << "[train_vocabulary] " << total << " descriptors from " << descriptors.size() << " images\n";
+
+    auto t0 = std::chrono::steady_clock::now();
+    vocabulary_tree vocabulary;
+    if (!vocabulary.train(descriptors, branching, depth)) {
+        std::cerr << "[train_vocabulary] Training failed\n";
+        return 1;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "[train_vocabulary] " << vocabulary.word_count() << " words in " << seconds << " s\n";
+
+    if (!vocabulary.save(output)) return 1;
+    std::cout << "[train_vocabulary] Saved " << output << "\n";
+    return 0;
+}